@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <atomic>
+
+//------------------------------------------------------------------------------
+/// \class Benchmark
+/// \brief a minimal micro benchmark runner
+///
+/// Runs a function in a loop until it has taken at least the minimum time and
+/// reports the average time, heap allocations (operator new calls) & ops
+/// per second. The results are printed as a table, or as one JSON object per
+/// line with --json (see main.cpp):
+///
+///		{"group":"logger","name":"disabled ofxLogVerbose()","nsPerOp":2.1,"allocsPerOp":0.00,"opsPerSec":476190476}
+///
+/// Usage:
+///		Benchmark bench("group");
+///		bench.run("name", [&]{ ... one op ... });
+///
+/// the number of operator new calls so far, counted in main.cpp
+extern std::atomic<unsigned long long> benchmarkAllocs;
+
+/// where the results go, stdout unless a benchmark needs stdout for itself
+extern FILE* benchmarkOut;
+
+/// print the results as JSON lines instead of a table?
+extern bool benchmarkJson;
+
+class Benchmark
+{
+	public:
+
+		Benchmark(const std::string& group) : group(group)
+		{
+			minMillis = 200;
+		}
+
+		/// runs func until it has taken at least minMillis, prints ns/op,
+		/// allocs/op & ops/s, returns ns/op
+		template <class Function>
+		double run(const std::string& name, Function func)
+		{
+			typedef std::chrono::steady_clock Clock;
+
+			// warm up caches, static inits, etc
+			for(int i = 0; i < 1000; ++i)
+			{
+				func();
+			}
+
+			unsigned long long ops = 0;
+			unsigned long long batch = 1000;
+			unsigned long long allocs = benchmarkAllocs.load(std::memory_order_relaxed);
+			Clock::time_point start = Clock::now();
+			double elapsedNs = 0;
+			while(elapsedNs < minMillis*1e6)
+			{
+				for(unsigned long long i = 0; i < batch; ++i)
+				{
+					func();
+				}
+				ops += batch;
+				batch *= 2;
+				elapsedNs = std::chrono::duration<double, std::nano>(Clock::now()-start).count();
+			}
+
+			double nsPerOp = elapsedNs/ops;
+			double allocsPerOp = (double) (benchmarkAllocs.load(std::memory_order_relaxed)-allocs)/ops;
+			double opsPerSec = 1e9/nsPerOp;
+			if(benchmarkJson)
+			{
+				fprintf(benchmarkOut, "{\"group\":\"%s\",\"name\":\"%s\",\"nsPerOp\":%.1f,\"allocsPerOp\":%.2f,\"opsPerSec\":%.0f}\n",
+					group.c_str(), name.c_str(), nsPerOp, allocsPerOp, opsPerSec);
+			}
+			else
+			{
+				fprintf(benchmarkOut, "%-12s %-36s %10.1f ns/op %8.2f allocs/op %12.0f ops/s\n",
+					group.c_str(), name.c_str(), nsPerOp, allocsPerOp, opsPerSec);
+			}
+			fflush(benchmarkOut);
+			return nsPerOp;
+		}
+
+		unsigned int minMillis;		///< min run time of each benchmark
+
+	private:
+
+		std::string group;
+};
+
+/// keeps the optimizer from dropping results
+extern volatile std::size_t benchmarkSink;
+
+/// the number of failed checks, main() returns 1 if there are any
+extern int benchmarkNumFailed;
+
+/// a correctness check a group runs before timing, prints a FAIL line if
+/// bOk is false
+void benchmarkCheck(bool bOk, const std::string& group, const std::string& what);
+
+/// the benchmark groups
+void formatBenchmarks();
+void bitmapStringBenchmarks();
+void loggerBenchmarks();
@@ -0,0 +1,141 @@
+#include "benchmark.h"
+
+#include "ofxBitmapString.h"
+
+#include <sstream>
+
+//--------------------------------------------------------------
+static std::string glyphString(const std::vector<ofxBitmapStringBatch::Glyph>& glyphs)
+{
+	std::string s;
+	for(unsigned int i = 0; i < glyphs.size(); ++i)
+	{
+		s += "'"+std::string(1, (char) glyphs[i].character)+"' "+
+			ofToString(glyphs[i].x)+","+ofToString(glyphs[i].y)+" ";
+	}
+	return s;
+}
+
+static void checkGlyphs(const std::string& what, const std::vector<ofxBitmapStringBatch::Glyph>& glyphs,
+						const std::string& expected)
+{
+	std::string got = glyphString(glyphs);
+	benchmarkCheck(got == expected, "bitmap", what+" is "+got+"expected "+expected);
+}
+
+// the layout & glyph reuse, headless as only draw() needs GL
+static void checkBitmapStringBatch()
+{
+	std::vector<ofxBitmapStringBatch::Glyph> glyphs;
+
+	// 8 pixel glyphs, the baseline 8 pixels below y
+	ofxBitmapStringBatch::layout("ab", 20, 12, glyphs);
+	checkGlyphs("layout \"ab\"", glyphs, "'a' 20,4 'b' 28,4 ");
+
+	// tabs go on to the next 8 column stop, control characters aren't drawn
+	ofxBitmapStringBatch::layout("a\tb\rc\td", 20, 12, glyphs);
+	checkGlyphs("layout tabs", glyphs, "'a' 20,4 'b' 84,4 'c' 92,4 'd' 148,4 ");
+
+	// lines are 1.7 glyphs apart: 4+13.6, 4+27.2
+	ofxBitmapStringBatch::layout("a\nb\n\tc", 20, 12, glyphs);
+	checkGlyphs("layout newlines", glyphs, "'a' 20,4 'b' 20,17 'c' 84,31 ");
+
+	ofxBitmapStringBatch batch;
+	ofColor white(255, 255, 255);
+	batch.add("fps: 60", 20, 12, white);
+	batch.add("ms: 16", 20, 26, white);
+	batch.add("ms: 16", 20, 40, white);
+	benchmarkCheck(batch.getNumLines() == 3 && batch.getNumReused() == 0, "bitmap",
+		"first frame reused "+ofToString(batch.getNumReused())+" of "+ofToString(batch.getNumLines())+" lines");
+	checkGlyphs("first frame line 1", batch.getGlyphs(1), "'m' 20,18 's' 28,18 ':' 36,18 ' ' 44,18 '1' 52,18 '6' 60,18 ");
+	batch.endFrame();
+
+	// a new line above the others doesn't stop them reusing their glyphs,
+	// a line in a new place is laid out again
+	batch.add("warning", 20, 0, white);
+	batch.add("fps: 60", 20, 12, white);
+	batch.add("ms: 16", 20, 40, white);
+	batch.add("ms: 16", 20, 54, white);
+	benchmarkCheck(batch.getNumReused() == 2, "bitmap",
+		"a line inserted above, reused "+ofToString(batch.getNumReused())+" lines, expected 2");
+	ofxBitmapStringBatch::layout("fps: 60", 20, 12, glyphs);
+	checkGlyphs("reused line 1", batch.getGlyphs(1), glyphString(glyphs));
+	ofxBitmapStringBatch::layout("ms: 16", 20, 40, glyphs);
+	checkGlyphs("reused line 2", batch.getGlyphs(2), glyphString(glyphs));
+	ofxBitmapStringBatch::layout("ms: 16", 20, 54, glyphs);
+	checkGlyphs("moved line 3", batch.getGlyphs(3), glyphString(glyphs));
+	batch.endFrame();
+
+	// changed text is laid out again, two identical lines can't both reuse
+	// the one line of last frame
+	batch.add("warning", 20, 0, white);
+	batch.add("fps: 59", 20, 12, white);
+	batch.add("ms: 16", 20, 40, white);
+	batch.add("ms: 16", 20, 40, white);
+	benchmarkCheck(batch.getNumReused() == 2, "bitmap",
+		"a changed line, reused "+ofToString(batch.getNumReused())+" lines, expected 2");
+	ofxBitmapStringBatch::layout("fps: 59", 20, 12, glyphs);
+	checkGlyphs("changed line 1", batch.getGlyphs(1), glyphString(glyphs));
+	ofxBitmapStringBatch::layout("ms: 16", 20, 40, glyphs);
+	checkGlyphs("duplicate line 3", batch.getGlyphs(3), glyphString(glyphs));
+	batch.endFrame();
+
+	batch.clear();
+	batch.add("warning", 20, 0, white);
+	benchmarkCheck(batch.getNumReused() == 0, "bitmap", "a line reused its glyphs after clear()");
+}
+
+//--------------------------------------------------------------
+void bitmapStringBenchmarks()
+{
+	checkBitmapStringBatch();
+
+	Benchmark bench("bitmap");
+
+	// the lines go into a batch that is never drawn, so no GL is needed
+	ofxBitmapStringBatch& batch = ofxBitmapStringBatch::frame();
+	ofColor white(255, 255, 255);
+	unsigned int frame = 0;
+
+	bench.run("ostringstream fps line", [&]{
+		float fps = 59.9412f+(frame % 7)*0.01f;
+		std::ostringstream message;
+		message << "fps: " << fps;
+		batch.add(message.str(), 20, 12, white);
+		batch.endFrame();
+		++frame;
+	});
+
+	bench.run("ostringstream 3 line hud", [&]{
+		float fps = 59.9412f+(frame % 7)*0.01f;
+		std::ostringstream frameLine, fpsLine, msLine;
+		frameLine << "frame: " << frame;
+		fpsLine << "  fps: " << fps;
+		msLine << "   ms: " << 1000.0f/fps << " (target " << 16.6667f << ")";
+		batch.add(frameLine.str(), 20, 12, white);
+		batch.add(fpsLine.str(), 20, 26, white);
+		batch.add(msLine.str(), 20, 40, white);
+		batch.endFrame();
+		++frame;
+	});
+
+	ofxBitmapString::enableBatching();
+
+	bench.run("ofxBitmapString fps line", [&]{
+		float fps = 59.9412f+(frame % 7)*0.01f;
+		ofxBitmapString(20, 12) << "fps: " << fps;
+		batch.endFrame();
+		++frame;
+	});
+
+	bench.run("ofxBitmapString 3 line hud", [&]{
+		float fps = 59.9412f+(frame % 7)*0.01f;
+		ofxBitmapString(20, 12) << "frame: " << frame;
+		ofxBitmapString(20, 26) << "  fps: " << fps;
+		ofxBitmapString(20, 40) << "   ms: " << 1000.0f/fps << " (target " << 16.6667f << ")";
+		batch.endFrame();
+		++frame;
+	});
+
+	ofxBitmapString::disableBatching();
+}
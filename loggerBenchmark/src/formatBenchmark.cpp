@@ -0,0 +1,59 @@
+#include "benchmark.h"
+
+#include "ofxLogFormat.h"
+
+#include <sstream>
+#include <cstdarg>
+
+//--------------------------------------------------------------
+// the legacy printf style formatting from ofLog: vsprintf into a fixed line
+static std::size_t legacyFormat(const char* format, ...)
+{
+	char line[512];
+	va_list args;
+	va_start(args, format);
+	vsprintf(line, format, args);
+	va_end(args);
+	std::string message(line);
+	return message.size();
+}
+
+//--------------------------------------------------------------
+void formatBenchmarks()
+{
+	Benchmark bench("format");
+
+	std::string name = "testApp::draw";
+	float ms = 16.6667f;
+	int frame = 1024;
+
+	bench.run("vsprintf char[512]", [&]{
+		benchmarkSink += legacyFormat("%s: %g ms frame %d", name.c_str(), ms, frame);
+	});
+
+	bench.run("ostringstream", [&]{
+		std::ostringstream message;
+		message << name << ": " << ms << " ms frame " << frame;
+		benchmarkSink += message.str().size();
+	});
+
+	bench.run("ofxLogFormat parse per call", [&]{
+		ofxLogBuffer buffer;
+		ofxLogFormatTo(buffer, ofxLogFormatSpec("{}: {} ms frame {}"), name, ms, frame);
+		benchmarkSink += buffer.size();
+	});
+
+	static const ofxLogFormatSpec spec("{}: {} ms frame {}");
+	bench.run("ofxLogFormat static spec", [&]{
+		ofxLogBuffer buffer;
+		ofxLogFormatTo(buffer, spec, name, ms, frame);
+		benchmarkSink += buffer.size();
+	});
+
+	std::string longName(600, 'x');
+	bench.run("ofxLogFormat 600 char line", [&]{
+		ofxLogBuffer buffer;
+		ofxLogFormatTo(buffer, spec, longName, ms, frame);
+		benchmarkSink += buffer.size();
+	});
+}
@@ -0,0 +1,209 @@
+#include "benchmark.h"
+
+#include "ofxLogger.h"
+
+#include <Poco/FileChannel.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// a sink that drops everything, the cost of the channel call itself
+class NullChannel : public ofxLogChannel
+{
+	public:
+
+		using ofxLogChannel::log;
+
+		void log(const ofxLogRecord& record)
+		{
+			benchmarkSink += record.getLine().size();
+		}
+};
+
+// an event listener that only reads the message
+class BenchmarkListener
+{
+	public:
+
+		void onLog(ofxLoggerEvent& event)
+		{
+			benchmarkSink += event.getMessage().size();
+		}
+};
+
+// points stdout at /dev/null while the console sink is measured
+class MuteStdout
+{
+	public:
+
+		MuteStdout()
+		{
+			fflush(stdout);
+			saved = dup(STDOUT_FILENO);
+			int null = open("/dev/null", O_WRONLY);
+			dup2(null, STDOUT_FILENO);
+			close(null);
+		}
+
+		~MuteStdout()
+		{
+			fflush(stdout);
+			dup2(saved, STDOUT_FILENO);
+			close(saved);
+		}
+
+	private:
+
+		int saved;
+};
+
+//--------------------------------------------------------------
+// each stage of a log call on its own, then whole calls into each sink
+void loggerBenchmarks()
+{
+	Benchmark bench("logger");
+
+	ofxLogger& logger = ofxLogger::instance();
+	ofxLog::disableConsole();
+	ofxLog::setLevel(OF_LOG_WARNING);
+	ofxLog::addTopic("bench", OF_LOG_WARNING);
+
+	const std::string path = "/tmp/loggerBenchmark.log";
+	const std::string message = "testApp::update ... a new frame";
+	const std::string& topic = ofxLogRecord::getTopicName(ofxLogRecord::internTopic("bench"));
+	unsigned int frame = 0;
+
+	// disabled statements, the cost of logging that's switched off
+	bench.run("disabled ofxLogVerbose()", [&]{
+		ofxLogVerbose() << "frame " << frame++;
+	});
+
+	bench.run("disabled ofxLogVerbose(topic)", [&]{
+		ofxLogVerbose("bench") << "frame " << frame++;
+	});
+
+	bench.run("disabled OFX_LOG_VERBOSE site", [&]{
+		OFX_LOG_VERBOSE("bench") << "frame " << frame++;
+	});
+
+	// building the message as ofxLog does
+	bench.run("stream format", [&]{
+		ofxLogBuffer buffer;
+		buffer << "testApp::update frame " << frame++ << " took " << 16.6667f << " ms";
+		benchmarkSink += buffer.size();
+	});
+
+	// the level check, with & without a topic
+	bench.run("level check", [&]{
+		benchmarkSink += logger.isEnabled(OF_LOG_WARNING);
+	});
+
+	bench.run("topic lookup", [&]{
+		benchmarkSink += logger.isEnabled("bench", OF_LOG_WARNING);
+	});
+
+	// the printed line, with & without the date & time header
+	Poco::AutoPtr<ofxLogPattern> plain(new ofxLogPattern("%l%P%t"));
+	Poco::AutoPtr<ofxLogPattern> header(new ofxLogPattern("%Y-%m-%d %H:%M:%S.%i %l%P%t"));
+
+	bench.run("line no header", [&]{
+		ofxLogBuffer line;
+		plain->format(line, OF_LOG_WARNING, topic, message.data(), message.size(),
+			Poco::Timestamp(), frame++, 0, 1);
+		benchmarkSink += line.size();
+	});
+
+	bench.run("line date time header", [&]{
+		ofxLogBuffer line;
+		header->format(line, OF_LOG_WARNING, topic, message.data(), message.size(),
+			Poco::Timestamp(), frame++, 0, 1);
+		benchmarkSink += line.size();
+	});
+
+	// the record every sink & listener shares
+	bench.run("record create", [&]{
+		Poco::AutoPtr<ofxLogRecord> record(ofxLogRecord::create(OF_LOG_WARNING, 0, topic,
+			message.data(), message.size(), message.data(), message.size(), Poco::Timestamp(), 0, 0));
+		benchmarkSink += record->getMessage().size();
+	});
+
+	Poco::AutoPtr<ofxLogRecord> record(ofxLogRecord::create(OF_LOG_WARNING, 0, topic,
+		message.data(), message.size(), message.data(), message.size(), Poco::Timestamp(), 0, 0));
+
+	// event dispatch
+	bench.run("event dispatch no listener", [&]{
+		ofxLoggerEvent event(record);
+		ofNotifyEvent(ofxLoggerEventDispatcher, event);
+	});
+
+	BenchmarkListener listener;
+	ofAddListener(ofxLoggerEventDispatcher, &listener, &BenchmarkListener::onLog);
+	bench.run("event dispatch 1 listener", [&]{
+		ofxLoggerEvent event(record);
+		ofNotifyEvent(ofxLoggerEventDispatcher, event);
+	});
+	ofRemoveListener(ofxLoggerEventDispatcher, &listener, &BenchmarkListener::onLog);
+
+	// the sinks on their own, through a splitter as in the logger
+	Poco::AutoPtr<ofxLogSplitterChannel> splitter(new ofxLogSplitterChannel);
+	Poco::AutoPtr<NullChannel> null(new NullChannel);
+	splitter->addChannel(null);
+	bench.run("sink null", [&]{
+		splitter->log(*record);
+	});
+	splitter->removeChannel(null);
+
+	Poco::AutoPtr<Poco::FileChannel> file(new Poco::FileChannel(path));
+	file->open();
+	splitter->addChannel(file);
+	bench.run("sink file", [&]{
+		splitter->log(*record);
+	});
+	splitter->removeChannel(file);
+	file->close();
+
+	{
+		MuteStdout mute;
+		Poco::AutoPtr<ofxLogConsoleChannel> console(new ofxLogConsoleChannel);
+		console->disableColors();
+		console->open();
+		splitter->addChannel(console);
+		bench.run("sink console", [&]{
+			splitter->log(*record);
+		});
+		splitter->removeChannel(console);
+		console->close();
+	}
+
+	// whole log calls, from the stream to the sinks
+	bench.run("ofxLogWarning() no sinks", [&]{
+		ofxLogWarning() << "frame " << frame++;
+	});
+
+	ofxLog::setFilePath(path);
+	ofxLog::enableFile();
+	bench.run("ofxLogWarning() file", [&]{
+		ofxLogWarning() << "frame " << frame++;
+	});
+
+	ofxLog::enableFormatWorkers();
+	bench.run("ofxLogWarning() file workers", [&]{
+		ofxLogWarning() << "frame " << frame++;
+	});
+	ofxLog::disableFormatWorkers();
+	ofxLog::disableFile();
+
+	{
+		MuteStdout mute;
+		ofxLog::enableConsole();
+		bench.run("ofxLogWarning() console", [&]{
+			ofxLogWarning() << "frame " << frame++;
+		});
+		ofxLog::flush();
+		ofxLog::disableConsole();
+	}
+
+	ofFile::removeFile(path, false);
+	ofxLog::setLevel(OF_LOG_NOTICE);
+	ofxLog::enableConsole();
+}
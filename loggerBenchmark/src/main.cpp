@@ -0,0 +1,101 @@
+#include "benchmark.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <unistd.h>
+
+volatile std::size_t benchmarkSink = 0;
+std::atomic<unsigned long long> benchmarkAllocs(0);
+FILE* benchmarkOut = stdout;
+bool benchmarkJson = false;
+int benchmarkNumFailed = 0;
+
+//--------------------------------------------------------------
+void benchmarkCheck(bool bOk, const std::string& group, const std::string& what)
+{
+	if(!bOk)
+	{
+		fprintf(stderr, "FAIL  %-12s %s\n", group.c_str(), what.c_str());
+		benchmarkNumFailed++;
+	}
+}
+
+//--------------------------------------------------------------
+// count the heap allocations for the allocs/op column
+void* operator new(std::size_t size)
+{
+	benchmarkAllocs.fetch_add(1, std::memory_order_relaxed);
+	void* p = malloc(size > 0 ? size : 1);
+	if(!p)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	free(p);
+}
+
+//========================================================================
+// headless, no window or GL context is needed
+//
+// loggerBenchmark [--json] [format|bitmap|logger ...]
+//
+// runs all the groups if none are given, returns 1 if a group's checks
+// failed
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> groups;
+	for(int i = 1; i < argc; ++i)
+	{
+		if(strcmp(argv[i], "--json") == 0)
+		{
+			benchmarkJson = true;
+		}
+		else
+		{
+			groups.push_back(argv[i]);
+		}
+	}
+
+	// the results go to a copy of stdout, so the console sink benchmarks
+	// can point stdout somewhere else
+	benchmarkOut = fdopen(dup(STDOUT_FILENO), "w");
+	if(!benchmarkOut)
+	{
+		benchmarkOut = stdout;
+	}
+
+	struct Group {const char* name; void (*func)();};
+	const Group all[] = {
+		{"format", &formatBenchmarks},
+		{"bitmap", &bitmapStringBenchmarks},
+		{"logger", &loggerBenchmarks}
+	};
+	for(unsigned int i = 0; i < sizeof(all)/sizeof(all[0]); ++i)
+	{
+		bool bRun = groups.empty();
+		for(unsigned int j = 0; j < groups.size(); ++j)
+		{
+			bRun = bRun || groups[j] == all[i].name;
+		}
+		if(bRun)
+		{
+			all[i].func();
+		}
+	}
+	return benchmarkNumFailed > 0 ? 1 : 0;
+}
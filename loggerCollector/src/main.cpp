@@ -0,0 +1,191 @@
+#include "ofxLogSocketChannel.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+static volatile sig_atomic_t bQuit = 0;
+
+//--------------------------------------------------------------
+static void quit(int)
+{
+	bQuit = 1;
+}
+
+static void printUsage()
+{
+	printf("Usage: loggerCollector [options] socket [logfile]\n");
+	printf("\n");
+	printf("Receives log lines from ofxLogSocketChannel senders on a Unix domain\n");
+	printf("socket and appends them to logfile (or stdout).\n");
+	printf("\n");
+	printf("  -d, --dgram    listen on a SOCK_DGRAM socket instead of SOCK_SEQPACKET\n");
+	printf("                 (use this where SOCK_SEQPACKET isn't supported, ie. OS X)\n");
+	printf("  -n, --names    print the sender name before each line\n");
+	printf("\n");
+	printf("Example: loggerCollector -n /tmp/ofxLogger.sock all.log\n");
+}
+
+//--------------------------------------------------------------
+// write one received batch, returns false if it was malformed
+static bool writeBatch(FILE* out, const char* data, std::size_t size, bool bNames)
+{
+	std::string name;
+	std::vector<ofxLogSocketChannel::Record> records;
+	if(!ofxLogSocketChannel::decodeBatch(data, size, name, records))
+	{
+		fprintf(stderr, "loggerCollector: dropped a malformed batch (%lu bytes)\n", (unsigned long) size);
+		return false;
+	}
+	for(std::size_t i = 0; i < records.size(); ++i)
+	{
+		if(bNames)
+		{
+			fprintf(out, "[%s] ", name.c_str());
+		}
+		fwrite(records[i].text.data(), 1, records[i].text.size(), out);
+		fputc('\n', out);
+	}
+	return true;
+}
+
+//========================================================================
+int main(int argc, char** argv)
+{
+	bool bDgram = false;
+	bool bNames = false;
+	std::vector<std::string> args;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if(arg == "-d" || arg == "--dgram")
+		{
+			bDgram = true;
+		}
+		else if(arg == "-n" || arg == "--names")
+		{
+			bNames = true;
+		}
+		else if(arg == "-h" || arg == "--help")
+		{
+			printUsage();
+			return 0;
+		}
+		else if(!arg.empty() && arg[0] == '-')
+		{
+			fprintf(stderr, "loggerCollector: unknown option \"%s\"\n", arg.c_str());
+			printUsage();
+			return 2;
+		}
+		else
+		{
+			args.push_back(arg);
+		}
+	}
+	if(args.empty() || args.size() > 2)
+	{
+		printUsage();
+		return 2;
+	}
+
+	FILE* out = stdout;
+	if(args.size() == 2)
+	{
+		out = fopen(args[1].c_str(), "a");
+		if(!out)
+		{
+			fprintf(stderr, "loggerCollector: couldn't open \"%s\": %s\n", args[1].c_str(), strerror(errno));
+			return 1;
+		}
+	}
+
+	// bind, replacing the socket file left behind by an old collector
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(args[0].size() >= sizeof(address.sun_path))
+	{
+		fprintf(stderr, "loggerCollector: socket path too long\n");
+		return 1;
+	}
+	strncpy(address.sun_path, args[0].c_str(), sizeof(address.sun_path)-1);
+	unlink(args[0].c_str());
+
+	int server = socket(AF_UNIX, bDgram ? SOCK_DGRAM : SOCK_SEQPACKET, 0);
+	if(server < 0 || bind(server, (sockaddr*) &address, sizeof(address)) < 0 ||
+	   (!bDgram && listen(server, 16) < 0))
+	{
+		fprintf(stderr, "loggerCollector: couldn't listen on \"%s\": %s\n", args[0].c_str(), strerror(errno));
+		return 1;
+	}
+
+	signal(SIGINT, quit);
+	signal(SIGTERM, quit);
+	signal(SIGPIPE, SIG_IGN);
+
+	// a batch is one packet, big enough for any batch size a sender can set
+	std::vector<char> buffer(1024*1024);
+	std::vector<pollfd> fds(1);
+	fds[0].fd = server;
+	fds[0].events = POLLIN;
+
+	while(!bQuit)
+	{
+		if(poll(&fds[0], fds.size(), 500) < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			break;
+		}
+
+		// new sender
+		if(!bDgram && (fds[0].revents & POLLIN))
+		{
+			int client = accept(server, NULL, NULL);
+			if(client >= 0)
+			{
+				pollfd fd = {client, POLLIN, 0};
+				fds.push_back(fd);
+			}
+		}
+
+		// received batches, a datagram server receives them itself
+		for(std::size_t i = bDgram ? 0 : 1; i < fds.size(); ++i)
+		{
+			if(!fds[i].revents)
+			{
+				continue;
+			}
+			ssize_t size = recv(fds[i].fd, &buffer[0], buffer.size(), 0);
+			if(size > 0)
+			{
+				writeBatch(out, &buffer[0], size, bNames);
+			}
+			else if(!bDgram && (size == 0 || (errno != EINTR && errno != EAGAIN)))
+			{
+				// sender closed
+				close(fds[i].fd);
+				fds.erase(fds.begin()+i);
+				--i;
+			}
+		}
+		fflush(out);
+	}
+
+	for(std::size_t i = 0; i < fds.size(); ++i)
+	{
+		close(fds[i].fd);
+	}
+	unlink(args[0].c_str());
+	if(out != stdout)
+	{
+		fclose(out);
+	}
+	return 0;
+}
@@ -0,0 +1,262 @@
+#include "ofxLogSocketChannel.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <fstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+// round trip test of ofxLogSocketChannel & loggerCollector:
+//
+//   batching	the channel's packets, received here, respect the max batch
+//				size & carry more than one line
+//   roundtrip	lines logged into the channel come out of the collector's log
+//				file unchanged & in order
+//   reconnect	lines logged while the collector is down are queued & sent
+//				once a new collector is listening
+
+static const unsigned int s_numLines = 1000;
+static const unsigned int s_batchSizeKB = 1;
+static const unsigned int s_timeoutMillis = 5000;
+
+static std::string collectorPath;
+static std::string socketPath;
+static std::string logPath;
+static int numFailed = 0;
+
+//--------------------------------------------------------------
+static void check(bool bOk, const std::string& test, const std::string& what)
+{
+	if(!bOk)
+	{
+		printf("FAIL  %-10s %s\n", test.c_str(), what.c_str());
+		numFailed++;
+	}
+}
+
+static std::string makeLine(const std::string& test, unsigned int i)
+{
+	// varied lengths so the batches split at different places
+	return test+" line "+ofToString(i)+" "+std::string(i%97, 'x');
+}
+
+static void logLines(ofxLogSocketChannel* channel, const std::string& test,
+					 unsigned int first, unsigned int count, std::vector<std::string>& sent)
+{
+	for(unsigned int i = first; i < first+count; ++i)
+	{
+		std::string line = makeLine(test, i);
+		channel->log(Poco::Message("test", line, Poco::Message::PRIO_NOTICE));
+		sent.push_back(line);
+	}
+}
+
+static ofxLogSocketChannel* openChannel()
+{
+	ofxLogSocketChannel* channel = new ofxLogSocketChannel(socketPath);
+	channel->setName("test");
+	channel->setMaxBatchSize(s_batchSizeKB);
+	channel->open();
+	return channel;
+}
+
+static void closeChannel(ofxLogSocketChannel* channel)
+{
+	channel->close();
+	channel->release();
+}
+
+//--------------------------------------------------------------
+static pid_t startCollector()
+{
+	pid_t pid = fork();
+	if(pid == 0)
+	{
+		execl(collectorPath.c_str(), collectorPath.c_str(), socketPath.c_str(), logPath.c_str(), (char*) NULL);
+		_exit(127);
+	}
+
+	// listening once the socket file is there
+	struct stat info;
+	for(unsigned int waited = 0; waited < s_timeoutMillis; waited += 10)
+	{
+		if(stat(socketPath.c_str(), &info) == 0)
+		{
+			return pid;
+		}
+		usleep(10*1000);
+	}
+	return pid;
+}
+
+static void stopCollector(pid_t pid)
+{
+	kill(pid, SIGTERM);
+	waitpid(pid, NULL, 0);
+}
+
+static std::vector<std::string> readLines(const std::string& path)
+{
+	std::vector<std::string> lines;
+	std::ifstream file(path.c_str());
+	std::string line;
+	while(std::getline(file, line))
+	{
+		lines.push_back(line);
+	}
+	return lines;
+}
+
+// wait until the log file has at least count lines
+static std::vector<std::string> waitForLines(std::size_t count)
+{
+	std::vector<std::string> lines;
+	for(unsigned int waited = 0; waited < s_timeoutMillis; waited += 10)
+	{
+		lines = readLines(logPath);
+		if(lines.size() >= count)
+		{
+			break;
+		}
+		usleep(10*1000);
+	}
+	return lines;
+}
+
+static void compareLines(const std::string& test, const std::vector<std::string>& sent,
+						 const std::vector<std::string>& received)
+{
+	check(received.size() == sent.size(), test, "sent "+ofToString(sent.size())+
+		  " lines, received "+ofToString(received.size()));
+	for(std::size_t i = 0; i < sent.size() && i < received.size(); ++i)
+	{
+		if(received[i] != sent[i])
+		{
+			check(false, test, "line "+ofToString(i)+" is \""+received[i]+"\", expected \""+sent[i]+"\"");
+			break;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+static void testBatching()
+{
+	// stand in for the collector to see the packets themselves
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path)-1);
+	unlink(socketPath.c_str());
+	int server = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	if(server < 0 || bind(server, (sockaddr*) &address, sizeof(address)) < 0 || listen(server, 1) < 0)
+	{
+		check(false, "batching", std::string("couldn't listen: ")+strerror(errno));
+		return;
+	}
+
+	std::vector<std::string> sent;
+	ofxLogSocketChannel* channel = openChannel();
+	logLines(channel, "batching", 0, s_numLines, sent);
+
+	// a line longer than a batch goes out on its own
+	std::string longLine = "batching long "+std::string(s_batchSizeKB*1024*2, 'y');
+	channel->log(Poco::Message("test", longLine, Poco::Message::PRIO_NOTICE));
+	sent.push_back(longLine);
+
+	int client = accept(server, NULL, NULL);
+	timeval timeout = {s_timeoutMillis/1000, 0};
+	setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	std::vector<std::string> received;
+	std::vector<char> buffer(1024*1024);
+	unsigned int numBatches = 0, numMultiline = 0;
+	while(received.size() < sent.size())
+	{
+		ssize_t size = recv(client, &buffer[0], buffer.size(), 0);
+		if(size <= 0)
+		{
+			break;
+		}
+
+		std::string name;
+		std::vector<ofxLogSocketChannel::Record> records;
+		if(!ofxLogSocketChannel::decodeBatch(&buffer[0], size, name, records))
+		{
+			check(false, "batching", "malformed batch of "+ofToString(size)+" bytes");
+			break;
+		}
+		check(name == "test", "batching", "sender name is \""+name+"\"");
+		check(records.size() == 1 || (std::size_t) size <= s_batchSizeKB*1024, "batching",
+			  "a batch of "+ofToString(records.size())+" lines is "+ofToString(size)+" bytes");
+		numBatches++;
+		numMultiline += records.size() > 1;
+		for(std::size_t i = 0; i < records.size(); ++i)
+		{
+			received.push_back(records[i].text);
+		}
+	}
+	check(numBatches > 1, "batching", "everything came in one batch");
+	check(numMultiline > 0, "batching", "every batch had a single line");
+	compareLines("batching", sent, received);
+
+	closeChannel(channel);
+	close(client);
+	close(server);
+	unlink(socketPath.c_str());
+}
+
+static void testRoundTripAndReconnect()
+{
+	unlink(logPath.c_str());
+	pid_t collector = startCollector();
+
+	std::vector<std::string> sent;
+	ofxLogSocketChannel* channel = openChannel();
+	logLines(channel, "roundtrip", 0, s_numLines, sent);
+	compareLines("roundtrip", sent, waitForLines(sent.size()));
+
+	// lines logged while there's no collector wait in the queue, the
+	// sender retries the connection every second
+	stopCollector(collector);
+	logLines(channel, "reconnect", 0, s_numLines/10, sent);
+	usleep(200*1000);
+	check(!channel->isConnected(), "reconnect", "still connected after the collector quit");
+
+	collector = startCollector();
+	logLines(channel, "reconnect", s_numLines/10, s_numLines/10, sent);
+	compareLines("reconnect", sent, waitForLines(sent.size()));
+	check(channel->getNumDropped() == 0, "reconnect", ofToString(channel->getNumDropped())+" lines dropped");
+
+	closeChannel(channel);
+	stopCollector(collector);
+	unlink(logPath.c_str());
+}
+
+//========================================================================
+int main(int argc, char** argv)
+{
+	if(argc != 2)
+	{
+		printf("Usage: loggerCollectorTest path/to/loggerCollector\n");
+		return 2;
+	}
+	collectorPath = argv[1];
+	socketPath = "/tmp/loggerCollectorTest-"+ofToString(getpid())+".sock";
+	logPath = "/tmp/loggerCollectorTest-"+ofToString(getpid())+".log";
+	signal(SIGPIPE, SIG_IGN);
+
+	testBatching();
+	testRoundTripAndReconnect();
+
+	if(numFailed > 0)
+	{
+		printf("%d failed\n", numFailed);
+		return 1;
+	}
+	printf("ok\n");
+	return 0;
+}
@@ -0,0 +1,361 @@
+#include "ofxLogger.h"
+
+#include <Poco/File.h>
+
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+typedef std::chrono::steady_clock Clock;
+
+static const std::string s_dir = "/tmp/loggerFrameLoad";
+
+//--------------------------------------------------------------
+static void printUsage()
+{
+	printf("Usage: loggerFrameLoad [options]\n");
+	printf("\n");
+	printf("Runs a headless fixed rate update()/draw() loop that logs like an app\n");
+	printf("does & prints the frame time percentiles & the worst stall for each\n");
+	printf("logging pattern & logger configuration. The console output goes to\n");
+	printf("/dev/null, the files to %s.\n", s_dir.c_str());
+	printf("\n");
+	printf("  -p, --pattern NAME  steady, burst, threads or all (default all)\n");
+	printf("  -c, --config NAME   console, file, rotation, header, frameflush or all\n");
+	printf("                      (default all)\n");
+	printf("  -f, --fps N         frame rate (default 60)\n");
+	printf("  -n, --frames N      frames per run (default 600)\n");
+	printf("  -w, --work MS       simulated update & draw work per frame (default 2)\n");
+	printf("  -b, --burst N       lines per burst, every 60 frames (default 1000)\n");
+	printf("  -t, --threads N     producer threads for the threads pattern (default 4)\n");
+	printf("  -r, --rate N        lines per second per producer thread (default 2000)\n");
+	printf("      --json          print the results as JSON lines\n");
+	printf("\n");
+	printf("Example: loggerFrameLoad -p burst -c rotation -n 1200\n");
+}
+
+// the run settings
+struct Settings
+{
+	Settings() : fps(60), frames(600), workMillis(2), burst(1000), threads(4), rate(2000), bJson(false) {}
+
+	int fps;
+	int frames;
+	double workMillis;
+	int burst;
+	int threads;
+	int rate;
+	bool bJson;
+};
+
+// the frame times of a run
+struct Result
+{
+	double p50, p90, p99, p999, max;	///< millis
+	int overBudget;						///< frames longer than 1/fps
+};
+
+//--------------------------------------------------------------
+// points stdout at /dev/null while the logger writes to the console
+class MuteStdout
+{
+	public:
+
+		MuteStdout()
+		{
+			fflush(stdout);
+			saved = dup(STDOUT_FILENO);
+			int null = open("/dev/null", O_WRONLY);
+			dup2(null, STDOUT_FILENO);
+			close(null);
+		}
+
+		~MuteStdout()
+		{
+			fflush(stdout);
+			dup2(saved, STDOUT_FILENO);
+			close(saved);
+		}
+
+	private:
+
+		int saved;
+};
+
+//--------------------------------------------------------------
+// sets up a logger configuration, each starts from the console alone
+static bool setupConfig(const std::string& config)
+{
+	ofxLog::disableFile();
+	ofxLog::disableFileRotation();
+	ofxLog::disableHeader();
+	ofxLog::disableFrameFlush();
+	ofxLog::enableConsole();
+	Poco::File(s_dir).createDirectories();
+	ofxLog::setFilePath(s_dir+"/frames.log");
+
+	if(config == "console")
+	{
+		return true;
+	}
+	ofxLog::disableConsole();
+	ofxLog::enableFile();
+	if(config == "file")
+	{
+		return true;
+	}
+	if(config == "rotation")
+	{
+		// small enough to rotate every few seconds of steady logging
+		ofxLog::enableFileRotationSize(64);
+		ofxLog::setFileRotationMaxNum(4);
+		return true;
+	}
+	if(config == "frameflush")
+	{
+		// the console & file lines written once per frame
+		ofxLog::enableConsole();
+		ofxLog::enableFrameFlush();
+		return true;
+	}
+	if(config == "header")
+	{
+		ofxLog::enableHeader();
+		ofxLog::enableHeaderFrameNum();
+		ofxLog::enableHeaderMillis();
+		return true;
+	}
+	return false;
+}
+
+// spins for the given time, so the work isn't a sleep the scheduler can stretch
+static void work(double millis)
+{
+	Clock::time_point end = Clock::now()+std::chrono::microseconds((long long) (millis*1000));
+	while(Clock::now() < end) {}
+}
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+	std::size_t index = (std::size_t) (p*(sorted.size()-1)+0.5);
+	return sorted[std::min(index, sorted.size()-1)];
+}
+
+//--------------------------------------------------------------
+// runs the frame loop with a logging pattern & returns the frame times
+static Result runFrames(const Settings& settings, const std::string& pattern)
+{
+	// producer threads log on their own while the frames run
+	std::atomic<bool> bStop(false);
+	std::vector<std::thread> producers;
+	if(pattern == "threads")
+	{
+		for(int i = 0; i < settings.threads; ++i)
+		{
+			producers.push_back(std::thread([&settings, &bStop, i]{
+				Clock::duration period = std::chrono::nanoseconds(1000000000LL/std::max(settings.rate, 1));
+				Clock::time_point next = Clock::now();
+				unsigned int n = 0;
+				while(!bStop.load(std::memory_order_relaxed))
+				{
+					ofxLogWarning("frameLoad") << "producer " << i << " line " << n++;
+					next += period;
+					std::this_thread::sleep_until(next);
+				}
+			}));
+		}
+	}
+
+	std::vector<double> times;
+	times.reserve(settings.frames);
+	Clock::duration frameTime = std::chrono::nanoseconds(1000000000LL/settings.fps);
+	Clock::time_point next = Clock::now();
+	for(int frame = 0; frame < settings.frames; ++frame)
+	{
+		Clock::time_point start = Clock::now();
+
+		// the frame hooks run at the start of update(), as in ofAppRunner
+		ofEventArgs args;
+		ofNotifyEvent(ofEvents.update, args);
+
+		// update(), steady per frame warnings as in testApp::update
+		ofxLogWarning() << "testApp::update ... a new frame";
+		if(pattern == "burst" && frame % 60 == 59)
+		{
+			for(int i = 0; i < settings.burst; ++i)
+			{
+				ofxLogWarning("frameLoad") << "burst line " << i << " of " << settings.burst;
+			}
+		}
+		work(settings.workMillis/2);
+
+		// draw()
+		work(settings.workMillis/2);
+
+		times.push_back(std::chrono::duration<double, std::milli>(Clock::now()-start).count());
+
+		// wait for the next frame, dropping frames instead of catching up
+		next += frameTime;
+		Clock::time_point now = Clock::now();
+		if(next < now)
+		{
+			next = now;
+		}
+		std::this_thread::sleep_until(next);
+	}
+
+	bStop = true;
+	for(unsigned int i = 0; i < producers.size(); ++i)
+	{
+		producers[i].join();
+	}
+	ofxLog::flush();
+
+	double budget = 1000.0/settings.fps;
+	Result result;
+	result.overBudget = (int) std::count_if(times.begin(), times.end(),
+		[budget](double t){return t > budget;});
+	std::sort(times.begin(), times.end());
+	result.p50 = percentile(times, 0.5);
+	result.p90 = percentile(times, 0.9);
+	result.p99 = percentile(times, 0.99);
+	result.p999 = percentile(times, 0.999);
+	result.max = times.back();
+	return result;
+}
+
+//========================================================================
+// headless, no window or GL context is needed
+int main(int argc, char** argv)
+{
+	Settings settings;
+	std::vector<std::string> patterns, configs;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool bHasValue = i+1 < argc;
+
+		if((arg == "-p" || arg == "--pattern") && bHasValue)
+		{
+			patterns.push_back(argv[++i]);
+		}
+		else if((arg == "-c" || arg == "--config") && bHasValue)
+		{
+			configs.push_back(argv[++i]);
+		}
+		else if((arg == "-f" || arg == "--fps") && bHasValue)
+		{
+			settings.fps = std::max(ofToInt(argv[++i]), 1);
+		}
+		else if((arg == "-n" || arg == "--frames") && bHasValue)
+		{
+			settings.frames = std::max(ofToInt(argv[++i]), 1);
+		}
+		else if((arg == "-w" || arg == "--work") && bHasValue)
+		{
+			settings.workMillis = ofToFloat(argv[++i]);
+		}
+		else if((arg == "-b" || arg == "--burst") && bHasValue)
+		{
+			settings.burst = ofToInt(argv[++i]);
+		}
+		else if((arg == "-t" || arg == "--threads") && bHasValue)
+		{
+			settings.threads = ofToInt(argv[++i]);
+		}
+		else if((arg == "-r" || arg == "--rate") && bHasValue)
+		{
+			settings.rate = ofToInt(argv[++i]);
+		}
+		else if(arg == "--json")
+		{
+			settings.bJson = true;
+		}
+		else if(arg == "-h" || arg == "--help")
+		{
+			printUsage();
+			return 0;
+		}
+		else
+		{
+			fprintf(stderr, "loggerFrameLoad: unknown option \"%s\"\n", arg.c_str());
+			printUsage();
+			return 2;
+		}
+	}
+	if(patterns.empty() || patterns[0] == "all")
+	{
+		patterns = {"steady", "burst", "threads"};
+	}
+	if(configs.empty() || configs[0] == "all")
+	{
+		configs = {"console", "file", "rotation", "header", "frameflush"};
+	}
+
+	// the results go to a copy of stdout, the console sink gets /dev/null
+	FILE* out = fdopen(dup(STDOUT_FILENO), "w");
+	if(!out)
+	{
+		out = stdout;
+	}
+	if(!settings.bJson)
+	{
+		fprintf(out, "%d fps, %d frames, %.1f ms work, budget %.2f ms\n",
+			settings.fps, settings.frames, settings.workMillis, 1000.0/settings.fps);
+		fprintf(out, "%-8s %-9s %8s %8s %8s %8s %8s %6s\n",
+			"pattern", "config", "p50", "p90", "p99", "p99.9", "max", "over");
+	}
+
+	ofxLog::setLevel(OF_LOG_WARNING);
+	ofxLog::addTopic("frameLoad", OF_LOG_WARNING);
+	for(unsigned int c = 0; c < configs.size(); ++c)
+	{
+		for(unsigned int p = 0; p < patterns.size(); ++p)
+		{
+			const std::string& pattern = patterns[p];
+			if(pattern != "steady" && pattern != "burst" && pattern != "threads")
+			{
+				fprintf(stderr, "loggerFrameLoad: unknown pattern \"%s\"\n", pattern.c_str());
+				return 2;
+			}
+
+			Result result;
+			{
+				MuteStdout mute;
+				if(!setupConfig(configs[c]))
+				{
+					fprintf(stderr, "loggerFrameLoad: unknown config \"%s\"\n", configs[c].c_str());
+					return 2;
+				}
+				result = runFrames(settings, pattern);
+				ofxLog::disableFrameFlush();
+				ofxLog::disableFile();
+				ofxLog::disableConsole();
+			}
+			Poco::File(s_dir).remove(true);
+
+			if(settings.bJson)
+			{
+				fprintf(out, "{\"pattern\":\"%s\",\"config\":\"%s\",\"fps\":%d,\"frames\":%d,"
+					"\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"p999\":%.3f,\"max\":%.3f,\"overBudget\":%d}\n",
+					pattern.c_str(), configs[c].c_str(), settings.fps, settings.frames,
+					result.p50, result.p90, result.p99, result.p999, result.max, result.overBudget);
+			}
+			else
+			{
+				fprintf(out, "%-8s %-9s %8.3f %8.3f %8.3f %8.3f %8.3f %6d\n",
+					pattern.c_str(), configs[c].c_str(), result.p50, result.p90, result.p99,
+					result.p999, result.max, result.overBudget);
+			}
+			fflush(out);
+		}
+	}
+
+	ofxLog::enableConsole();
+	return 0;
+}
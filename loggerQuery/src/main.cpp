@@ -0,0 +1,152 @@
+#include "ofxLogQuery.h"
+
+//--------------------------------------------------------------
+static void printUsage()
+{
+	printf("Usage: loggerQuery [options] logfile [archives ...]\n");
+	printf("\n");
+	printf("Searches an ofxLogger log file and its rotated archives. A single log file\n");
+	printf("is expanded to its archives (logfile.N, logfile.TIMESTAMP, .gz), oldest first.\n");
+	printf("\n");
+	printf("  -l, --level LEVEL   min level: verbose, notice, warning, error, fatal\n");
+	printf("  -t, --topic TOPIC   topic & its children (\"net\" matches \"net.http\")\n");
+	printf("  -f, --from TIME     from YYYY-MM-DD [HH:MM[:SS[.mmm]]] or HH:MM[:SS[.mmm]]\n");
+	printf("  -u, --until TIME    until, same formats as --from\n");
+	printf("  -g, --grep TEXT     lines containing TEXT\n");
+	printf("  -j, --jobs NUM      search NUM files at once (default: num cores)\n");
+	printf("  -H, --with-filename print the file name before each line\n");
+	printf("      --index         only (re)build the archive indexes\n");
+	printf("      --no-index      don't write archive indexes\n");
+	printf("\n");
+	printf("Example: loggerQuery -l error -t net -f 14:00 -u 14:05 data/openframeworks.log\n");
+}
+
+static bool parseLevel(const std::string& name, ofLogLevel& level)
+{
+	if(name == "verbose")		level = OF_LOG_VERBOSE;
+	else if(name == "notice")	level = OF_LOG_NOTICE;
+	else if(name == "warning")	level = OF_LOG_WARNING;
+	else if(name == "error")	level = OF_LOG_ERROR;
+	else if(name == "fatal")	level = OF_LOG_FATAL_ERROR;
+	else return false;
+	return true;
+}
+
+//========================================================================
+int main(int argc, char** argv)
+{
+	ofxLogQuery query;
+	std::vector<std::string> files;
+	bool bFileNames = false;
+	bool bIndexOnly = false;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool bHasValue = i+1 < argc;
+
+		if((arg == "-l" || arg == "--level") && bHasValue)
+		{
+			ofLogLevel level;
+			if(!parseLevel(argv[++i], level))
+			{
+				fprintf(stderr, "loggerQuery: unknown level \"%s\"\n", argv[i]);
+				return 2;
+			}
+			query.setMinLevel(level);
+		}
+		else if((arg == "-t" || arg == "--topic") && bHasValue)
+		{
+			query.setTopic(argv[++i]);
+		}
+		else if((arg == "-f" || arg == "--from") && bHasValue)
+		{
+			if(!query.setFrom(argv[++i]))
+			{
+				fprintf(stderr, "loggerQuery: can't parse time \"%s\"\n", argv[i]);
+				return 2;
+			}
+		}
+		else if((arg == "-u" || arg == "--until") && bHasValue)
+		{
+			if(!query.setUntil(argv[++i]))
+			{
+				fprintf(stderr, "loggerQuery: can't parse time \"%s\"\n", argv[i]);
+				return 2;
+			}
+		}
+		else if((arg == "-g" || arg == "--grep") && bHasValue)
+		{
+			query.setText(argv[++i]);
+		}
+		else if((arg == "-j" || arg == "--jobs") && bHasValue)
+		{
+			query.setNumThreads(atoi(argv[++i]));
+		}
+		else if(arg == "-H" || arg == "--with-filename")
+		{
+			bFileNames = true;
+		}
+		else if(arg == "--index")
+		{
+			bIndexOnly = true;
+		}
+		else if(arg == "--no-index")
+		{
+			query.setWriteIndexes(false);
+		}
+		else if(arg == "-h" || arg == "--help")
+		{
+			printUsage();
+			return 0;
+		}
+		else if(!arg.empty() && arg[0] == '-')
+		{
+			fprintf(stderr, "loggerQuery: unknown option \"%s\"\n", arg.c_str());
+			printUsage();
+			return 2;
+		}
+		else
+		{
+			files.push_back(arg);
+		}
+	}
+
+	if(files.empty())
+	{
+		printUsage();
+		return 2;
+	}
+	if(files.size() == 1)
+	{
+		files = ofxLogQuery::findArchives(files[0]);
+	}
+
+	if(bIndexOnly)
+	{
+		int ret = 0;
+		// the last file is the live log, which keeps changing
+		for(std::size_t i = 0; i+1 < files.size(); ++i)
+		{
+			if(!ofxLogQuery::buildIndex(files[i]))
+			{
+				fprintf(stderr, "loggerQuery: couldn't index \"%s\"\n", files[i].c_str());
+				ret = 2;
+			}
+		}
+		return ret;
+	}
+
+	// like grep: 0 if something matched, 1 if not
+	std::vector<ofxLogQuery::Match> matches = query.search(files);
+	for(std::size_t i = 0; i < matches.size(); ++i)
+	{
+		if(bFileNames)
+		{
+			printf("%s: ", matches[i].file.c_str());
+		}
+		fwrite(matches[i].line.data(), 1, matches[i].line.size(), stdout);
+		fputc('\n', stdout);
+	}
+	return matches.empty() ? 1 : 0;
+}
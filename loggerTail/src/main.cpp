@@ -0,0 +1,251 @@
+#include "ofxLogSharedMemoryChannel.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef ofxLogSharedMemoryChannel::Header Header;
+typedef ofxLogSharedMemoryChannel::Slot Slot;
+
+static volatile sig_atomic_t bQuit = 0;
+
+//--------------------------------------------------------------
+static void quit(int)
+{
+	bQuit = 1;
+}
+
+static void printUsage()
+{
+	printf("Usage: loggerTail [options] [name]\n");
+	printf("\n");
+	printf("Follows the log lines an app writes into shared memory with\n");
+	printf("ofxLogSharedMemoryChannel (default name \"/ofxLogger\"). Attaching &\n");
+	printf("detaching (Ctrl-C) never affects the app.\n");
+	printf("\n");
+	printf("  -l, --level LEVEL   min level: verbose, notice, warning, error, fatal\n");
+	printf("  -t, --topic TOPIC   topic & its children (\"net\" matches \"net.http\")\n");
+	printf("  -a, --all           start with the lines still in the ring\n");
+	printf("  -x, --exit          exit when there are no new lines instead of following\n");
+	printf("\n");
+	printf("Example: loggerTail -l warning -t net\n");
+}
+
+// maps a level name to the highest Poco priority that passes
+static bool parseLevel(const std::string& name, int& priority)
+{
+	if(name == "verbose")		priority = Poco::Message::PRIO_TRACE;
+	else if(name == "notice")	priority = Poco::Message::PRIO_NOTICE;
+	else if(name == "warning")	priority = Poco::Message::PRIO_WARNING;
+	else if(name == "error")	priority = Poco::Message::PRIO_ERROR;
+	else if(name == "fatal")	priority = Poco::Message::PRIO_FATAL;
+	else return false;
+	return true;
+}
+
+//--------------------------------------------------------------
+// is the topic the filter topic or one of its children?
+static bool matchesTopic(const std::string& filter, const char* topic, std::size_t size)
+{
+	return filter.empty() || (size >= filter.size() &&
+		memcmp(topic, filter.data(), filter.size()) == 0 &&
+		(size == filter.size() || topic[filter.size()] == '.'));
+}
+
+// attach to the segment read only, so a tail can never write into the ring
+static Header* attach(const std::string& name, std::size_t& size)
+{
+	int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if(fd < 0)
+	{
+		return NULL;
+	}
+	struct stat info;
+	if(fstat(fd, &info) != 0 || (std::size_t) info.st_size < sizeof(Header))
+	{
+		close(fd);
+		return NULL;
+	}
+	size = info.st_size;
+	void* p = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(p == MAP_FAILED)
+	{
+		return NULL;
+	}
+
+	Header* header = (Header*) p;
+	if(header->magic != ofxLogSharedMemoryChannel::s_magic ||
+	   header->version != ofxLogSharedMemoryChannel::s_version ||
+	   header->slotSize != ofxLogSharedMemoryChannel::s_slotSize ||
+	   sizeof(Header)+(std::size_t) header->numSlots*header->slotSize > size)
+	{
+		munmap(p, size);
+		return NULL;
+	}
+	return header;
+}
+
+//========================================================================
+int main(int argc, char** argv)
+{
+	std::string name = "/ofxLogger";
+	std::string topic;
+	int maxPriority = Poco::Message::PRIO_TRACE;
+	bool bAll = false;
+	bool bExit = false;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool bHasValue = i+1 < argc;
+
+		if((arg == "-l" || arg == "--level") && bHasValue)
+		{
+			if(!parseLevel(argv[++i], maxPriority))
+			{
+				fprintf(stderr, "loggerTail: unknown level \"%s\"\n", argv[i]);
+				return 2;
+			}
+		}
+		else if((arg == "-t" || arg == "--topic") && bHasValue)
+		{
+			topic = argv[++i];
+		}
+		else if(arg == "-a" || arg == "--all")
+		{
+			bAll = true;
+		}
+		else if(arg == "-x" || arg == "--exit")
+		{
+			bExit = true;
+		}
+		else if(arg == "-h" || arg == "--help")
+		{
+			printUsage();
+			return 0;
+		}
+		else if(!arg.empty() && arg[0] == '-')
+		{
+			fprintf(stderr, "loggerTail: unknown option \"%s\"\n", arg.c_str());
+			printUsage();
+			return 2;
+		}
+		else
+		{
+			name = arg;
+		}
+	}
+
+	std::size_t size;
+	Header* header = attach(name, size);
+	if(!header)
+	{
+		fprintf(stderr, "loggerTail: couldn't attach to \"%s\", is the app logging to it?\n", name.c_str());
+		return 1;
+	}
+
+	signal(SIGINT, quit);
+	signal(SIGTERM, quit);
+
+	const uint64_t numSlots = header->numSlots;
+	uint64_t next = header->writeSeq.load(std::memory_order_acquire);
+	if(bAll)
+	{
+		next = next > numSlots ? next-numSlots : 0;
+	}
+
+	Slot copy;
+	uint64_t numLost = 0;
+	unsigned int numRetries = 0;
+
+	while(!bQuit)
+	{
+		uint64_t writeSeq = header->writeSeq.load(std::memory_order_acquire);
+		if(writeSeq < next)
+		{
+			// the app restarted with a fresh ring
+			next = writeSeq;
+		}
+		if(next == writeSeq)
+		{
+			fflush(stdout);
+			if(bExit)
+			{
+				break;
+			}
+			usleep(10000);
+			continue;
+		}
+
+		// too far behind, skip what's been overwritten
+		if(writeSeq-next > numSlots)
+		{
+			numLost += writeSeq-numSlots-next;
+			next = writeSeq-numSlots;
+		}
+
+		// copy the slot & make sure it wasn't rewritten while copying
+		Slot* slot = ofxLogSharedMemoryChannel::getSlot(header, next);
+		uint64_t stamp = slot->stamp.load(std::memory_order_acquire);
+		uint64_t done = next*2+2;
+		if(stamp < done)
+		{
+			// claimed but not written yet, give the writer a moment unless
+			// it went away in the middle of the line
+			if(++numRetries < 100)
+			{
+				usleep(100);
+				continue;
+			}
+			numLost++;
+		}
+		else if(stamp > done)
+		{
+			numLost++; // overwritten before we got to it
+		}
+		else
+		{
+			memcpy((char*) &copy+sizeof(copy.stamp), (const char*) slot+sizeof(copy.stamp),
+				sizeof(copy)-sizeof(copy.stamp));
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			// The stamp alone misses the ring lapping the reader: a slow
+			// writer from a ring earlier can store its done stamp while a
+			// newer one is still writing the slot. The copy is only good if
+			// the slot's next sequence number hasn't been claimed yet.
+			if(slot->stamp.load(std::memory_order_relaxed) != stamp ||
+			   header->writeSeq.load(std::memory_order_relaxed)-next > numSlots)
+			{
+				numLost++;
+			}
+			else
+			{
+				std::size_t topicSize = copy.topicSize;
+				std::size_t textSize = std::min((std::size_t) copy.textSize, sizeof(copy.data)-topicSize);
+				if(copy.priority <= maxPriority && matchesTopic(topic, copy.data, topicSize))
+				{
+					if(numLost > 0)
+					{
+						printf("--- lost %llu records ---\n", (unsigned long long) numLost);
+						numLost = 0;
+					}
+					fwrite(copy.data+topicSize, 1, textSize, stdout);
+					fputc('\n', stdout);
+				}
+			}
+		}
+		numRetries = 0;
+		next++;
+	}
+
+	if(numLost > 0)
+	{
+		printf("--- lost %llu records ---\n", (unsigned long long) numLost);
+	}
+	munmap(header, size);
+	return 0;
+}
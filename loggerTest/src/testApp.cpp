@@ -38,6 +38,12 @@ void testApp::setup(){
 	
 	ofxLog::disableHeaderDate();
 	ofxLog::disableHeaderTime();
+	
+	// switch on a single verbose line without lowering the level
+	ofxLog::setSiteMode("testApp.cpp", __LINE__+1, ofxLogSite::ON);
+	OFX_LOG_VERBOSE("of.topic1") << "a verbose line from a site that's switched on";
+	
+	ofxBitmapString::enableBatching();
 }
 
 //--------------------------------------------------------------
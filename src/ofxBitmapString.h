@@ -2,6 +2,12 @@
 
 #include "ofMain.h"
 
+#include "ofxBitmapStringBatch.h"
+#include "ofxLogBuffer.h"
+
+#include <iomanip>
+#include <type_traits>
+
 //------------------------------------------------------------------------------
 /// \class ofxBitmapStream
 /// \brief a stream interface to ofDrawBitmapStream
@@ -12,6 +18,14 @@
 ///
 /// Usage: ofxBitmapString(10, 10) << "a string" << 100 << 20.234f;
 ///
+/// The string is built in an ofxLogBuffer inside the object, like ofxLog, so
+/// a typical HUD line of strings & numbers doesn't allocate. A formatting
+/// control (hex, setw, etc) switches the rest of the string over to a
+/// std::ostringstream.
+///
+/// With batching enabled, the strings are collected & drawn together after
+/// the app's draw(), see ofxBitmapStringBatch.
+///
 /// class idea from:
 /// 	http://www.gamedev.net/community/forums/topic.asp?topic_id=525405&whichpage=1&#3406418
 /// how to catch std::endl (which is actually a func pointer):
@@ -25,38 +39,101 @@ class ofxBitmapString
 		ofxBitmapString(const ofPoint & p)
 		{
 			pos = p;
+			stream = NULL;
 		}
 		
 		ofxBitmapString(float x, float y, float z=0.0f)
 		{
 			pos.set(x, y, z);
+			stream = NULL;
 		}
 		
 		/// does the actual printing on when the ostream is done
         ~ofxBitmapString()
 		{
-			ofDrawBitmapString(message.str(), pos.x, pos.y, pos.z);
+			if(stream)
+			{
+				message.append(stream->str());
+				delete stream;
+			}
+			if(ofxBitmapStringBatch::isEnabled())
+			{
+				ofxBitmapStringBatch::frame().add(message.c_str(), message.size(), pos.x, pos.y);
+			}
+			else
+			{
+				ofDrawBitmapString(message.str(), pos.x, pos.y, pos.z);
+			}
 		}
 		
+		/// batch the strings each frame instead of drawing them one by one
+		static void enableBatching()	{ofxBitmapStringBatch::enable();}
+		static void disableBatching()	{ofxBitmapStringBatch::disable();}
+		static bool usingBatching()		{return ofxBitmapStringBatch::isEnabled();}
+		
 		/// catch the << ostream with a template class to read any type of data
         template <class T> 
 		ofxBitmapString& operator<<(const T& value)
 		{
-            message << value;
+			if(stream || _isManipulator<T>::value)
+			{
+				_stream() << value;
+			}
+			else
+			{
+				message << value;
+			}
             return *this;
         }
 
         /// catch the << ostream function pointers such as std::endl and std::hex
         ofxBitmapString& operator<<(std::ostream& (*func)(std::ostream&))
 		{
-			func(message);
+			if(!stream && func == static_cast<std::ostream& (*)(std::ostream&)>(std::endl))
+			{
+				message.append('\n');
+			}
+			else if(stream || func != static_cast<std::ostream& (*)(std::ostream&)>(std::flush))
+			{
+				func(_stream());
+			}
+            return *this;
+        }
+		
+		ofxBitmapString& operator<<(std::ios_base& (*func)(std::ios_base&))
+		{
+			func(_stream());
             return *this;
         }
 		
 	private:
 	
+		/// the setw, setprecision, etc types, they change the stream's state
+		template <class T>
+		struct _isManipulator
+		{
+			static const bool value =
+				std::is_same<T, decltype(std::setw(0))>::value ||
+				std::is_same<T, decltype(std::setprecision(0))>::value ||
+				std::is_same<T, decltype(std::setfill('0'))>::value ||
+				std::is_same<T, decltype(std::setbase(0))>::value ||
+				std::is_same<T, decltype(std::setiosflags(std::ios_base::fmtflags()))>::value ||
+				std::is_same<T, decltype(std::resetiosflags(std::ios_base::fmtflags()))>::value;
+		};
+		
+		/// the stream used once a manipulator is used, created when needed
+		std::ostringstream& _stream()
+		{
+			if(!stream)
+			{
+				stream = new std::ostringstream;
+			}
+			return *stream;
+		}
+		
 		ofPoint pos;				///< temp position
-        std::ostringstream message;	///< temp buffer
+        ofxLogBuffer message;		///< temp buffer
+		std::ostringstream* stream;	///< the rest of the string after a manipulator, NULL if none
 		
 		ofxBitmapString(ofxBitmapString const&) {}        		// not defined, not copyable
         ofxBitmapString& operator=(ofxBitmapString& from) {return *this;}	// not defined, not assignable
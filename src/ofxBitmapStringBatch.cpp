@@ -0,0 +1,268 @@
+#include "ofxBitmapStringBatch.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const float s_glyphSize = 8.0f;				// the bitmap font advance
+static const float s_lineHeight = s_glyphSize*1.7f;
+static const int s_tabColumns = 8;
+static const unsigned int s_noLine = (unsigned int) -1;	// a key whose line was reused
+
+bool ofxBitmapStringBatch::s_bEnabled = false;
+
+//--------------------------------------------------------------
+ofxBitmapStringBatch::ofxBitmapStringBatch()
+{
+	numLines = 0;
+	numLastLines = 0;
+	numReused = 0;
+	numDraws = 0;
+}
+
+//--------------------------------------------------------------
+void ofxBitmapStringBatch::add(const char* text, std::size_t size, float x, float y, const ofColor& color)
+{
+	if(numLines == lines.size())
+	{
+		lines.resize(numLines+1);
+	}
+	Line& line = lines[numLines];
+	std::size_t hash = _hash(text, size, x, y);
+
+	// the same line in the same place as a line last frame keeps its glyphs,
+	// wherever it was in last frame's order
+	bool bReused = false;
+	std::vector<LineKey>::iterator key = std::lower_bound(lastKeys.begin(), lastKeys.end(), hash, _keyLess);
+	for(; key != lastKeys.end() && key->hash == hash; ++key)
+	{
+		if(key->line == s_noLine)
+		{
+			continue; // already reused by an identical line this frame
+		}
+		Line& last = lastLines[key->line];
+		if(last.x == x && last.y == y && last.text.size() == size &&
+		   memcmp(last.text.data(), text, size) == 0)
+		{
+			line.glyphs.swap(last.glyphs);
+			key->line = s_noLine;
+			++numReused;
+			bReused = true;
+			break;
+		}
+	}
+	if(!bReused)
+	{
+		layout(text, size, x, y, line.glyphs);
+	}
+
+	line.text.assign(text, size);
+	line.x = x;
+	line.y = y;
+	line.color = color;
+	line.hash = hash;
+	++numLines;
+}
+
+void ofxBitmapStringBatch::add(const char* text, std::size_t size, float x, float y)
+{
+	add(text, size, x, y, ofGetStyle().color);
+}
+
+void ofxBitmapStringBatch::add(const std::string& text, float x, float y, const ofColor& color)
+{
+	add(text.data(), text.size(), x, y, color);
+}
+
+void ofxBitmapStringBatch::add(const std::string& text, float x, float y)
+{
+	add(text.data(), text.size(), x, y, ofGetStyle().color);
+}
+
+void ofxBitmapStringBatch::draw()
+{
+	numDraws = 0;
+	if(numLines > 0)
+	{
+		ofColor color = ofGetStyle().color;
+		unsigned int first = 0;
+		while(first < numLines)
+		{
+			// one draw for each run of lines in the same color
+			unsigned int last = first;
+			unsigned int numGlyphs = 0;
+			while(last < numLines && _sameColor(lines[last].color, lines[first].color))
+			{
+				numGlyphs += lines[last].glyphs.size();
+				++last;
+			}
+
+			ofSetColor(lines[first].color);
+			ofDrawBitmapCharacterStart(numGlyphs);
+			for(unsigned int i = first; i < last; ++i)
+			{
+				const std::vector<Glyph>& glyphs = lines[i].glyphs;
+				for(unsigned int g = 0; g < glyphs.size(); ++g)
+				{
+					ofDrawBitmapCharacter(glyphs[g].character, glyphs[g].x, glyphs[g].y);
+				}
+			}
+			ofDrawBitmapCharacterEnd();
+			++numDraws;
+			first = last;
+		}
+		ofSetColor(color);
+	}
+	endFrame();
+}
+
+void ofxBitmapStringBatch::endFrame()
+{
+	// the lines are swapped, not freed, so their strings & glyphs are reused
+	lines.swap(lastLines);
+	numLastLines = numLines;
+	numLines = 0;
+	numReused = 0;
+
+	// index the lines by content for add() to find them, lastKeys keeps
+	// its capacity so this doesn't allocate once the lines have been seen
+	lastKeys.resize(numLastLines);
+	for(unsigned int i = 0; i < numLastLines; ++i)
+	{
+		lastKeys[i].hash = lastLines[i].hash;
+		lastKeys[i].line = i;
+	}
+	std::sort(lastKeys.begin(), lastKeys.end(), _keyOrder);
+}
+
+void ofxBitmapStringBatch::clear()
+{
+	numLines = 0;
+	numLastLines = 0;
+	numReused = 0;
+	lastKeys.clear();
+}
+
+//--------------------------------------------------------------
+unsigned int ofxBitmapStringBatch::getNumGlyphs() const
+{
+	unsigned int numGlyphs = 0;
+	for(unsigned int i = 0; i < numLines; ++i)
+	{
+		numGlyphs += lines[i].glyphs.size();
+	}
+	return numGlyphs;
+}
+
+const std::vector<ofxBitmapStringBatch::Glyph>& ofxBitmapStringBatch::getGlyphs(unsigned int line) const
+{
+	return lines.at(line).glyphs;
+}
+
+void ofxBitmapStringBatch::layout(const char* text, std::size_t size, float x, float y, std::vector<Glyph>& glyphs)
+{
+	glyphs.clear();
+	float sx = 0;
+	float sy = -s_glyphSize;
+	int column = 0;
+	for(std::size_t i = 0; i < size; ++i)
+	{
+		unsigned char c = (unsigned char) text[i];
+		if(c == '\n')
+		{
+			sy += s_lineHeight;
+			sx = 0;
+			column = 0;
+		}
+		else if(c == '\t')
+		{
+			// on to the next tab stop
+			int next = column+s_tabColumns-(column % s_tabColumns);
+			sx += s_glyphSize*(next-column);
+			column = next;
+		}
+		else if(c >= 32)
+		{
+			// control characters aren't drawn
+			Glyph glyph;
+			glyph.character = c;
+			glyph.x = (int) (x+sx);
+			glyph.y = (int) (y+sy);
+			glyphs.push_back(glyph);
+			sx += s_glyphSize;
+			++column;
+		}
+	}
+}
+
+void ofxBitmapStringBatch::layout(const std::string& text, float x, float y, std::vector<Glyph>& glyphs)
+{
+	layout(text.data(), text.size(), x, y, glyphs);
+}
+
+//--------------------------------------------------------------
+void ofxBitmapStringBatch::enable()
+{
+	if(s_bEnabled)
+	{
+		return;
+	}
+	ofAddListener(ofEvents.draw, &frame(), &ofxBitmapStringBatch::onDraw);
+	s_bEnabled = true;
+}
+
+void ofxBitmapStringBatch::disable()
+{
+	if(!s_bEnabled)
+	{
+		return;
+	}
+	ofRemoveListener(ofEvents.draw, &frame(), &ofxBitmapStringBatch::onDraw);
+	s_bEnabled = false;
+	frame().draw();
+	frame().clear();
+}
+
+ofxBitmapStringBatch& ofxBitmapStringBatch::frame()
+{
+	// never freed, so ofxBitmapStrings in static destructors still have a batch
+	static ofxBitmapStringBatch* batch = new ofxBitmapStringBatch;
+	return *batch;
+}
+
+void ofxBitmapStringBatch::onDraw(ofEventArgs& args)
+{
+	draw();
+}
+
+//--------------------------------------------------------------
+bool ofxBitmapStringBatch::_sameColor(const ofColor& a, const ofColor& b)
+{
+	return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+std::size_t ofxBitmapStringBatch::_hash(const char* text, std::size_t size, float x, float y)
+{
+	// FNV-1a of the text & the position
+	std::size_t hash = 2166136261u;
+	for(std::size_t i = 0; i < size; ++i)
+	{
+		hash = (hash ^ (unsigned char) text[i])*16777619u;
+	}
+	int position[2] = {(int) (x*16), (int) (y*16)};
+	const unsigned char* bytes = (const unsigned char*) position;
+	for(std::size_t i = 0; i < sizeof(position); ++i)
+	{
+		hash = (hash ^ bytes[i])*16777619u;
+	}
+	return hash;
+}
+
+bool ofxBitmapStringBatch::_keyOrder(const LineKey& a, const LineKey& b)
+{
+	return a.hash < b.hash;
+}
+
+bool ofxBitmapStringBatch::_keyLess(const LineKey& key, std::size_t hash)
+{
+	return key.hash < hash;
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "ofMain.h"
+
+//------------------------------------------------------------------------------
+/// \class ofxBitmapStringBatch
+/// \brief collects bitmap strings & draws them all at once
+///
+/// Each ofDrawBitmapString call is its own draw, so a debug HUD with 50 lines
+/// makes 50 draws a frame. With batching on, ofxBitmapString adds its line to
+/// the frame's batch instead & the batch draws the glyphs of every line in one
+/// ofDrawBitmapCharacterStart()/ofDrawBitmapCharacterEnd() run after the app's
+/// draw() (one run per color, if the lines change color):
+///
+///		void testApp::setup()
+///		{
+///			ofxBitmapString::enableBatching();
+///		}
+///
+///		void testApp::draw()
+///		{
+///			ofxBitmapString(20, 12) << "frame: " << ofGetFrameNum();
+///			ofxBitmapString(20, 26) << "  fps: " << ofGetFrameRate();
+///		}
+///
+/// The glyphs are laid out the way ofDrawBitmapString lays them out (8 pixel
+/// glyphs, tabs every 8 columns, lines 1.7 glyphs apart). A line with the
+/// same text & position as a line last frame reuses that line's glyphs, so a
+/// mostly static HUD isn't laid out again each frame. The lines are matched
+/// by content, not order, so a line added or dropped above the others
+/// doesn't make them lay out again.
+///
+/// The lines are drawn with the transform in effect at the end of the frame,
+/// not the one when they were added, and z is ignored: batch the lines drawn
+/// in screen coords & draw the others with ofDrawBitmapString as usual.
+///
+/// Only draw() touches GL, add() & endFrame() just lay out the glyphs, so the
+/// layout & reuse can run headless: loggerBenchmark checks them with
+/// getGlyphs() & getNumReused() before the bitmap benchmarks.
+///
+/// Batches aren't thread safe, draw from the main thread like any other
+/// drawing.
+///
+class ofxBitmapStringBatch
+{
+	public:
+
+		ofxBitmapStringBatch();
+
+		/// a glyph to draw, in pixels
+		struct Glyph
+		{
+			int character;
+			int x;
+			int y;
+		};
+
+		/// Add a line of text at a position, in the current color. The text
+		/// can have newlines & tabs. The text is copied into the line's
+		/// string from last time, so adding doesn't allocate once the lines
+		/// have been seen.
+		void add(const char* text, std::size_t size, float x, float y, const ofColor& color);
+		void add(const char* text, std::size_t size, float x, float y);
+		void add(const std::string& text, float x, float y, const ofColor& color);
+		void add(const std::string& text, float x, float y);
+
+		/// draw the lines added this frame, then start the next frame
+		void draw();
+
+		/// Start the next frame without drawing, the lines of this frame are
+		/// kept to reuse their glyphs. draw() calls this.
+		void endFrame();
+
+		/// forget the lines of this & the last frame
+		void clear();
+
+		/// \section Access
+
+		/// the number of lines added this frame
+		unsigned int getNumLines() const		{return numLines;}
+
+		/// the number of glyphs to draw this frame
+		unsigned int getNumGlyphs() const;
+
+		/// the number of lines this frame that reused last frame's glyphs
+		unsigned int getNumReused() const		{return numReused;}
+
+		/// the number of draws the last draw() made
+		unsigned int getNumDraws() const		{return numDraws;}
+
+		/// the glyphs of a line added this frame
+		const std::vector<Glyph>& getGlyphs(unsigned int line) const;
+
+		/// lay out a line's glyphs the way ofDrawBitmapString does
+		static void layout(const char* text, std::size_t size, float x, float y, std::vector<Glyph>& glyphs);
+		static void layout(const std::string& text, float x, float y, std::vector<Glyph>& glyphs);
+
+		/// \section Batching
+
+		/// Start batching ofxBitmapString, the frame batch is drawn after
+		/// the app's draw() each frame.
+		static void enable();
+
+		/// stop batching, draws the lines already in the frame batch
+		static void disable();
+
+		static bool isEnabled()					{return s_bEnabled;}
+
+		/// the batch ofxBitmapString adds to
+		static ofxBitmapStringBatch& frame();
+
+		/// the draw event listener, draws the frame batch
+		void onDraw(ofEventArgs& args);
+
+	private:
+
+		/// a line & its glyphs
+		struct Line
+		{
+			std::string text;
+			float x;
+			float y;
+			ofColor color;
+			std::size_t hash;			///< of the text & position
+			std::vector<Glyph> glyphs;
+		};
+
+		/// a last frame line, by the hash of its content
+		struct LineKey
+		{
+			std::size_t hash;
+			unsigned int line;			///< in lastLines
+		};
+
+		/// are the colors the same?
+		static bool _sameColor(const ofColor& a, const ofColor& b);
+
+		/// hash a line's text & position
+		static std::size_t _hash(const char* text, std::size_t size, float x, float y);
+
+		/// sort & search the keys by hash
+		static bool _keyOrder(const LineKey& a, const LineKey& b);
+		static bool _keyLess(const LineKey& key, std::size_t hash);
+
+		std::vector<Line> lines;		///< this frame's lines, the first numLines are used
+		std::vector<Line> lastLines;	///< last frame's lines, to reuse their glyphs
+		std::vector<LineKey> lastKeys;	///< last frame's lines sorted by hash
+		unsigned int numLines;
+		unsigned int numLastLines;
+		unsigned int numReused;
+		unsigned int numDraws;
+
+		static bool s_bEnabled;			///< is ofxBitmapString batching?
+
+		ofxBitmapStringBatch(ofxBitmapStringBatch const&);				// not defined, not copyable
+		ofxBitmapStringBatch& operator=(ofxBitmapStringBatch const&);	// not defined, not assignable
+};
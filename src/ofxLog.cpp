@@ -4,12 +4,56 @@
 
 //-------------------------------------------------------
 ofxLog::~ofxLog(){
-	if(topic.empty()){
-		ofxLogger::instance().log(level, message.str());
+	if(stream){
+		message.append(stream->str());
+		delete stream;
+	}
+	if(site){
+		ofxLogger::instance().log(*site, message.c_str(), message.size());
+	}
+	else if(topic.empty()){
+		ofxLogger::instance().log(level, message.c_str(), message.size());
 	}
 	else{
-		ofxLogger::instance().log(topic, level, message.str());
+		ofxLogger::instance().log(topic, level, message.c_str(), message.size());
+	}
+}
+
+bool ofxLog::isEnabled(){
+	if(enabled < 0){
+		if(site){
+			enabled = site->isEnabled();
+		}
+		else if(topic.empty()){
+			enabled = ofxLogger::instance().isEnabled(level);
+		}
+		else{
+			enabled = ofxLogger::instance().isEnabled(topic, level);
+		}
+	}
+	return enabled;
+}
+
+bool ofxLog::_isFormatEnabled(ofLogLevel logLevel, const string& logTopic){
+	if(logTopic.empty()){
+		return ofxLogger::instance().isEnabled(logLevel);
 	}
+	ofxLogger& logger = ofxLogger::instance();
+	return !logger.topicExists(logTopic) || logger.isEnabled(logTopic, logLevel);
+}
+
+void ofxLog::_logFormatted(ofLogLevel logLevel, const string& logTopic,
+						   const ofxLogBuffer& buffer){
+	if(logTopic.empty()){
+		ofxLogger::instance().log(logLevel, buffer.c_str(), buffer.size());
+	}
+	else{
+		ofxLogger::instance().log(logTopic, logLevel, buffer.c_str(), buffer.size());
+	}
+}
+
+void ofxLog::_logFormatted(const ofxLogSite& site, const ofxLogBuffer& buffer){
+	ofxLogger::instance().log(site, buffer.c_str(), buffer.size());
 }
 
 //--------------------------------------------------------------
@@ -34,13 +78,31 @@ void ofxLog::setupUsingDefaultSettingsForFileRotation() {
 
 
 //----------------------------------------------------------------------------------------
+void ofxLog::setSinkLevel(ofxLogSink sink, ofLogLevel logLevel)
+	{ofxLogger::instance().setSinkLevel(sink, logLevel);}
+ofLogLevel ofxLog::getSinkLevel(ofxLogSink sink)
+	{return ofxLogger::instance().getSinkLevel(sink);}
+
 void ofxLog::enableConsole()	{ofxLogger::instance().enableConsole();}
 void ofxLog::disableConsole()	{ofxLogger::instance().disableConsole();}
 bool usingConsole()				{return ofxLogger::instance().usingConsole();}
 
+void ofxLog::enableConsoleNonBlocking()		{ofxLogger::instance().enableConsoleNonBlocking();}
+void ofxLog::disableConsoleNonBlocking()	{ofxLogger::instance().disableConsoleNonBlocking();}
+bool ofxLog::usingConsoleNonBlocking()		{return ofxLogger::instance().usingConsoleNonBlocking();}
+
+void ofxLog::enableConsoleColors()	{ofxLogger::instance().enableConsoleColors();}
+void ofxLog::disableConsoleColors()	{ofxLogger::instance().disableConsoleColors();}
+bool ofxLog::usingConsoleColors()	{return ofxLogger::instance().usingConsoleColors();}
+
 void ofxLog::setConsoleColor(int color)	{ofxLogger::instance().setConsoleColor(color);}
 void ofxLog::restoreConsoleColor()		{ofxLogger::instance().restoreConsoleColor();}
 
+void ofxLog::flush()	{ofxLogger::instance().flush();}
+
+void ofxLog::shutdown()								{ofxLogger::instance().shutdown();}
+void ofxLog::setShutdownTimeout(unsigned int millis)	{ofxLogger::instance().setShutdownTimeout(millis);}
+
 void ofxLog::enableFile()	{ofxLogger::instance().enableFile();}
 void ofxLog::disableFile()	{ofxLogger::instance().disableFile();}
 bool usingFile()			{return ofxLogger::instance().usingFile();}
@@ -66,6 +128,37 @@ void ofxLog::setFileRotationMaxNum(unsigned int num)
 void ofxLog::setFileRotationNumber()	{ofxLogger::instance().setFileRotationNumber();}
 void ofxLog::setFileRotationTimestamp()	{ofxLogger::instance().setFileRotationTimestamp();}
 
+void ofxLog::enableCompressedFile()		{ofxLogger::instance().enableCompressedFile();}
+void ofxLog::disableCompressedFile()	{ofxLogger::instance().disableCompressedFile();}
+bool ofxLog::usingCompressedFile()		{return ofxLogger::instance().usingCompressedFile();}
+
+void ofxLog::setCompressedFilePath(const string& file)	{ofxLogger::instance().setCompressedFilePath(file);}
+string ofxLog::getCompressedFilePath()					{return ofxLogger::instance().getCompressedFilePath();}
+void ofxLog::setCompressedFileBlockSize(unsigned int sizeKB)
+	{ofxLogger::instance().setCompressedFileBlockSize(sizeKB);}
+
+void ofxLog::enableTrace()					{ofxLogger::instance().enableTrace();}
+void ofxLog::disableTrace()					{ofxLogger::instance().disableTrace();}
+bool ofxLog::usingTrace()					{return ofxLogger::instance().usingTrace();}
+void ofxLog::setTracePath(const string& file)	{ofxLogger::instance().setTracePath(file);}
+string ofxLog::getTracePath()					{return ofxLogger::instance().getTracePath();}
+
+void ofxLog::enableSocket(const string& path)
+	{ofxLogger::instance().enableSocket(path);}
+void ofxLog::disableSocket()
+	{ofxLogger::instance().disableSocket();}
+bool ofxLog::usingSocket()
+	{return ofxLogger::instance().usingSocket();}
+void ofxLog::setSocketName(const string& name)
+	{ofxLogger::instance().setSocketName(name);}
+
+void ofxLog::enableSharedMemory(const string& name, unsigned int sizeKB)
+	{ofxLogger::instance().enableSharedMemory(name, sizeKB);}
+void ofxLog::disableSharedMemory()
+	{ofxLogger::instance().disableSharedMemory();}
+bool ofxLog::usingSharedMemory()
+	{return ofxLogger::instance().usingSharedMemory();}
+
 void ofxLog::addTopic(const string& logTopic, ofLogLevel logLevel)
 	{ofxLogger::instance().addTopic(logTopic, logLevel);}
 void ofxLog::removeTopic(const string& logTopic)	{ofxLogger::instance().removeTopic(logTopic);}
@@ -75,6 +168,13 @@ void ofxLog::setTopicLogLevel(const string& logTopic, ofLogLevel logLevel)
 	{ofxLogger::instance().setTopicLogLevel(logTopic, logLevel);}
 void ofxLog::resetTopicLogLevel(const string& logTopic)
 	{ofxLogger::instance().resetTopicLogLevel(logTopic);}
+void ofxLog::addTopicRoute(const string& logTopic, const string& file)
+	{ofxLogger::instance().addTopicRoute(logTopic, file);}
+void ofxLog::removeTopicRoute(const string& logTopic)
+	{ofxLogger::instance().removeTopicRoute(logTopic);}
+
+void ofxLog::setPattern(const string& pattern)	{ofxLogger::instance().setPattern(pattern);}
+string ofxLog::getPattern()						{return ofxLogger::instance().getPattern();}
 
 void ofxLog::enableHeader()		{ofxLogger::instance().enableHeader();}
 void ofxLog::disableHeader()	{ofxLogger::instance().disableHeader();}
@@ -95,3 +195,40 @@ bool usingHeaderFrameNum()				{return ofxLogger::instance().usingHeaderFrameNum(
 void ofxLog::enableHeaderMillis()	{ofxLogger::instance().enableHeaderMillis();}
 void ofxLog::disableHeaderMillis()	{ofxLogger::instance().disableHeaderMillis();}
 bool usingHeaderMillis()			{return ofxLogger::instance().usingHeaderMillis();}
+
+void ofxLog::enableFlightRecorder(unsigned int numRecords)
+	{ofxLogger::instance().enableFlightRecorder(numRecords);}
+void ofxLog::disableFlightRecorder()	{ofxLogger::instance().disableFlightRecorder();}
+bool ofxLog::usingFlightRecorder()		{return ofxLogger::instance().usingFlightRecorder();}
+void ofxLog::dumpFlightRecorder()		{ofxLogger::instance().dumpFlightRecorder();}
+
+void ofxLog::enableFormatWorkers(unsigned int numWorkers, unsigned int numQueued)
+	{ofxLogger::instance().enableFormatWorkers(numWorkers, numQueued);}
+void ofxLog::disableFormatWorkers()	{ofxLogger::instance().disableFormatWorkers();}
+bool ofxLog::usingFormatWorkers()	{return ofxLogger::instance().usingFormatWorkers();}
+
+void ofxLog::enableFrameFlush(unsigned int numFrames, unsigned int watermarkKB)
+	{ofxLogger::instance().enableFrameFlush(numFrames, watermarkKB);}
+void ofxLog::disableFrameFlush()	{ofxLogger::instance().disableFrameFlush();}
+bool ofxLog::usingFrameFlush()		{return ofxLogger::instance().usingFrameFlush();}
+
+void ofxLog::enableCrashDump(const string& path)	{ofxLogger::instance().enableCrashDump(path);}
+void ofxLog::disableCrashDump()						{ofxLogger::instance().disableCrashDump();}
+bool ofxLog::usingCrashDump()						{return ofxLogger::instance().usingCrashDump();}
+
+void ofxLog::enableScopeReports(unsigned int seconds)	{ofxLogger::instance().enableScopeReports(seconds);}
+void ofxLog::disableScopeReports()					{ofxLogger::instance().disableScopeReports();}
+bool ofxLog::usingScopeReports()					{return ofxLogger::instance().usingScopeReports();}
+
+bool ofxLog::loadConfigFile(const string& path)	{return ofxLogger::instance().loadConfigFile(path);}
+void ofxLog::watchConfigFile(const string& path)	{ofxLogger::instance().watchConfigFile(path);}
+void ofxLog::unwatchConfigFile()					{ofxLogger::instance().unwatchConfigFile();}
+bool ofxLog::watchingConfigFile()					{return ofxLogger::instance().watchingConfigFile();}
+
+ofxLogPool::Stats ofxLog::getPoolStats()	{return ofxLogger::instance().getPoolStats();}
+
+void ofxLog::setSiteMode(const string& file, int line, ofxLogSite::Mode mode)
+	{ofxLogger::instance().setSiteMode(file, line, mode);}
+void ofxLog::setSiteMode(ofxLogSite& site, ofxLogSite::Mode mode)
+	{ofxLogger::instance().setSiteMode(site, mode);}
+vector<ofxLogSite*> ofxLog::getSites()	{return ofxLogger::instance().getSites();}
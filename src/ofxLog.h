@@ -2,6 +2,15 @@
 
 #include "ofMain.h"
 
+#include "ofxLogFormat.h"
+#include "ofxLogBuffer.h"
+#include "ofxLogPool.h"
+#include "ofxLogSite.h"
+#include "ofxLogConfig.h"
+
+#include <iomanip>
+#include <type_traits>
+
 //------------------------------------------------------------------------------
 /// \class ofxLog
 /// \brief a public streaming log interface
@@ -9,7 +18,11 @@
 /// ofxLog accepts variables via the ostream operator << and builds a string
 /// and logs it when the stream is finished (via the destructor). A newline is
 /// printed automatically and all the stream controls (endl, flush, hex, etc)
-/// work normally. The log level is explicitly OF_LOG_NOTICE, see the derived 
+/// work normally.
+///
+/// The line is built in an ofxLogBuffer on the stack, so logging strings &
+/// numbers doesn't touch the heap. A formatting control (hex, setw, etc)
+/// switches the rest of the line over to a std::ostringstream. The log level is explicitly OF_LOG_NOTICE, see the derived 
 /// wrapper classes:
 ///
 /// Usage: ofxLog() << "a string" << 100 << 20.234f;
@@ -29,12 +42,28 @@ class ofxLog
 		ofxLog()
 		{
 			level = OF_LOG_NOTICE;
+			site = NULL;
+			enabled = -1;
+			stream = NULL;
 		}
 		
 		ofxLog(string logTopic)
 		{
 			level = OF_LOG_NOTICE;
 			topic = logTopic;
+			site = NULL;
+			enabled = -1;
+			stream = NULL;
+		}
+		
+		/// log at the level & topic of a static site, see the OFX_LOG_*
+		/// macros in ofxLogSite.h
+		ofxLog(const ofxLogSite& logSite)
+		{
+			level = logSite.level;
+			site = &logSite;
+			enabled = -1;
+			stream = NULL;
 		}
 // an interface to set the log level when using:
 //
@@ -55,17 +84,107 @@ class ofxLog
         template <class T> 
 		ofxLog& operator<<(const T& value)
 		{
-            message << value;
+			if(stream || _isManipulator<T>::value)
+			{
+				_stream() << value;
+			}
+			else
+			{
+				message << value;
+			}
             return *this;
         }
 
         /// catch the << ostream function pointers such as std::endl and std::hex
         ofxLog& operator<<(std::ostream& (*func)(std::ostream&))
 		{
-			func(message);
+			if(!stream && func == static_cast<std::ostream& (*)(std::ostream&)>(std::endl))
+			{
+				message.append('\n');
+			}
+			else if(stream || func != static_cast<std::ostream& (*)(std::ostream&)>(std::flush))
+			{
+				func(_stream());
+			}
+            return *this;
+        }
+		
+		ofxLog& operator<<(std::ios_base& (*func)(std::ios_base&))
+		{
+			func(_stream());
             return *this;
         }
 
+		/// Call a function (or lambda) and log what it returns, but only if
+		/// the log level and topic are enabled. Use this for messages which
+		/// are expensive to build:
+		///
+		/// ofxLogVerbose("mesh").lazy([&]{ return describe(mesh); });
+		///
+		/// The function is called right away on the calling thread, so it's
+		/// safe to capture locals by reference.
+		template <class Function>
+		ofxLog& lazy(Function func)
+		{
+			if(isEnabled())
+			{
+				*this << func();
+			}
+			return *this;
+		}
+		
+		/// would this log line be printed (or kept by the flight recorder)
+		/// at the current log level? checks the topic level if using a topic
+		bool isEnabled();
+
+		/// \section Format
+		///
+		/// Log a line built from a format string where each "{}" is replaced by
+		/// the next argument, use an empty topic to log without a topic:
+		///
+		///		ofxLog::format(OF_LOG_NOTICE, "render", "{}: {} ms", name, ms);
+		///
+		/// Nothing is formatted if the level is not enabled. Use the
+		/// OFX_LOG_FORMAT macro to check the arguments at compile time and
+		/// only parse the format string once.
+		template <class... Args>
+		static void format(ofLogLevel logLevel, const std::string& logTopic,
+						   const char* format, const Args&... args)
+		{
+			// checked before the format string is parsed
+			if(!_isFormatEnabled(logLevel, logTopic))
+			{
+				return;
+			}
+			ofxLogBuffer buffer;
+			ofxLogFormatTo(buffer, ofxLogFormatSpec(format), args...);
+			_logFormatted(logLevel, logTopic, buffer);
+		}
+		
+		template <class... Args>
+		static void format(ofLogLevel logLevel, const std::string& logTopic,
+						   const ofxLogFormatSpec& spec, const Args&... args)
+		{
+			if(!_isFormatEnabled(logLevel, logTopic))
+			{
+				return;
+			}
+			ofxLogBuffer buffer;
+			ofxLogFormatTo(buffer, spec, args...);
+			_logFormatted(logLevel, logTopic, buffer);
+		}
+		
+		/// format at the level & topic of a static site, used by
+		/// OFX_LOG_SITE_FORMAT which has already checked the site
+		template <class... Args>
+		static void format(const ofxLogSite& site, const ofxLogFormatSpec& spec,
+						   const Args&... args)
+		{
+			ofxLogBuffer buffer;
+			ofxLogFormatTo(buffer, spec, args...);
+			_logFormatted(site, buffer);
+		}
+		
 		/// \section Global Log Function Wrappers
 		///
 		/// Ok Ok, I know this looks scary ... but it's just a long list
@@ -73,13 +192,29 @@ class ofxLog
 		static void setLevel(ofLogLevel logLevel);
 		static ofLogLevel getLevel();
 		
+		static void setSinkLevel(ofxLogSink sink, ofLogLevel logLevel);
+		static ofLogLevel getSinkLevel(ofxLogSink sink);
+		
 		static void enableConsole();
 		static void disableConsole();
 		static bool usingConsole();
 		
+		static void enableConsoleNonBlocking();
+		static void disableConsoleNonBlocking();
+		static bool usingConsoleNonBlocking();
+		
+		static void enableConsoleColors();
+		static void disableConsoleColors();
+		static bool usingConsoleColors();
+		
 		static void setConsoleColor(int color);
 		static void restoreConsoleColor();
 		
+		static void flush();
+		
+		static void shutdown();
+		static void setShutdownTimeout(unsigned int millis);
+		
 		static void enableFile();
 		static void disableFile();
 		static bool usingFile();
@@ -99,6 +234,29 @@ class ofxLog
 		
 		static void setFileRotationNumber();
 		static void setFileRotationTimestamp();
+		
+		static void enableCompressedFile();
+		static void disableCompressedFile();
+		static bool usingCompressedFile();
+		
+		static void setCompressedFilePath(const string& file);
+		static string getCompressedFilePath();
+		static void setCompressedFileBlockSize(unsigned int sizeKB);
+		
+		static void enableTrace();
+		static void disableTrace();
+		static bool usingTrace();
+		static void setTracePath(const string& file);
+		static string getTracePath();
+		
+		static void enableSocket(const string& path="/tmp/ofxLogger.sock");
+		static void disableSocket();
+		static bool usingSocket();
+		static void setSocketName(const string& name);
+		
+		static void enableSharedMemory(const string& name="/ofxLogger", unsigned int sizeKB=2048);
+		static void disableSharedMemory();
+		static bool usingSharedMemory();
 	
 		static void addTopic(const string& logTopic, ofLogLevel logLevel=OF_LOG_NOTICE);
 		static void removeTopic(const string& logTopic);
@@ -106,6 +264,12 @@ class ofxLog
 		static void setTopicLogLevel(const string& logTopic, ofLogLevel logLevel);
 		static void resetTopicLogLevel(const string& logTopic);
 		
+		static void addTopicRoute(const string& logTopic, const string& file);
+		static void removeTopicRoute(const string& logTopic);
+		
+		static void setPattern(const string& pattern);
+		static string getPattern();
+		
 		static void enableHeader();
 		static void disableHeader();
 		static bool usingHeader();
@@ -126,14 +290,82 @@ class ofxLog
 		static void disableHeaderMillis();
 		static bool usingHeaderMillis();
 		
+		static void enableFlightRecorder(unsigned int numRecords=256);
+		static void disableFlightRecorder();
+		static bool usingFlightRecorder();
+		static void dumpFlightRecorder();
+		
+		static void enableFormatWorkers(unsigned int numWorkers=0, unsigned int numQueued=4096);
+		static void disableFormatWorkers();
+		static bool usingFormatWorkers();
+		
+		static void enableFrameFlush(unsigned int numFrames=1, unsigned int watermarkKB=64);
+		static void disableFrameFlush();
+		static bool usingFrameFlush();
+		
+		static void enableCrashDump(const std::string& path="");
+		static void disableCrashDump();
+		static bool usingCrashDump();
+		
+		static void enableScopeReports(unsigned int seconds=10);
+		static void disableScopeReports();
+		static bool usingScopeReports();
+		
+		static bool loadConfigFile(const string& path);
+		static void watchConfigFile(const string& path);
+		static void unwatchConfigFile();
+		static bool watchingConfigFile();
+		
+		static ofxLogPool::Stats getPoolStats();
+		
+		static void setSiteMode(const string& file, int line, ofxLogSite::Mode mode);
+		static void setSiteMode(ofxLogSite& site, ofxLogSite::Mode mode);
+		static vector<ofxLogSite*> getSites();
+		
 	protected:
 	
 		ofLogLevel level;			///< log level
 		std::string topic;			///< log topic
+		const ofxLogSite* site;		///< the static site, NULL if none
 					
 	private:
 	
-        std::ostringstream message;	///< temp buffer
+		/// is the level enabled for format()? true for unknown topics so the
+		/// missing topic warning is printed
+		static bool _isFormatEnabled(ofLogLevel logLevel, const std::string& logTopic);
+		
+		/// logs a line built by format()
+		static void _logFormatted(ofLogLevel logLevel, const std::string& logTopic,
+								  const ofxLogBuffer& buffer);
+		static void _logFormatted(const ofxLogSite& site, const ofxLogBuffer& buffer);
+	
+		/// the setw, setprecision, etc types, they change the stream's state
+		template <class T>
+		struct _isManipulator
+		{
+			static const bool value =
+				std::is_same<T, decltype(std::setw(0))>::value ||
+				std::is_same<T, decltype(std::setprecision(0))>::value ||
+				std::is_same<T, decltype(std::setfill('0'))>::value ||
+				std::is_same<T, decltype(std::setbase(0))>::value ||
+				std::is_same<T, decltype(std::setiosflags(std::ios_base::fmtflags()))>::value ||
+				std::is_same<T, decltype(std::resetiosflags(std::ios_base::fmtflags()))>::value;
+		};
+		
+		/// the stream used once a manipulator is used, created when needed
+		std::ostringstream& _stream()
+		{
+			if(!stream)
+			{
+				stream = new std::ostringstream;
+			}
+			return *stream;
+		}
+		
+		int enabled;				///< cached isEnabled(), -1 if not checked yet
+	
+        ofxLogBuffer message;		///< temp buffer
+		std::ostringstream* stream;	///< the rest of the line after a manipulator, NULL if none
 		
 		ofxLog(ofxLog const&) {}        				// not defined, not copyable
         ofxLog& operator=(ofxLog& from) {return *this;}	// not defined, not assignable
@@ -0,0 +1,273 @@
+#pragma once
+
+#include "ofxLogPool.h"
+
+#include <string>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogBuffer
+/// \brief a string builder with inline storage
+///
+/// ofxLogBuffer appends text & numbers into a fixed size buffer that lives
+/// inside the object (on the stack for a local), so building a typical line
+/// doesn't touch the heap. Longer lines move to a buffer from the log pool
+/// (see ofxLogPool) instead of being truncated.
+///
+/// Numbers are formatted the same way a default std::ostream does (integers in
+/// decimal, floats with %g), without going through a stream. Floats that %g
+/// prints without an exponent (ie. frame rates & millis) skip snprintf too.
+/// Types the buffer doesn't know are printed through a temporary
+/// std::ostringstream.
+///
+class ofxLogBuffer
+{
+	public:
+
+		ofxLogBuffer()
+		{
+			data = inlineData;
+			length = 0;
+			capacity = s_inlineSize;
+			data[0] = '\0';
+		}
+
+		~ofxLogBuffer()
+		{
+			if(data != inlineData)
+			{
+				ofxLogPool::free(data);
+			}
+		}
+
+		/// \section Access
+
+		/// the text, always null terminated
+		const char* c_str() const	{return data;}
+		std::size_t size() const	{return length;}
+		bool empty() const			{return length == 0;}
+
+		/// copy the text into a string
+		std::string str() const		{return std::string(data, length);}
+
+		/// empty the buffer, keeps the current storage
+		void clear()
+		{
+			length = 0;
+			data[0] = '\0';
+		}
+
+		/// \section Append
+
+		void append(const char* s, std::size_t n)
+		{
+			reserve(length+n);
+			memcpy(data+length, s, n);
+			length += n;
+			data[length] = '\0';
+		}
+
+		void append(char c)
+		{
+			reserve(length+1);
+			data[length++] = c;
+			data[length] = '\0';
+		}
+
+		void append(const char* s)			{append(s, strlen(s));}
+		void append(char* s)				{append(s, strlen(s));}
+		void append(const std::string& s)	{append(s.data(), s.size());}
+
+		void append(bool b)	{append(b ? '1' : '0');}	// like ostream without boolalpha
+
+		void append(unsigned long long value)
+		{
+			char digits[24];
+			char* end = digits+sizeof(digits);
+			char* p = end;
+			do
+			{
+				*--p = '0'+(char)(value % 10);
+				value /= 10;
+			}
+			while(value > 0);
+			append(p, end-p);
+		}
+
+		void append(long long value)
+		{
+			if(value < 0)
+			{
+				append('-');
+				// negate as unsigned so the most negative value doesn't overflow
+				append((unsigned long long) 0-(unsigned long long) value);
+			}
+			else
+			{
+				append((unsigned long long) value);
+			}
+		}
+
+		void append(int value)				{append((long long) value);}
+		void append(long value)				{append((long long) value);}
+		void append(short value)			{append((long long) value);}
+		void append(unsigned int value)		{append((unsigned long long) value);}
+		void append(unsigned long value)	{append((unsigned long long) value);}
+		void append(unsigned short value)	{append((unsigned long long) value);}
+		void append(signed char c)			{append((char) c);}
+		void append(unsigned char c)		{append((char) c);}
+
+		void append(double value)
+		{
+			if(_appendFixed(value))
+			{
+				return;
+			}
+			char digits[32];
+			int n = snprintf(digits, sizeof(digits), "%g", value);
+			append(digits, n);
+		}
+
+		void append(float value)	{append((double) value);}
+
+		void append(long double value)
+		{
+			char digits[48];
+			int n = snprintf(digits, sizeof(digits), "%Lg", value);
+			append(digits, n);
+		}
+
+		void append(const void* p)
+		{
+			char digits[24];
+			int n = snprintf(digits, sizeof(digits), "%p", p);
+			append(digits, n);
+		}
+
+		/// anything else goes through an ostream
+		template <class T>
+		void append(const T& value)
+		{
+			std::ostringstream stream;
+			stream << value;
+			append(stream.str());
+		}
+
+		/// stream style appending
+		template <class T>
+		ofxLogBuffer& operator<<(const T& value)
+		{
+			append(value);
+			return *this;
+		}
+
+		/// make sure there is room for size chars (plus the terminator)
+		void reserve(std::size_t size)
+		{
+			if(size < capacity)
+			{
+				return;
+			}
+			std::size_t newCapacity = capacity*2;
+			while(newCapacity <= size)
+			{
+				newCapacity *= 2;
+			}
+			char* newData = (char*) ofxLogPool::allocate(newCapacity);
+			memcpy(newData, data, length+1);
+			if(data != inlineData)
+			{
+				ofxLogPool::free(data);
+			}
+			data = newData;
+			capacity = newCapacity;
+		}
+
+		static const std::size_t s_inlineSize = 256;	///< inline storage size
+
+	private:
+
+		/// Append a value the way %g prints it, for 1e-4 <= |value| < 1e6
+		/// where %g uses no exponent: 6 significant digits without the
+		/// trailing zeros. Returns false for any other value or for a value
+		/// too close to a rounding tie to be sure of the last digit, those
+		/// go through snprintf.
+		bool _appendFixed(double value)
+		{
+			static const double s_powers[10] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+
+			double magnitude = value < 0 ? -value : value;
+			if(!(magnitude >= 1e-4 && magnitude < 1e6))
+			{
+				return false;	// 0, NaN & inf too
+			}
+
+			// scale to 6 digits before the point
+			int decimals = 0;
+			double scaled = magnitude;
+			while(scaled < 100000)
+			{
+				if(++decimals > 9)
+				{
+					return false;
+				}
+				scaled = magnitude*s_powers[decimals];
+			}
+			double whole = floor(scaled);
+			double fraction = scaled-whole;
+			if(fabs(fraction-0.5) < 1e-6)
+			{
+				return false;
+			}
+			unsigned long long significand = (unsigned long long) whole+(fraction > 0.5 ? 1 : 0);
+			if(significand >= 1000000)
+			{
+				return false;	// rounded up to 1e+06
+			}
+
+			char digits[6];
+			for(int i = 5; i >= 0; --i)
+			{
+				digits[i] = '0'+(char)(significand % 10);
+				significand /= 10;
+			}
+			int last = 5;		// the first digit isn't 0, drop the trailing ones
+			while(digits[last] == '0')
+			{
+				--last;
+			}
+
+			if(value < 0)
+			{
+				append('-');
+			}
+			int numWhole = 6-decimals;
+			if(numWhole > 0)
+			{
+				append(digits, numWhole);
+				if(last >= numWhole)
+				{
+					append('.');
+					append(digits+numWhole, last+1-numWhole);
+				}
+			}
+			else
+			{
+				append("0.", 2);
+				append("0000", -numWhole);
+				append(digits, last+1);
+			}
+			return true;
+		}
+
+		char* data;						///< inlineData or a pool buffer
+		std::size_t length;				///< num chars, without the terminator
+		std::size_t capacity;			///< size of data
+		char inlineData[s_inlineSize];	///< storage for short lines
+
+		ofxLogBuffer(ofxLogBuffer const&);				// not defined, not copyable
+		ofxLogBuffer& operator=(ofxLogBuffer const&);	// not defined, not assignable
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "ofxLogRecord.h"
+
+#include <Poco/Channel.h>
+#include <Poco/Message.h>
+#include <Poco/AutoPtr.h>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogChannel
+/// \brief a Poco::Channel that takes shared log records
+///
+/// ofxLogger hands each ofxLogChannel the shared ofxLogRecord instead of a
+/// Poco::Message, so the message isn't copied for each channel. Lines logged
+/// through the Poco API still work, they are wrapped in a record first.
+///
+/// Subclasses implement log(const ofxLogRecord&) and should add
+/// "using ofxLogChannel::log;" so the Poco::Message version isn't hidden.
+///
+class ofxLogChannel : public Poco::Channel
+{
+	public:
+
+		/// log a record, the record may be shared with other channels &
+		/// listeners so it must not be changed
+		virtual void log(const ofxLogRecord& record) = 0;
+
+		/// wraps the message in a record
+		void log(const Poco::Message& msg)
+		{
+			Poco::AutoPtr<ofxLogRecord> record(ofxLogRecord::create(msg));
+			log(*record);
+		}
+};
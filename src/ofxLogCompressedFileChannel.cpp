@@ -0,0 +1,565 @@
+#include "ofxLogCompressedFileChannel.h"
+
+#include "ofxLogCrashHandler.h"
+
+#include <Poco/File.h>
+#include <Poco/Exception.h>
+
+#include <zlib.h>
+#include <fstream>
+
+static const unsigned int s_trailerSize = 8;		// crc32, text size
+static const unsigned int s_checkMillis = 250;		// how often the compressor checks the block age
+static const unsigned int s_maxSpareBlocks = 2;
+
+//--------------------------------------------------------------
+static void writeUInt32(char* data, uint32_t value)
+{
+	data[0] = (char) (value & 0xff);
+	data[1] = (char) ((value >> 8) & 0xff);
+	data[2] = (char) ((value >> 16) & 0xff);
+	data[3] = (char) ((value >> 24) & 0xff);
+}
+
+static uint32_t readUInt32(const char* data)
+{
+	const unsigned char* p = (const unsigned char*) data;
+	return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+// reads a block header, returns false if it isn't one of ours
+static bool readHeader(const char* header, uint32_t& size, uint32_t& textSize)
+{
+	const unsigned char* p = (const unsigned char*) header;
+	if(p[0] != 0x1f || p[1] != 0x8b || p[2] != 8 || p[3] != 4 ||	// gzip, deflate, FEXTRA
+	   p[10] != 12 || p[11] != 0 ||									// extra length
+	   p[12] != 'O' || p[13] != 'L' || p[14] != 8 || p[15] != 0)	// our field
+	{
+		return false;
+	}
+	size = readUInt32(header+16);
+	textSize = readUInt32(header+20);
+	return size >= ofxLogCompressedFileChannel::s_headerSize+s_trailerSize;
+}
+
+static bool readHeaderAt(std::ifstream& file, uint64_t offset, uint32_t& size, uint32_t& textSize)
+{
+	char header[ofxLogCompressedFileChannel::s_headerSize];
+	file.clear();
+	file.seekg((std::streamoff) offset);
+	return file.read(header, sizeof(header)) && readHeader(header, size, textSize);
+}
+
+// finds the next block header after offset, returns false if there's none
+static bool findHeader(std::ifstream& file, uint64_t fileSize, uint64_t& offset)
+{
+	const uint64_t headerSize = ofxLogCompressedFileChannel::s_headerSize;
+	char buffer[64*1024];
+	uint64_t start = offset+1;
+	while(start+headerSize <= fileSize)
+	{
+		std::size_t size = (std::size_t) std::min((uint64_t) sizeof(buffer), fileSize-start);
+		file.clear();
+		file.seekg((std::streamoff) start);
+		if(!file.read(buffer, size))
+		{
+			return false;
+		}
+		uint32_t blockSize, textSize;
+		for(std::size_t i = 0; i+headerSize <= size; ++i)
+		{
+			if(buffer[i] == (char) 0x1f && readHeader(buffer+i, blockSize, textSize))
+			{
+				offset = start+i;
+				return true;
+			}
+		}
+		// a header can straddle the end of the buffer
+		start += size-headerSize+1;
+	}
+	return false;
+}
+
+//--------------------------------------------------------------
+ofxLogCompressedFileChannel::ofxLogCompressedFileChannel() : compressor(*this)
+{
+	_init();
+}
+
+ofxLogCompressedFileChannel::ofxLogCompressedFileChannel(const std::string& path) : compressor(*this)
+{
+	_init();
+	this->path = path;
+}
+
+ofxLogCompressedFileChannel::~ofxLogCompressedFileChannel()
+{
+	close();
+}
+
+void ofxLogCompressedFileChannel::_init()
+{
+	path = ofToDataPath("openframeworks.log.gz");
+	blockSize = 1024*1024;
+	level = 6;
+	flushMillis = 5000;
+	maxPendingBlocks = 8;
+
+	numDropped = 0;
+	numPendingDrops = 0;
+	numFailedBlocks = 0;
+	numPendingFails = 0;
+	numTextBytes = 0;
+	numFileBytes = 0;
+
+	file = NULL;
+	bRunning = false;
+}
+
+//--------------------------------------------------------------
+void ofxLogCompressedFileChannel::open()
+{
+	Poco::FastMutex::ScopedLock writeLock(writeMutex);
+	Poco::FastMutex::ScopedLock lock(mutex);
+	if(bRunning)
+	{
+		return;
+	}
+
+	// appending keeps the blocks of earlier runs, a block torn by a crash
+	// would hide the ones appended after it from zcat
+	_repair();
+	file = fopen(path.c_str(), "ab");
+	if(!file)
+	{
+		return;
+	}
+	block.reserve(blockSize);
+	bRunning = true;
+	thread.start(compressor);
+}
+
+void ofxLogCompressedFileChannel::close()
+{
+	{
+		Poco::FastMutex::ScopedLock lock(mutex);
+		if(!bRunning)
+		{
+			return;
+		}
+		bRunning = false;
+	}
+	wakeEvent.set();
+	thread.join();
+
+	Poco::FastMutex::ScopedLock writeLock(writeMutex);
+	{
+		Poco::FastMutex::ScopedLock lock(mutex);
+		_finishBlock();
+	}
+	_writePending();
+	fclose(file);
+	file = NULL;
+}
+
+bool ofxLogCompressedFileChannel::isOpen()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return bRunning;
+}
+
+//--------------------------------------------------------------
+void ofxLogCompressedFileChannel::log(const ofxLogRecord& record)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	if(!bRunning)
+	{
+		return;
+	}
+
+	ofxLogText text = record.getLine();
+	if(block.size()+text.size() >= blockSize && pending.size() >= maxPendingBlocks)
+	{
+		numDropped++;
+		numPendingDrops++;
+		return;
+	}
+
+	if(block.empty())
+	{
+		blockStart.update();
+		if(numPendingDrops > 0)
+		{
+			block += "ofxLogCompressedFileChannel: "+ofToString(numPendingDrops)+" lines dropped\n";
+			numPendingDrops = 0;
+		}
+		if(numPendingFails > 0)
+		{
+			block += "ofxLogCompressedFileChannel: "+ofToString(numPendingFails)+" blocks couldn't be written\n";
+			numPendingFails = 0;
+		}
+	}
+	block.append(text.data(), text.size());
+	block += '\n';
+	numTextBytes += text.size()+1;
+
+	if(block.size() >= blockSize)
+	{
+		_finishBlock();
+		wakeEvent.set();
+	}
+}
+
+void ofxLogCompressedFileChannel::flush()
+{
+	Poco::FastMutex::ScopedLock writeLock(writeMutex);
+	{
+		Poco::FastMutex::ScopedLock lock(mutex);
+		if(!bRunning)
+		{
+			return;
+		}
+		_finishBlock();
+	}
+	_writePending();
+}
+
+//--------------------------------------------------------------
+void ofxLogCompressedFileChannel::setPath(const std::string& path)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	this->path = path;
+}
+
+std::string ofxLogCompressedFileChannel::getPath()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return path;
+}
+
+void ofxLogCompressedFileChannel::setBlockSize(unsigned int sizeKB)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	blockSize = std::max(sizeKB, 1u)*1024;
+}
+
+void ofxLogCompressedFileChannel::setLevel(int level)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	this->level = std::max(1, std::min(level, 9));
+}
+
+void ofxLogCompressedFileChannel::setFlushMillis(unsigned int millis)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	flushMillis = millis;
+}
+
+void ofxLogCompressedFileChannel::setMaxPendingBlocks(unsigned int num)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	maxPendingBlocks = std::max(num, 1u);
+}
+
+unsigned long ofxLogCompressedFileChannel::getNumDropped()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return numDropped;
+}
+
+unsigned long ofxLogCompressedFileChannel::getNumFailedBlocks()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return numFailedBlocks;
+}
+
+void ofxLogCompressedFileChannel::crashDump(int fd)
+{
+	// oldest first: the block being compressed, the full ones & the one
+	// being filled
+	ofxLogCrashHandler::write(fd, writing.data(), writing.size());
+	for(std::deque<std::string>::const_iterator iter = pending.begin(); iter != pending.end(); ++iter)
+	{
+		ofxLogCrashHandler::write(fd, iter->data(), iter->size());
+	}
+	ofxLogCrashHandler::write(fd, block.data(), block.size());
+}
+
+uint64_t ofxLogCompressedFileChannel::getNumTextBytes()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return numTextBytes;
+}
+
+uint64_t ofxLogCompressedFileChannel::getNumFileBytes()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return numFileBytes;
+}
+
+//--------------------------------------------------------------
+bool ofxLogCompressedFileChannel::readBlocks(const std::string& path, std::vector<Block>& blocks)
+{
+	std::ifstream file(path.c_str(), std::ios::binary);
+	if(!file.is_open())
+	{
+		return false;
+	}
+	file.seekg(0, std::ios::end);
+	uint64_t fileSize = (uint64_t) file.tellg();
+
+	Block block;
+	if(fileSize > 0 && !readHeaderAt(file, 0, block.size, block.textSize))
+	{
+		return false; // not ours, or too short to tell
+	}
+
+	uint64_t offset = 0;
+	while(offset+s_headerSize <= fileSize)
+	{
+		if(!readHeaderAt(file, offset, block.size, block.textSize))
+		{
+			// garbage after the blocks, skip to the next block if any
+			if(!findHeader(file, fileSize, offset))
+			{
+				break;
+			}
+			continue;
+		}
+
+		// a block that doesn't end at a header or the end of the file was
+		// torn by a crash, the blocks appended by a later run start inside it
+		uint64_t end = offset+block.size;
+		uint32_t nextSize, nextTextSize;
+		if(end > fileSize || (end+s_headerSize <= fileSize &&
+		   !readHeaderAt(file, end, nextSize, nextTextSize)))
+		{
+			uint64_t next = offset;
+			if(findHeader(file, fileSize, next) && next < end)
+			{
+				offset = next;
+				continue;
+			}
+			if(end > fileSize)
+			{
+				break; // torn at the end
+			}
+		}
+		block.offset = offset;
+		blocks.push_back(block);
+		offset = end;
+	}
+	return true;
+}
+
+bool ofxLogCompressedFileChannel::readBlock(const std::string& path, const Block& block, std::string& text)
+{
+	std::ifstream file(path.c_str(), std::ios::binary);
+	if(!file.is_open())
+	{
+		return false;
+	}
+	std::string data(block.size, '\0');
+	file.seekg((std::streamoff) block.offset);
+	if(!file.read(&data[0], block.size))
+	{
+		return false;
+	}
+	return inflateBlock(data.data(), data.size(), text);
+}
+
+bool ofxLogCompressedFileChannel::inflateBlock(const char* data, std::size_t size, std::string& text)
+{
+	uint32_t blockSize, textSize;
+	if(size < s_headerSize || !readHeader(data, blockSize, textSize) || blockSize > size)
+	{
+		return false;
+	}
+
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	if(inflateInit2(&stream, -MAX_WBITS) != Z_OK) // raw deflate, the gzip framing is ours
+	{
+		return false;
+	}
+
+	std::size_t start = text.size();
+	text.resize(start+textSize);
+	stream.next_in = (Bytef*) data+s_headerSize;
+	stream.avail_in = blockSize-s_headerSize-s_trailerSize;
+	stream.next_out = (Bytef*) &text[start];
+	stream.avail_out = textSize;
+	int result = inflate(&stream, Z_FINISH);
+	inflateEnd(&stream);
+
+	const char* trailer = data+blockSize-s_trailerSize;
+	if(result != Z_STREAM_END || stream.total_out != textSize ||
+	   readUInt32(trailer+4) != textSize ||
+	   readUInt32(trailer) != crc32(0, (const Bytef*) text.data()+start, textSize))
+	{
+		text.resize(start);
+		return false;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxLogCompressedFileChannel::Compressor::run()
+{
+	while(true)
+	{
+		channel.wakeEvent.tryWait(s_checkMillis);
+		{
+			Poco::FastMutex::ScopedLock lock(channel.mutex);
+			if(!channel.bRunning)
+			{
+				break;
+			}
+
+			// write a block that isn't full after a while so it's on disk
+			// if the app crashes
+			if(!channel.block.empty() && channel.flushMillis > 0 &&
+			   channel.blockStart.elapsed() >= (Poco::Timestamp::TimeDiff) channel.flushMillis*1000)
+			{
+				channel._finishBlock();
+			}
+		}
+
+		Poco::FastMutex::ScopedLock writeLock(channel.writeMutex);
+		channel._writePending();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLogCompressedFileChannel::_repair()
+{
+	// only files with our blocks, something else at the path is left alone
+	std::vector<Block> blocks;
+	if(!readBlocks(path, blocks))
+	{
+		return;
+	}
+	uint64_t end = blocks.empty() ? 0 : blocks.back().offset+blocks.back().size;
+	try
+	{
+		Poco::File file(path);
+		if(file.exists() && file.getSize() > end)
+		{
+			file.setSize(end);
+		}
+	}
+	catch(const Poco::Exception&)
+	{
+		// opened read only or the like, the readers skip the torn block
+	}
+}
+
+void ofxLogCompressedFileChannel::_finishBlock()
+{
+	if(block.empty())
+	{
+		return;
+	}
+	pending.push_back(std::string());
+	pending.back().swap(block);
+
+	// the next block reuses the memory of one that's been written
+	if(!spare.empty())
+	{
+		block.swap(spare.back());
+		spare.pop_back();
+	}
+	else
+	{
+		block.reserve(blockSize);
+	}
+}
+
+void ofxLogCompressedFileChannel::_writePending()
+{
+	while(true)
+	{
+		{
+			Poco::FastMutex::ScopedLock lock(mutex);
+			if(pending.empty())
+			{
+				return;
+			}
+			writing.swap(pending.front());
+			pending.pop_front();
+		}
+
+		if(!_writeBlock(writing))
+		{
+			// the lines are lost, the next block says so
+			Poco::FastMutex::ScopedLock lock(mutex);
+			numFailedBlocks++;
+			numPendingFails++;
+		}
+
+		writing.clear();
+		Poco::FastMutex::ScopedLock lock(mutex);
+		if(spare.size() < s_maxSpareBlocks)
+		{
+			spare.push_back(std::string());
+			spare.back().swap(writing);
+		}
+	}
+}
+
+bool ofxLogCompressedFileChannel::_writeBlock(const std::string& text)
+{
+	int blockLevel;
+	{
+		Poco::FastMutex::ScopedLock lock(mutex);
+		blockLevel = level;
+	}
+
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	if(deflateInit2(&stream, blockLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		return false;
+	}
+	std::size_t bound = deflateBound(&stream, text.size());
+	member.resize(s_headerSize+bound+s_trailerSize);
+	stream.next_in = (Bytef*) text.data();
+	stream.avail_in = text.size();
+	stream.next_out = (Bytef*) &member[s_headerSize];
+	stream.avail_out = bound;
+	int result = deflate(&stream, Z_FINISH);
+	deflateEnd(&stream);
+	if(result != Z_STREAM_END)
+	{
+		return false;
+	}
+	std::size_t size = s_headerSize+stream.total_out+s_trailerSize;
+	member.resize(size);
+
+	// gzip header: magic, deflate, FEXTRA, no mtime, no flags, unknown OS
+	char* header = &member[0];
+	const char gzip[10] = {(char) 0x1f, (char) 0x8b, 8, 4, 0, 0, 0, 0, 0, (char) 0xff};
+	memcpy(header, gzip, sizeof(gzip));
+	header[10] = 12;	// extra length
+	header[11] = 0;
+	header[12] = 'O';
+	header[13] = 'L';
+	header[14] = 8;		// field length
+	header[15] = 0;
+	writeUInt32(header+16, (uint32_t) size);
+	writeUInt32(header+20, (uint32_t) text.size());
+
+	char* trailer = &member[size-s_trailerSize];
+	writeUInt32(trailer, (uint32_t) crc32(0, (const Bytef*) text.data(), text.size()));
+	writeUInt32(trailer+4, (uint32_t) text.size());
+
+	// the block is only complete on disk once it's all there, a reader skips
+	// a block torn by a crash
+	bool bWritten = fwrite(member.data(), 1, size, file) == size && fflush(file) == 0;
+	if(bWritten)
+	{
+		Poco::FastMutex::ScopedLock lock(mutex);
+		numFileBytes += size;
+	}
+	return bWritten;
+}
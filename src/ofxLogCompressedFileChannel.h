@@ -0,0 +1,197 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include "ofxLogChannel.h"
+
+#include <Poco/Message.h>
+#include <Poco/Mutex.h>
+#include <Poco/Thread.h>
+#include <Poco/Runnable.h>
+#include <Poco/Event.h>
+#include <Poco/Timestamp.h>
+
+#include <deque>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogCompressedFileChannel
+/// \brief writes log lines to a file compressed in independent blocks
+///
+/// Lines are collected into a block in memory. A full block (1MB by default)
+/// is compressed and appended to the file by a background thread, so the
+/// logging thread only copies the line. Verbose logs compress about 10:1,
+/// which saves write bandwidth on slow SD cards and eMMC.
+///
+/// Each block is a complete gzip member, so the file can be read with
+/// zcat/gunzip and with ofxLogQuery. A crash only loses the block that was
+/// being filled or written: the blocks before it are already complete on
+/// disk, and a block torn by the crash is cut off the end of the file when
+/// it's opened again. A block that isn't full is still written after the flush time
+/// (5 seconds by default), on flush(), and on close().
+///
+/// Logging never waits on the compressor. If the compressor falls more than
+/// the max number of pending blocks behind, lines are dropped and counted.
+///
+/// \section File Format
+///
+/// Each block is a gzip member (RFC 1952) with an extra field:
+///
+///		uint8  id[2]		'O', 'L'
+///		uint16 length		8
+///		uint32 blockSize	size of the whole member in bytes
+///		uint32 textSize		size of the inflated text in bytes
+///
+/// All integers are little endian. A reader can step from block to block
+/// using blockSize without inflating anything, see readBlocks().
+///
+class ofxLogCompressedFileChannel : public ofxLogChannel
+{
+	public:
+
+		using ofxLogChannel::log;
+
+		ofxLogCompressedFileChannel();
+		ofxLogCompressedFileChannel(const std::string& path);
+
+		/// opens the file for appending & starts the compressor, a block
+		/// torn at the end of the file is cut off first
+		void open();
+
+		/// writes the current block & stops the compressor
+		void close();
+
+		/// is the file open? false if open() failed
+		bool isOpen();
+
+		/// add a line to the current block
+		void log(const ofxLogRecord& record);
+
+		/// compress & write the current block now, waits until it's written
+		void flush();
+
+		/// Set the file path, used the next time the channel is opened.
+		/// (default "openframeworks.log.gz" in the data folder)
+		void setPath(const std::string& path);
+		std::string getPath();
+
+		/// Set the text size of a block in KB. Bigger blocks compress better,
+		/// smaller blocks lose less in a crash. (default 1024)
+		void setBlockSize(unsigned int sizeKB);
+
+		/// Set the zlib compression level: 1 (fastest) to 9 (smallest).
+		/// (default 6)
+		void setLevel(int level);
+
+		/// Set how many millis a block that isn't full can wait before it's
+		/// written anyway, 0 to only write full blocks. (default 5000)
+		void setFlushMillis(unsigned int millis);
+
+		/// Set how many full blocks can wait for the compressor before lines
+		/// are dropped. (default 8)
+		void setMaxPendingBlocks(unsigned int num);
+
+		/// number of lines dropped because the compressor fell behind
+		unsigned long getNumDropped();
+
+		/// number of blocks lost because they couldn't be written
+		unsigned long getNumFailedBlocks();
+
+		/// text bytes logged & compressed bytes written so far
+		uint64_t getNumTextBytes();
+		uint64_t getNumFileBytes();
+
+		/// For ofxLogCrashHandler only: write the text of the blocks that
+		/// haven't been compressed yet to the fd without locking & with
+		/// async-signal-safe calls.
+		void crashDump(int fd);
+
+		/// \section Reading
+
+		static const unsigned int s_headerSize = 24;	///< gzip header with the extra field
+
+		/// a block in a file
+		struct Block
+		{
+			uint64_t offset;		///< file offset of the gzip member
+			uint32_t size;			///< size of the gzip member
+			uint32_t textSize;		///< size of the inflated text
+		};
+
+		/// Find the blocks of a file by stepping over their headers. A block
+		/// that isn't complete (ie. the one being written during a crash) is
+		/// skipped & the search carries on at the next block header, which
+		/// may have been appended by a later run. Returns false if the file
+		/// can't be read or wasn't written by this channel.
+		static bool readBlocks(const std::string& path, std::vector<Block>& blocks);
+
+		/// Inflate one block & append its text, returns false if the block is
+		/// corrupt.
+		static bool readBlock(const std::string& path, const Block& block, std::string& text);
+
+		/// Inflate a block in memory, data points to the start of the gzip
+		/// member. Returns false if it's corrupt.
+		static bool inflateBlock(const char* data, std::size_t size, std::string& text);
+
+	protected:
+
+		~ofxLogCompressedFileChannel();
+
+	private:
+
+		/// background compressor
+		class Compressor : public Poco::Runnable
+		{
+			public:
+				Compressor(ofxLogCompressedFileChannel& channel) : channel(channel) {}
+				void run();
+			private:
+				ofxLogCompressedFileChannel& channel;
+		};
+
+		/// common constructor setup
+		void _init();
+
+		/// move the current block to the pending blocks (call with mutex locked)
+		void _finishBlock();
+
+		/// compress & write the pending blocks (call with writeMutex locked)
+		void _writePending();
+
+		/// compress one block into a gzip member & write it
+		/// (call with writeMutex locked)
+		bool _writeBlock(const std::string& text);
+
+		/// cut a torn block off the end of the file (call before opening it)
+		void _repair();
+
+		Poco::FastMutex mutex;			///< guards the blocks & settings
+		Poco::FastMutex writeMutex;		///< serializes compressing & the file
+
+		std::string block;				///< the block being filled
+		Poco::Timestamp blockStart;		///< when the first line of the block was logged
+		std::deque<std::string> pending;	///< full blocks waiting for the compressor
+		std::vector<std::string> spare;	///< written blocks, reused to keep their capacity
+		std::string writing;			///< the block being compressed
+		std::string member;				///< the compressed member being built
+
+		std::string path;				///< the file path
+		std::size_t blockSize;			///< block text size in bytes
+		int level;						///< zlib level
+		unsigned int flushMillis;		///< max wait of a block that isn't full
+		unsigned int maxPendingBlocks;	///< drop lines past this many blocks
+
+		unsigned long numDropped;		///< total dropped lines
+		unsigned long numPendingDrops;	///< dropped lines not reported in the file yet
+		unsigned long numFailedBlocks;	///< blocks that couldn't be written
+		unsigned long numPendingFails;	///< failed blocks not reported in the file yet
+		uint64_t numTextBytes;			///< text bytes logged
+		uint64_t numFileBytes;			///< compressed bytes written
+
+		FILE* file;						///< the file, NULL if not open
+		bool bRunning;					///< is the compressor running?
+
+		Compressor compressor;
+		Poco::Thread thread;
+		Poco::Event wakeEvent;			///< set when a block is pending or on close
+};
@@ -0,0 +1,287 @@
+#include "ofxLogConfig.h"
+
+#include "ofxLogRecord.h"
+#include "ofxLogSite.h"
+
+#include <algorithm>
+
+// a thread's pinned snapshot
+struct ofxLogConfigSlot
+{
+	ofxLogConfigSlot() : pinned(NULL), depth(0), bInUse(true) {}
+
+	std::atomic<const ofxLogConfig*> pinned;	///< NULL when not reading
+	unsigned int depth;							///< nested readers, only used by the owner
+	bool bInUse;								///< owned by a thread, guarded by the slots mutex
+};
+
+// all the slots, never freed so threads exiting after main can still log
+struct ofxLogConfigSlots
+{
+	Poco::FastMutex mutex;
+	std::vector<ofxLogConfigSlot*> slots;
+};
+
+static ofxLogConfigSlots& configSlots()
+{
+	static ofxLogConfigSlots* slots = new ofxLogConfigSlots;
+	return *slots;
+}
+
+// gives the thread's slot back when the thread exits
+struct ofxLogConfigSlotHandle
+{
+	ofxLogConfigSlotHandle() : slot(NULL), bExited(false) {}
+
+	~ofxLogConfigSlotHandle()
+	{
+		bExited = true;
+		if(!slot)
+		{
+			return;
+		}
+		slot->pinned.store(NULL, std::memory_order_release);
+		ofxLogConfigSlots& slots = configSlots();
+		Poco::FastMutex::ScopedLock lock(slots.mutex);
+		slot->bInUse = false;
+		slot = NULL;
+	}
+
+	ofxLogConfigSlot* slot;
+	bool bExited;	///< the thread is exiting, don't take a new slot
+};
+
+static thread_local ofxLogConfigSlotHandle t_slotHandle;
+
+// the calling thread's slot, NULL once the thread is exiting
+static ofxLogConfigSlot* threadSlot()
+{
+	ofxLogConfigSlotHandle& handle = t_slotHandle;
+	if(handle.slot || handle.bExited)
+	{
+		return handle.slot;
+	}
+
+	ofxLogConfigSlots& slots = configSlots();
+	Poco::FastMutex::ScopedLock lock(slots.mutex);
+
+	// reuse the slot of a thread that has exited
+	for(unsigned int i = 0; i < slots.slots.size(); ++i)
+	{
+		if(!slots.slots[i]->bInUse)
+		{
+			slots.slots[i]->bInUse = true;
+			slots.slots[i]->depth = 0;
+			handle.slot = slots.slots[i];
+			return handle.slot;
+		}
+	}
+	handle.slot = new ofxLogConfigSlot;
+	slots.slots.push_back(handle.slot);
+	return handle.slot;
+}
+
+//--------------------------------------------------------------
+ofxLogConfig::ofxLogConfig()
+{
+	root.id = 0;
+	root.name = &ofxLogRecord::getTopicName(0);
+	root.level = OF_LOG_NOTICE;
+
+	bConsole = true;
+	bFile = false;
+	bSocket = false;
+	bSharedMemory = false;
+	bCompressedFile = false;
+	bTrace = false;
+
+	bHeader = false;
+	bDate = true;
+	bTime = true;
+	bFrameNum = false;
+	bMillis = false;
+
+	bFlightRecorder = false;
+	bFormatWorkers = false;
+	bFrameFlush = false;
+	frameFlushFrames = 1;
+
+	bListeners = false;
+	for(int i = 0; i < OFX_LOG_NUM_SINKS; ++i)
+	{
+		sinkLevels[i] = OF_LOG_VERBOSE;
+	}
+	updatePrintLevel();
+
+	version = 0;
+}
+
+void ofxLogConfig::updatePrintLevel()
+{
+	const bool bEnabled[] = {bConsole, bFile, bCompressedFile, bSocket, bSharedMemory, bTrace};
+	printLevel = OF_LOG_SILENT;
+	for(unsigned int i = 0; i < sizeof(bEnabled)/sizeof(bEnabled[0]); ++i)
+	{
+		if(bEnabled[i] && sinkLevels[i] < printLevel)
+		{
+			printLevel = sinkLevels[i];
+		}
+	}
+}
+
+//--------------------------------------------------------------
+ofxLogConfigHolder::Reader::Reader(const ofxLogConfigHolder& holder)
+{
+	slot = threadSlot();
+	lockedMutex = NULL;
+	if(!slot)
+	{
+		// no slot to pin with, keep the writers out instead
+		holder.mutex.lock();
+		lockedMutex = &holder.mutex;
+		config = holder.config.load(std::memory_order_acquire);
+		return;
+	}
+
+	if(slot->depth++ > 0)
+	{
+		config = slot->pinned.load(std::memory_order_relaxed);
+		return;
+	}
+
+	// pin, then make sure it wasn't retired before the pin was seen
+	const ofxLogConfig* pinned = holder.config.load(std::memory_order_acquire);
+	for(;;)
+	{
+		slot->pinned.store(pinned, std::memory_order_seq_cst);
+		const ofxLogConfig* now = holder.config.load(std::memory_order_seq_cst);
+		if(now == pinned)
+		{
+			break;
+		}
+		pinned = now;
+	}
+	config = pinned;
+}
+
+ofxLogConfigHolder::Reader::~Reader()
+{
+	if(lockedMutex)
+	{
+		lockedMutex->unlock();
+	}
+	else if(--slot->depth == 0)
+	{
+		slot->pinned.store(NULL, std::memory_order_release);
+	}
+}
+
+//--------------------------------------------------------------
+ofxLogConfigHolder::ofxLogConfigHolder() : config(new ofxLogConfig), batchDepth(0), draft(NULL)
+{
+}
+
+ofxLogConfigHolder::~ofxLogConfigHolder()
+{
+	delete config.load();
+	delete draft;
+	for(unsigned int i = 0; i < drafts.size(); ++i)
+	{
+		delete drafts[i];
+	}
+	for(unsigned int i = 0; i < retired.size(); ++i)
+	{
+		delete retired[i];
+	}
+}
+
+const ofxLogConfig* ofxLogConfigHolder::current() const
+{
+	if(draft)
+	{
+		return draft;
+	}
+	return config.load(std::memory_order_relaxed);
+}
+
+ofxLogConfig* ofxLogConfigHolder::copy() const
+{
+	return new ofxLogConfig(*current());
+}
+
+void ofxLogConfigHolder::publish(ofxLogConfig* next)
+{
+	Poco::Mutex::ScopedLock lock(mutex);
+	if(batchDepth > 0)
+	{
+		// a setter may still be looking at the old draft
+		if(draft)
+		{
+			drafts.push_back(draft);
+		}
+		draft = next;
+		return;
+	}
+	next->version = current()->version+1;
+	next->updatePrintLevel();
+	retired.push_back(config.exchange(next, std::memory_order_seq_cst));
+
+	// the sites cache their enabled check
+	ofxLogSite::refreshAll(*next);
+	_reclaim();
+}
+
+//--------------------------------------------------------------
+ofxLogConfigHolder::Batch::Batch(ofxLogConfigHolder& holder) : holder(holder)
+{
+	holder.mutex.lock();
+	holder.batchDepth++;
+}
+
+ofxLogConfigHolder::Batch::~Batch()
+{
+	if(--holder.batchDepth == 0 && holder.draft)
+	{
+		ofxLogConfig* next = holder.draft;
+		holder.draft = NULL;
+		holder.publish(next);
+		for(unsigned int i = 0; i < holder.drafts.size(); ++i)
+		{
+			delete holder.drafts[i];
+		}
+		holder.drafts.clear();
+	}
+	holder.mutex.unlock();
+}
+
+//--------------------------------------------------------------
+void ofxLogConfigHolder::_reclaim()
+{
+	std::vector<const ofxLogConfig*> pinned;
+	{
+		ofxLogConfigSlots& slots = configSlots();
+		Poco::FastMutex::ScopedLock lock(slots.mutex);
+		for(unsigned int i = 0; i < slots.slots.size(); ++i)
+		{
+			const ofxLogConfig* p = slots.slots[i]->pinned.load(std::memory_order_seq_cst);
+			if(p)
+			{
+				pinned.push_back(p);
+			}
+		}
+	}
+
+	std::vector<const ofxLogConfig*> stillPinned;
+	for(unsigned int i = 0; i < retired.size(); ++i)
+	{
+		if(std::find(pinned.begin(), pinned.end(), retired[i]) != pinned.end())
+		{
+			stillPinned.push_back(retired[i]);
+		}
+		else
+		{
+			delete retired[i];
+		}
+	}
+	retired.swap(stillPinned);
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include "ofxLogPattern.h"
+#include "ofxLogSplitterChannel.h"
+
+#include <Poco/AutoPtr.h>
+#include <Poco/Mutex.h>
+
+#include <atomic>
+
+struct ofxLogConfigSlot;
+
+/// the sinks that can have their own log level, see ofxLogger::setSinkLevel()
+enum ofxLogSink
+{
+	OFX_LOG_SINK_CONSOLE,
+	OFX_LOG_SINK_FILE,				///< the main log file & the topic route files
+	OFX_LOG_SINK_COMPRESSED_FILE,
+	OFX_LOG_SINK_SOCKET,
+	OFX_LOG_SINK_SHARED_MEMORY,
+	OFX_LOG_SINK_TRACE,
+	OFX_LOG_SINK_LISTENERS,			///< the ofxLoggerEvent listeners
+	OFX_LOG_NUM_SINKS
+};
+
+//------------------------------------------------------------------------------
+/// \class ofxLogConfig
+/// \brief an immutable snapshot of the logger settings
+///
+/// Everything a log call reads (levels, topics, the line pattern & the sink
+/// switches) lives in one snapshot that is never changed once it's
+/// published. A setter copies the current snapshot, changes the copy &
+/// publishes it with an atomic pointer swap, so log calls never lock or see
+/// half a change. See ofxLogConfigHolder.
+///
+class ofxLogConfig
+{
+	public:
+
+		/// a log topic
+		struct Topic
+		{
+			unsigned int id;									///< interned topic id
+			const std::string* name;							///< interned topic name
+			ofLogLevel level;									///< lowest level printed
+			Poco::AutoPtr<ofxLogSplitterChannel> channel;		///< main or route channel
+		};
+
+		ofxLogConfig();
+
+		/// the topic, NULL if it wasn't added
+		const Topic* findTopic(const std::string& name) const
+		{
+			std::map<std::string, Topic>::const_iterator iter = topics.find(name);
+			return iter == topics.end() ? NULL : &iter->second;
+		}
+
+		/// is the level at or above the topic's level?
+		static bool isPrinted(const Topic& topic, ofLogLevel level)
+		{
+			return level != OF_LOG_SILENT && level >= topic.level;
+		}
+		
+		/// would a line at this level be printed on the topic by at least one
+		/// of the enabled sinks?
+		bool isAccepted(const Topic& topic, ofLogLevel level) const
+		{
+			return isPrinted(topic, level) && level >= printLevel;
+		}
+		
+		/// would the event listeners get a message at this level? they get
+		/// messages below the topic's level too
+		bool isHeard(ofLogLevel level) const
+		{
+			return bListeners && level != OF_LOG_SILENT &&
+				level >= sinkLevels[OFX_LOG_SINK_LISTENERS];
+		}
+		
+		/// sets printLevel from the sink switches & levels, called when the
+		/// snapshot is published
+		void updatePrintLevel();
+
+		Topic root;									///< no topic, holds the global level
+		std::map<std::string, Topic> topics;		///< the added topics
+		Poco::AutoPtr<ofxLogPattern> pattern;		///< the line layout
+
+		bool bConsole;	///< are we printing to the console?
+		bool bFile;		///< are we printing to a file?
+		bool bSocket;	///< are we sending to a collector?
+		bool bSharedMemory;	///< are we writing to shared memory?
+		bool bCompressedFile;	///< are we writing a compressed file?
+		bool bTrace;			///< are we writing a trace?
+
+		bool bHeader;	///< are we printing the header?
+		bool bDate;		///< print the date?
+		bool bTime;		///< print the time?
+		bool bFrameNum;	///< print the frame num?
+		bool bMillis;	///< print the elapsed millis?
+
+		bool bFlightRecorder;	///< recording dropped messages?
+		bool bFormatWorkers;	///< formatting on the worker pool?
+		bool bFrameFlush;		///< flushing once per frame?
+		unsigned int frameFlushFrames;	///< frames between flushes
+		
+		bool bListeners;		///< are there listeners added with ofxLogger::addListener()?
+		ofLogLevel sinkLevels[OFX_LOG_NUM_SINKS];	///< lowest level each sink gets
+		ofLogLevel printLevel;	///< lowest level of the enabled sinks, OF_LOG_SILENT if none
+
+		unsigned int version;	///< counts up with each published snapshot
+};
+
+//------------------------------------------------------------------------------
+/// \class ofxLogConfigHolder
+/// \brief publishes config snapshots to the logging threads
+///
+/// Readers pin the current snapshot for the length of a log call with a
+/// Reader: each thread has a slot it writes the snapshot pointer into, no
+/// shared memory is written & nothing is locked. Writers are serialized by
+/// the holder's mutex, they publish a new snapshot & retire the old one,
+/// which is deleted once no thread has it pinned any more (checked each time
+/// a snapshot is published).
+///
+/// Readers can nest on a thread (ie. a listener that logs), the inner reader
+/// uses the snapshot the outer one pinned. There's one holder per app, the
+/// one in ofxLogger.
+///
+class ofxLogConfigHolder
+{
+	public:
+
+		/// starts with a default snapshot
+		ofxLogConfigHolder();
+		~ofxLogConfigHolder();
+
+		/// pins the current snapshot while it's in scope
+		class Reader
+		{
+			public:
+
+				Reader(const ofxLogConfigHolder& holder);
+				~Reader();
+
+				const ofxLogConfig* operator->() const	{return config;}
+				const ofxLogConfig& operator*() const	{return *config;}
+
+			private:
+
+				const ofxLogConfig* config;
+				ofxLogConfigSlot* slot;		///< the thread's slot
+				Poco::Mutex* lockedMutex;	///< locked instead when the thread is exiting
+
+				Reader(Reader const&);				// not defined, not copyable
+				Reader& operator=(Reader const&);	// not defined, not assignable
+		};
+
+		/// \section Writing
+		///
+		/// Lock the mutex around a change:
+		///
+		///		Poco::Mutex::ScopedLock lock(holder.mutex);
+		///		ofxLogConfig* config = holder.copy();
+		///		config->bFile = true;
+		///		holder.publish(config);
+
+		/// the current snapshot, only safe to use with the mutex locked
+		/// (the draft in a batch)
+		const ofxLogConfig* current() const;
+
+		/// a copy of the current snapshot to change & publish
+		ofxLogConfig* copy() const;
+
+		/// make the new snapshot current, takes ownership
+		void publish(ofxLogConfig* config);
+
+		mutable Poco::Mutex mutex;	///< serializes writers, recursive so setters can nest
+
+		/// groups the changes made while it's in scope into one snapshot:
+		/// publish() keeps the snapshot as a draft that current() & copy()
+		/// carry on from, the last draft is published when the batch ends.
+		/// Locks the mutex for its lifetime, batches can nest.
+		class Batch
+		{
+			public:
+
+				Batch(ofxLogConfigHolder& holder);
+				~Batch();
+
+			private:
+
+				ofxLogConfigHolder& holder;
+
+				Batch(Batch const&);				// not defined, not copyable
+				Batch& operator=(Batch const&);		// not defined, not assignable
+		};
+
+	private:
+
+		/// deletes the retired snapshots no thread has pinned
+		void _reclaim();
+
+		std::atomic<const ofxLogConfig*> config;	///< the current snapshot
+		std::vector<const ofxLogConfig*> retired;	///< old snapshots, maybe still pinned
+
+		unsigned int batchDepth;			///< nested batches
+		ofxLogConfig* draft;				///< the batch's snapshot so far, NULL if nothing changed
+		std::vector<ofxLogConfig*> drafts;	///< replaced drafts, deleted when the batch ends
+
+		ofxLogConfigHolder(ofxLogConfigHolder const&);				// not defined, not copyable
+		ofxLogConfigHolder& operator=(ofxLogConfigHolder const&);	// not defined, not assignable
+};
@@ -0,0 +1,164 @@
+#include "ofxLogConfigWatcher.h"
+
+#include <Poco/File.h>
+#include <Poco/Path.h>
+
+#ifdef TARGET_LINUX
+	#include <unistd.h>
+	#include <poll.h>
+	#include <sys/inotify.h>
+#endif
+
+//--------------------------------------------------------------
+ofxLogConfigWatcher::ofxLogConfigWatcher() : watcher(*this)
+{
+	callback = NULL;
+	bRunning = false;
+}
+
+ofxLogConfigWatcher::~ofxLogConfigWatcher()
+{
+	stop();
+}
+
+//--------------------------------------------------------------
+void ofxLogConfigWatcher::start(const std::string& path, Callback callback)
+{
+	stop();
+	Poco::FastMutex::ScopedLock lock(mutex);
+	this->path = path;
+	this->callback = callback;
+	bRunning = true;
+	stopEvent.reset();
+	thread.start(watcher);
+}
+
+void ofxLogConfigWatcher::stop()
+{
+	{
+		Poco::FastMutex::ScopedLock lock(mutex);
+		if(!bRunning)
+		{
+			return;
+		}
+		bRunning = false;
+	}
+	stopEvent.set();
+	thread.join();
+}
+
+bool ofxLogConfigWatcher::isRunning()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return bRunning;
+}
+
+std::string ofxLogConfigWatcher::getPath()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return path;
+}
+
+//--------------------------------------------------------------
+void ofxLogConfigWatcher::Watcher::run()
+{
+	if(!watcher._watchNotify())
+	{
+		watcher._watchPoll();
+	}
+}
+
+bool ofxLogConfigWatcher::_watchNotify()
+{
+	#ifdef TARGET_LINUX
+		int fd = inotify_init();
+		if(fd < 0)
+		{
+			return false;
+		}
+
+		// watch the folder, editors often replace the file instead of
+		// writing into it
+		Poco::Path file(path);
+		std::string folder = file.parent().toString();
+		std::string name = file.getFileName();
+		if(folder.empty())
+		{
+			folder = ".";
+		}
+		if(inotify_add_watch(fd, folder.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+		{
+			::close(fd);
+			return false;
+		}
+
+		alignas(struct inotify_event) char events[4096];
+		bool bChanged = false;
+		while(isRunning())
+		{
+			struct pollfd pfd;
+			pfd.fd = fd;
+			pfd.events = POLLIN;
+
+			// wait a moment after a change so a save that's several writes
+			// or a write + rename is only reported once
+			int ready = poll(&pfd, 1, bChanged ? 50 : 500);
+			if(ready > 0)
+			{
+				ssize_t size = read(fd, events, sizeof(events));
+				for(ssize_t i = 0; i < size;)
+				{
+					const struct inotify_event* event = (const struct inotify_event*) (events+i);
+					if(event->len > 0 && name == event->name)
+					{
+						bChanged = true;
+					}
+					i += sizeof(struct inotify_event)+event->len;
+				}
+			}
+			else if(ready == 0 && bChanged)
+			{
+				bChanged = false;
+				callback(path);
+			}
+		}
+		::close(fd);
+		return true;
+	#else
+		return false;
+	#endif
+}
+
+void ofxLogConfigWatcher::_watchPoll()
+{
+	Poco::Int64 stamp = _fileStamp();
+	while(!stopEvent.tryWait(1000))
+	{
+		Poco::Int64 newStamp = _fileStamp();
+		if(newStamp != stamp)
+		{
+			stamp = newStamp;
+			if(newStamp != 0)
+			{
+				callback(path);
+			}
+		}
+	}
+}
+
+Poco::Int64 ofxLogConfigWatcher::_fileStamp()
+{
+	try
+	{
+		Poco::File file(path);
+		if(!file.exists())
+		{
+			return 0;
+		}
+		return file.getLastModified().epochMicroseconds()^((Poco::Int64) file.getSize() << 40);
+	}
+	catch(Poco::Exception& e)
+	{
+		return 0;
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <Poco/Runnable.h>
+#include <Poco/Thread.h>
+#include <Poco/Event.h>
+#include <Poco/Mutex.h>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogConfigWatcher
+/// \brief calls back when a config file changes
+///
+/// Watches a file from a background thread & calls the callback with the
+/// path each time the file is written (or replaced, as most editors save by
+/// writing a new file & renaming it). Uses inotify on Linux & checks the
+/// file's modification time & size once a second elsewhere.
+///
+/// The callback is called on the watcher thread.
+///
+class ofxLogConfigWatcher
+{
+	public:
+
+		typedef void (*Callback)(const std::string& path);
+
+		ofxLogConfigWatcher();
+		~ofxLogConfigWatcher();
+
+		/// start watching a file, stops watching the previous one
+		void start(const std::string& path, Callback callback);
+
+		/// stop watching, waits for the thread
+		void stop();
+
+		/// is a file being watched?
+		bool isRunning();
+
+		/// the file being watched
+		std::string getPath();
+
+	private:
+
+		/// the watcher thread
+		class Watcher : public Poco::Runnable
+		{
+			public:
+				Watcher(ofxLogConfigWatcher& watcher) : watcher(watcher) {}
+				void run();
+			private:
+				ofxLogConfigWatcher& watcher;
+		};
+
+		/// watches with inotify, returns false if it isn't available
+		bool _watchNotify();
+
+		/// watches by checking the modification time
+		void _watchPoll();
+
+		/// the file's modification time & size, 0 if it doesn't exist
+		Poco::Int64 _fileStamp();
+
+		std::string path;		///< the watched file
+		Callback callback;		///< called on changes
+		bool bRunning;			///< keep watching?
+
+		Watcher watcher;		///< the runnable
+		Poco::Thread thread;	///< the watcher thread
+		Poco::Event stopEvent;	///< wakes the polling loop to stop
+		Poco::FastMutex mutex;	///< guards bRunning
+
+		ofxLogConfigWatcher(ofxLogConfigWatcher const&);				// not defined, not copyable
+		ofxLogConfigWatcher& operator=(ofxLogConfigWatcher const&);	// not defined, not assignable
+};
@@ -0,0 +1,349 @@
+#include "ofxLogConsoleChannel.h"
+
+#include "ofxLogCrashHandler.h"
+
+#ifdef TARGET_WIN32
+	#include <io.h>
+#else
+	#include <unistd.h>
+	#include <poll.h>
+	#include <errno.h>
+#endif
+
+//--------------------------------------------------------------
+ofxLogConsoleChannel::ofxLogConsoleChannel() : writer(*this)
+{
+	levelColors[OF_LOG_VERBOSE] = OF_CONSOLE_COLOR_CYAN;
+	levelColors[OF_LOG_NOTICE] = OF_CONSOLE_COLOR_RESTORE;
+	levelColors[OF_LOG_WARNING] = OF_CONSOLE_COLOR_YELLOW;
+	levelColors[OF_LOG_ERROR] = OF_CONSOLE_COLOR_RED;
+	levelColors[OF_LOG_FATAL_ERROR] = OF_CONSOLE_COLOR_PURPLE;
+	defaultColor = OF_CONSOLE_COLOR_RESTORE;
+
+	// escape codes only make sense on a terminal
+	#ifdef TARGET_WIN32
+		bColors = false;
+	#else
+		bColors = isatty(STDOUT_FILENO);
+	#endif
+
+	bNonBlocking = false;
+	bManualFlush = false;
+	bRunning = false;
+
+	lingerMillis = 10;
+	bufferSize = 64*1024;
+	numDropped = 0;
+	numPendingDrops = 0;
+
+	buffer.reserve(bufferSize);
+	_buildColors();
+}
+
+ofxLogConsoleChannel::~ofxLogConsoleChannel()
+{
+	close();
+}
+
+//--------------------------------------------------------------
+void ofxLogConsoleChannel::open()
+{
+	Poco::FastMutex::ScopedLock lock(bufferMutex);
+	if(bRunning)
+	{
+		return;
+	}
+	bRunning = true;
+	thread.start(writer);
+}
+
+void ofxLogConsoleChannel::close()
+{
+	{
+		Poco::FastMutex::ScopedLock lock(bufferMutex);
+		if(!bRunning)
+		{
+			return;
+		}
+		bRunning = false;
+	}
+	wakeEvent.set();
+	thread.join();
+	flush();
+}
+
+//--------------------------------------------------------------
+void ofxLogConsoleChannel::log(const ofxLogRecord& record)
+{
+	bool bWriteNow;
+	{
+		Poco::FastMutex::ScopedLock lock(bufferMutex);
+
+		ofxLogText text = record.getLine();
+		const std::string& prefix = prefixes[record.getPriority()];
+
+		if(bNonBlocking && buffer.size()+text.size() > bufferSize*4)
+		{
+			numDropped++;
+			numPendingDrops++;
+			return;
+		}
+
+		bool bWasEmpty = buffer.empty();
+
+		buffer += prefix;
+		buffer.append(text.data(), text.size());
+		if(prefix.empty())
+		{
+			buffer += '\n';
+		}
+		else
+		{
+			buffer += suffix;
+		}
+
+		// errors are written right away in case the app is about to go down
+		bWriteNow = !bRunning || (!bNonBlocking && (buffer.size() >= bufferSize ||
+			record.getPriority() <= Poco::Message::PRIO_ERROR));
+
+		if(bWasEmpty && !bWriteNow && !bManualFlush)
+		{
+			wakeEvent.set();
+		}
+	}
+
+	if(bWriteNow)
+	{
+		flush();
+	}
+}
+
+void ofxLogConsoleChannel::flush()
+{
+	Poco::FastMutex::ScopedLock lock(writeMutex);
+	_write();
+}
+
+void ofxLogConsoleChannel::flushInBackground()
+{
+	wakeEvent.set();
+}
+
+//--------------------------------------------------------------
+void ofxLogConsoleChannel::setLevelColor(ofLogLevel level, int color)
+{
+	if(level < OF_LOG_VERBOSE || level > OF_LOG_FATAL_ERROR)
+	{
+		return;
+	}
+	Poco::FastMutex::ScopedLock lock(bufferMutex);
+	levelColors[level] = color;
+	_buildColors();
+}
+
+void ofxLogConsoleChannel::setDefaultColor(int color)
+{
+	Poco::FastMutex::ScopedLock lock(bufferMutex);
+	defaultColor = color;
+	_buildColors();
+}
+
+//--------------------------------------------------------------
+void ofxLogConsoleChannel::enableColors()
+{
+	Poco::FastMutex::ScopedLock lock(bufferMutex);
+	bColors = true;
+	_buildColors();
+}
+
+void ofxLogConsoleChannel::disableColors()
+{
+	Poco::FastMutex::ScopedLock lock(bufferMutex);
+	bColors = false;
+	_buildColors();
+}
+
+bool ofxLogConsoleChannel::usingColors()
+{
+	return bColors;
+}
+
+//--------------------------------------------------------------
+void ofxLogConsoleChannel::enableNonBlocking()
+{
+	Poco::FastMutex::ScopedLock lock(bufferMutex);
+	bNonBlocking = true;
+}
+
+void ofxLogConsoleChannel::disableNonBlocking()
+{
+	Poco::FastMutex::ScopedLock lock(bufferMutex);
+	bNonBlocking = false;
+}
+
+bool ofxLogConsoleChannel::usingNonBlocking()
+{
+	return bNonBlocking;
+}
+
+//--------------------------------------------------------------
+void ofxLogConsoleChannel::enableManualFlush()
+{
+	Poco::FastMutex::ScopedLock lock(bufferMutex);
+	bManualFlush = true;
+}
+
+void ofxLogConsoleChannel::disableManualFlush()
+{
+	{
+		Poco::FastMutex::ScopedLock lock(bufferMutex);
+		bManualFlush = false;
+	}
+	// what's waiting would otherwise sit there until the next line
+	wakeEvent.set();
+}
+
+bool ofxLogConsoleChannel::usingManualFlush()
+{
+	return bManualFlush;
+}
+
+//--------------------------------------------------------------
+void ofxLogConsoleChannel::setLingerMillis(unsigned int millis)
+{
+	Poco::FastMutex::ScopedLock lock(bufferMutex);
+	lingerMillis = millis;
+}
+
+void ofxLogConsoleChannel::setBufferSize(unsigned int sizeKB)
+{
+	Poco::FastMutex::ScopedLock lock(bufferMutex);
+	bufferSize = sizeKB*1024;
+	buffer.reserve(bufferSize);
+}
+
+unsigned int ofxLogConsoleChannel::getBufferSize()
+{
+	Poco::FastMutex::ScopedLock lock(bufferMutex);
+	return bufferSize/1024;
+}
+
+unsigned long ofxLogConsoleChannel::getNumDropped()
+{
+	Poco::FastMutex::ScopedLock lock(bufferMutex);
+	return numDropped;
+}
+
+void ofxLogConsoleChannel::crashDump(int fd)
+{
+	ofxLogCrashHandler::write(fd, buffer.data(), buffer.size());
+}
+
+//--------------------------------------------------------------
+void ofxLogConsoleChannel::Writer::run()
+{
+	while(true)
+	{
+		channel.wakeEvent.wait();
+
+		unsigned int linger;
+		bool bRunning, bManualFlush;
+		{
+			Poco::FastMutex::ScopedLock lock(channel.bufferMutex);
+			linger = channel.lingerMillis;
+			bRunning = channel.bRunning;
+			bManualFlush = channel.bManualFlush;
+		}
+		if(!bRunning)
+		{
+			break;
+		}
+
+		// give the lines logged right after this one a chance to join in,
+		// a manual flush has already picked its moment
+		if(linger > 0 && !bManualFlush)
+		{
+			Poco::Thread::sleep(linger);
+		}
+		channel.flush();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLogConsoleChannel::_write()
+{
+	{
+		Poco::FastMutex::ScopedLock lock(bufferMutex);
+		if(buffer.empty() && numPendingDrops == 0)
+		{
+			return;
+		}
+
+		// swap so logging threads can keep appending while this one writes,
+		// both strings keep their capacity
+		writing.clear();
+		writing.swap(buffer);
+
+		if(numPendingDrops > 0)
+		{
+			writing += "ofxLogConsoleChannel: "+ofToString(numPendingDrops)+" lines dropped\n";
+			numPendingDrops = 0;
+		}
+	}
+	_writeAll(writing);
+}
+
+void ofxLogConsoleChannel::_writeAll(const std::string& data)
+{
+	#ifdef TARGET_WIN32
+		fwrite(data.data(), 1, data.size(), stdout);
+		fflush(stdout);
+	#else
+		const char* p = data.data();
+		std::size_t left = data.size();
+		while(left > 0)
+		{
+			ssize_t num = ::write(STDOUT_FILENO, p, left);
+			if(num < 0)
+			{
+				if(errno == EINTR)
+				{
+					continue;
+				}
+				else if(errno == EAGAIN || errno == EWOULDBLOCK)
+				{
+					// someone else set stdout non-blocking, wait for room
+					pollfd pfd = {STDOUT_FILENO, POLLOUT, 0};
+					poll(&pfd, 1, 100);
+					continue;
+				}
+				return; // closed or broken, nothing more we can do
+			}
+			p += num;
+			left -= num;
+		}
+	#endif
+}
+
+//--------------------------------------------------------------
+void ofxLogConsoleChannel::_buildColors()
+{
+	for(int priority = 0; priority < 9; ++priority)
+	{
+		int color = levelColors[ofxLogRecord::toLevel(priority)];
+		if(color == OF_CONSOLE_COLOR_RESTORE)
+		{
+			color = defaultColor;
+		}
+
+		if(bColors && color != OF_CONSOLE_COLOR_RESTORE)
+		{
+			prefixes[priority] = "\033["+ofToString(color)+"m";
+		}
+		else
+		{
+			prefixes[priority].clear();
+		}
+	}
+	suffix = "\033["+ofToString(OF_CONSOLE_COLOR_RESTORE)+"m\n";
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include "ofxLogChannel.h"
+
+#include <Poco/Message.h>
+#include <Poco/Mutex.h>
+#include <Poco/Thread.h>
+#include <Poco/Runnable.h>
+#include <Poco/Event.h>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogConsoleChannel
+/// \brief a buffered, colored console channel
+///
+/// A replacement for the Poco::ConsoleChannel that doesn't write one line at a
+/// time. Lines are appended to a buffer along with their color codes and a
+/// background thread writes the whole buffer to stdout with a single write
+/// shortly after the first line arrives (the linger time). Errors, fatal
+/// errors, and a full buffer are written right away.
+///
+/// Each log level has its own color which is precomputed into the escape
+/// codes prepended to each line, so colors are always tied to their lines even
+/// when logging from multiple threads. Colors are skipped when stdout is not a
+/// terminal (piped into a file, etc).
+///
+/// In non-blocking mode lines are only ever written by the background thread,
+/// so a paused terminal (or a full pipe) never blocks the app. If the buffer
+/// fills up in the meantime, new lines are dropped and the number of dropped
+/// lines is printed once the console catches up.
+///
+/// In manual flush mode the background thread isn't woken for each batch,
+/// the lines wait for flush() (ie. once per frame, see
+/// ofxLogger::enableFrameFlush()), an error or a full buffer.
+///
+class ofxLogConsoleChannel : public ofxLogChannel
+{
+	public:
+
+		using ofxLogChannel::log;
+
+		ofxLogConsoleChannel();
+
+		/// starts the background writer
+		void open();
+
+		/// writes everything buffered & stops the background writer
+		void close();
+
+		/// buffer a line
+		void log(const ofxLogRecord& record);
+
+		/// write everything buffered now
+		void flush();
+
+		/// wake the background thread to write everything buffered without
+		/// waiting for the linger time, for non-blocking mode
+		void flushInBackground();
+
+		/// Set the console color for a log level, use the OF_CONSOLE_COLOR
+		/// defines. OF_CONSOLE_COLOR_RESTORE prints the level without a color.
+		///
+		/// defaults:
+		///  - verbose:		cyan
+		///  - notice:		no color
+		///  - warning:		yellow
+		///  - error:		red
+		///  - fatal error:	purple
+		void setLevelColor(ofLogLevel level, int color);
+
+		/// Set the color used for lines that don't have a level color,
+		/// OF_CONSOLE_COLOR_RESTORE goes back to no color.
+		void setDefaultColor(int color);
+
+		/// Print the colors? Enabled by default when stdout is a terminal.
+		void enableColors();
+		void disableColors();
+		bool usingColors();
+
+		/// Only write from the background thread and drop lines when the
+		/// buffer is full instead of blocking. Disabled by default.
+		void enableNonBlocking();
+		void disableNonBlocking();
+		bool usingNonBlocking();
+
+		/// Leave the lines in the buffer until flush() or
+		/// flushInBackground() is called instead of writing them after the
+		/// linger time. Errors & a full buffer are still written right away.
+		/// Disabled by default.
+		void enableManualFlush();
+		void disableManualFlush();
+		bool usingManualFlush();
+
+		/// Set how many millis the background thread waits after the first
+		/// buffered line before writing, lines arriving in the meantime are
+		/// written together. (default 10)
+		void setLingerMillis(unsigned int millis);
+
+		/// Set the buffer size in KB that triggers an immediate write.
+		/// In non-blocking mode lines are dropped when the buffer holds 4x this
+		/// size. (default 64)
+		void setBufferSize(unsigned int sizeKB);
+		unsigned int getBufferSize();
+
+		/// number of lines dropped in non-blocking mode
+		unsigned long getNumDropped();
+
+		/// For ofxLogCrashHandler only: write the buffered lines to the fd
+		/// without locking & with async-signal-safe calls.
+		void crashDump(int fd);
+
+	protected:
+
+		~ofxLogConsoleChannel();
+
+	private:
+
+		/// background writer
+		class Writer : public Poco::Runnable
+		{
+			public:
+				Writer(ofxLogConsoleChannel& channel) : channel(channel) {}
+				void run();
+			private:
+				ofxLogConsoleChannel& channel;
+		};
+
+		/// swap out the buffer & write it (call with writeMutex locked)
+		void _write();
+
+		/// write the whole string to stdout, retrying on short writes
+		void _writeAll(const std::string& data);
+
+		/// rebuild the escape code prefixes after a color change
+		/// (call with bufferMutex locked)
+		void _buildColors();
+
+		Poco::FastMutex bufferMutex;	///< guards buffer & settings
+		Poco::FastMutex writeMutex;		///< serializes writes to stdout
+
+		std::string buffer;				///< lines waiting to be written
+		std::string writing;			///< lines being written
+
+		int levelColors[5];				///< color per level, by ofLogLevel
+		int defaultColor;				///< color for lines without one
+		std::string prefixes[9];		///< escape codes, by Poco priority
+		std::string suffix;				///< reset code & newline
+
+		bool bColors;					///< print the colors?
+		bool bNonBlocking;				///< write only from the writer thread?
+		bool bManualFlush;				///< write only when flushed?
+		bool bRunning;					///< is the writer running?
+
+		unsigned int lingerMillis;		///< wait before writing
+		std::size_t bufferSize;			///< write right away at this size
+		unsigned long numDropped;		///< total dropped lines
+		unsigned long numPendingDrops;	///< dropped lines not reported yet
+
+		Writer writer;
+		Poco::Thread thread;
+		Poco::Event wakeEvent;			///< set when the buffer gets data
+};
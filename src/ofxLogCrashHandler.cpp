@@ -0,0 +1,225 @@
+#include "ofxLogCrashHandler.h"
+
+#ifndef TARGET_WIN32
+	#include <signal.h>
+	#include <unistd.h>
+	#include <fcntl.h>
+	#include <errno.h>
+	#include <pthread.h>
+	#if defined(__GLIBC__) || defined(TARGET_OSX)
+		#include <execinfo.h>
+		#define OFX_LOG_CRASH_BACKTRACE
+	#endif
+#endif
+
+#include <atomic>
+
+#ifndef TARGET_WIN32
+
+static const int s_signals[] = {SIGSEGV, SIGABRT, SIGBUS, SIGILL, SIGFPE};
+static const int s_numSignals = sizeof(s_signals)/sizeof(s_signals[0]);
+static const int s_maxFrames = 64;
+
+// only plain values, the handler can't rely on anything with a destructor
+static int s_fd = -1;
+static bool s_bOwnFd = false;						///< opened by install()?
+static ofxLogCrashHandler::DumpFunction s_dump = NULL;
+static struct sigaction s_previous[s_numSignals];
+static std::atomic<bool> s_bInstalled(false);
+static std::atomic<bool> s_bDumping(false);		///< one crashing thread dumps
+static std::atomic<pthread_t> s_dumpingThread;		///< set while s_bDumping
+static char* s_altStack = NULL;
+
+static const char* signalName(int signal)
+{
+	switch(signal)
+	{
+		case SIGSEGV:	return "SIGSEGV";
+		case SIGABRT:	return "SIGABRT";
+		case SIGBUS:	return "SIGBUS";
+		case SIGILL:	return "SIGILL";
+		case SIGFPE:	return "SIGFPE";
+		default:		return "signal";
+	}
+}
+
+//--------------------------------------------------------------
+static void handleCrash(int signal, siginfo_t* info, void* context)
+{
+	// a second thread crashing meanwhile waits for the first to finish,
+	// the handlers are back to the default action by then
+	if(!s_bDumping.exchange(true))
+	{
+		s_dumpingThread = pthread_self();
+		int fd = s_fd;
+		ofxLogCrashHandler::write(fd, "\n---------- crash: ");
+		ofxLogCrashHandler::write(fd, signalName(signal));
+		ofxLogCrashHandler::write(fd, " (");
+		ofxLogCrashHandler::writeInt(fd, signal);
+		ofxLogCrashHandler::write(fd, "), pid ");
+		ofxLogCrashHandler::writeInt(fd, getpid());
+		ofxLogCrashHandler::write(fd, " ----------\n");
+
+		if(s_dump)
+		{
+			s_dump(fd);
+		}
+
+		#ifdef OFX_LOG_CRASH_BACKTRACE
+			void* frames[s_maxFrames];
+			int numFrames = backtrace(frames, s_maxFrames);
+			ofxLogCrashHandler::write(fd, "---------- backtrace ----------\n");
+			backtrace_symbols_fd(frames, numFrames, fd);
+		#endif
+		ofxLogCrashHandler::write(fd, "---------- end crash ----------\n");
+	}
+	else if(pthread_equal(s_dumpingThread, pthread_self()))
+	{
+		// the dump itself crashed with another signal, which would wait
+		// for itself forever, so skip straight to the default action
+		struct sigaction action;
+		memset(&action, 0, sizeof(action));
+		action.sa_handler = SIG_DFL;
+		sigemptyset(&action.sa_mask);
+		sigaction(signal, &action, NULL);
+	}
+	else
+	{
+		pause();
+	}
+
+	// the handler was reset on entry, so this is the default action once
+	// the handler returns
+	raise(signal);
+}
+
+#endif
+
+//--------------------------------------------------------------
+bool ofxLogCrashHandler::install(const std::string& path, DumpFunction dump)
+{
+	#ifdef TARGET_WIN32
+		return false;
+	#else
+		uninstall();
+
+		int fd = STDERR_FILENO;
+		if(!path.empty())
+		{
+			fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+			if(fd < 0)
+			{
+				return false;
+			}
+		}
+		s_fd = fd;
+		s_bOwnFd = !path.empty();
+		s_dump = dump;
+
+		#ifdef OFX_LOG_CRASH_BACKTRACE
+			// the first backtrace() loads the unwinder, which isn't safe to do
+			// in a signal handler
+			void* frames[1];
+			backtrace(frames, 1);
+		#endif
+
+		// a stack overflow leaves no stack to run the handler on
+		if(!s_altStack)
+		{
+			s_altStack = new char[SIGSTKSZ*4];
+		}
+		stack_t stack;
+		stack.ss_sp = s_altStack;
+		stack.ss_size = SIGSTKSZ*4;
+		stack.ss_flags = 0;
+		sigaltstack(&stack, NULL);
+
+		struct sigaction action;
+		memset(&action, 0, sizeof(action));
+		action.sa_sigaction = &handleCrash;
+		action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESETHAND;
+		sigemptyset(&action.sa_mask);
+		for(int i = 0; i < s_numSignals; ++i)
+		{
+			sigaction(s_signals[i], &action, &s_previous[i]);
+		}
+		s_bDumping = false;
+		s_bInstalled = true;
+		return true;
+	#endif
+}
+
+void ofxLogCrashHandler::uninstall()
+{
+	#ifndef TARGET_WIN32
+		if(!s_bInstalled.exchange(false))
+		{
+			return;
+		}
+		for(int i = 0; i < s_numSignals; ++i)
+		{
+			sigaction(s_signals[i], &s_previous[i], NULL);
+		}
+		if(s_bOwnFd)
+		{
+			close(s_fd);
+		}
+		s_fd = -1;
+		s_dump = NULL;
+	#endif
+}
+
+bool ofxLogCrashHandler::isInstalled()
+{
+	#ifdef TARGET_WIN32
+		return false;
+	#else
+		return s_bInstalled;
+	#endif
+}
+
+//--------------------------------------------------------------
+void ofxLogCrashHandler::write(int fd, const char* text, std::size_t size)
+{
+	#ifndef TARGET_WIN32
+		while(size > 0)
+		{
+			ssize_t num = ::write(fd, text, size);
+			if(num < 0)
+			{
+				if(errno == EINTR)
+				{
+					continue;
+				}
+				return;
+			}
+			text += num;
+			size -= num;
+		}
+	#endif
+}
+
+void ofxLogCrashHandler::write(int fd, const char* text)
+{
+	write(fd, text, strlen(text));
+}
+
+void ofxLogCrashHandler::writeInt(int fd, long long value)
+{
+	// built backwards from the last digit
+	char digits[24];
+	int i = sizeof(digits);
+	bool bNegative = value < 0;
+	unsigned long long v = bNegative ? 0ULL-(unsigned long long) value : (unsigned long long) value;
+	do
+	{
+		digits[--i] = '0'+(char) (v%10);
+		v /= 10;
+	}
+	while(v > 0);
+	if(bNegative)
+	{
+		digits[--i] = '-';
+	}
+	write(fd, digits+i, sizeof(digits)-i);
+}
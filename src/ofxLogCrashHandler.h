@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ofMain.h"
+
+//------------------------------------------------------------------------------
+/// \class ofxLogCrashHandler
+/// \brief writes the log lines still in memory when the app crashes
+///
+/// Installs handlers for SIGSEGV, SIGABRT, SIGBUS, SIGILL & SIGFPE which
+/// call a dump function with a file descriptor that was opened up front,
+/// then write a short backtrace & let the signal go on to its default
+/// action (ie. a core dump). The log calls don't pay anything for it.
+///
+/// Everything in the handler has to be async-signal-safe: no locks, no
+/// heap, no stdio. The dump function reads the buffers without locking,
+/// so a line being written by another thread at the time may come out
+/// torn, and writes them with the write() helpers below.
+///
+/// The handlers run on an alternate stack so a stack overflow is caught as
+/// well, but sigaltstack() is per thread & only the thread that called
+/// install() gets one. A stack overflow on any other thread has no stack
+/// to run the handler on & goes straight to the default action. Not
+/// available on Windows.
+///
+class ofxLogCrashHandler
+{
+	public:
+
+		/// writes the pending lines to the fd from the signal handler
+		typedef void (*DumpFunction)(int fd);
+
+		/// Open the file to append to (or use stderr if the path is empty)
+		/// & install the handlers, replaces an earlier install. Returns
+		/// false if the file couldn't be opened.
+		static bool install(const std::string& path, DumpFunction dump);
+
+		/// restores the previous handlers & closes the file
+		static void uninstall();
+		static bool isInstalled();
+
+		/// \section Async-signal-safe output
+
+		/// write all of the text, retrying on short writes
+		static void write(int fd, const char* text, std::size_t size);
+		static void write(int fd, const char* text);
+
+		/// write a number in decimal
+		static void writeInt(int fd, long long value);
+};
@@ -0,0 +1,203 @@
+#include "ofxLogFlightRecorder.h"
+
+#include "ofxLogCrashHandler.h"
+
+#include <algorithm>
+
+//--------------------------------------------------------------
+// orders entries from different rings when merging
+static bool entryIsOlder(const ofxLogFlightRecorder::Entry& a,
+						 const ofxLogFlightRecorder::Entry& b)
+{
+	return a.time < b.time;
+}
+
+//--------------------------------------------------------------
+ofxLogFlightRecorder::ofxLogFlightRecorder()
+{
+	size = 256;
+}
+
+ofxLogFlightRecorder::~ofxLogFlightRecorder()
+{
+	for(unsigned int i = 0; i < rings.size(); ++i)
+	{
+		delete rings[i];
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLogFlightRecorder::setSize(unsigned int numEntries)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	size = numEntries;
+	for(unsigned int i = 0; i < rings.size(); ++i)
+	{
+		Poco::FastMutex::ScopedLock ringLock(rings[i]->mutex);
+		rings[i]->entries.clear();
+		rings[i]->entries.resize(size);
+		rings[i]->next = 0;
+		rings[i]->count = 0;
+	}
+}
+
+unsigned int ofxLogFlightRecorder::getSize()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return size;
+}
+
+//--------------------------------------------------------------
+void ofxLogFlightRecorder::record(const ofxLogRecord& record)
+{
+	Ring* ring = _threadRing();
+	Poco::FastMutex::ScopedLock lock(ring->mutex);
+
+	if(ring->entries.empty())
+	{
+		return;
+	}
+
+	// overwrite the oldest slot, assign() reuses the slot's string capacity
+	Entry& entry = ring->entries[ring->next];
+	entry.level = record.getLevel();
+	entry.time = record.getTime();
+	entry.frameNum = record.getFrameNum();
+	entry.millis = record.getMillis();
+	entry.threadId = record.getThreadId();
+	if(record.getTopic().empty())
+	{
+		entry.message.assign(record.getMessage().data(), record.getMessage().size());
+	}
+	else
+	{
+		entry.message.assign(record.getTopic());
+		entry.message.append(": ");
+		entry.message.append(record.getMessage().data(), record.getMessage().size());
+	}
+
+	ring->next = (ring->next+1) % ring->entries.size();
+	if(ring->count < ring->entries.size())
+	{
+		ring->count++;
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLogFlightRecorder::drain(std::vector<Entry>& entries, bool allThreads)
+{
+	if(!allThreads)
+	{
+		Ring* ring = _threadRing();
+		Poco::FastMutex::ScopedLock lock(ring->mutex);
+		_drainRing(*ring, entries);
+		return;
+	}
+
+	Poco::FastMutex::ScopedLock lock(mutex);
+	std::size_t start = entries.size();
+	for(unsigned int i = 0; i < rings.size(); ++i)
+	{
+		Poco::FastMutex::ScopedLock ringLock(rings[i]->mutex);
+		_drainRing(*rings[i], entries);
+	}
+	std::stable_sort(entries.begin()+start, entries.end(), entryIsOlder);
+}
+
+void ofxLogFlightRecorder::clear()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	for(unsigned int i = 0; i < rings.size(); ++i)
+	{
+		Poco::FastMutex::ScopedLock ringLock(rings[i]->mutex);
+		rings[i]->next = 0;
+		rings[i]->count = 0;
+	}
+}
+
+void ofxLogFlightRecorder::crashDump(int fd)
+{
+	for(unsigned int i = 0; i < rings.size(); ++i)
+	{
+		const Ring& ring = *rings[i];
+		std::size_t numEntries = ring.entries.size();
+		if(numEntries == 0 || ring.count == 0)
+		{
+			continue;
+		}
+		ofxLogCrashHandler::write(fd, "thread ");
+		ofxLogCrashHandler::writeInt(fd, ring.entries[(ring.next+numEntries-1) % numEntries].threadId);
+		ofxLogCrashHandler::write(fd, ":\n");
+		for(unsigned int j = 0; j < ring.count && j < numEntries; ++j)
+		{
+			const Entry& entry = ring.entries[(ring.next+numEntries-ring.count+j) % numEntries];
+			ofxLogCrashHandler::write(fd, entry.message.data(), entry.message.size());
+			ofxLogCrashHandler::write(fd, "\n", 1);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+ofxLogFlightRecorder::RingHandle::~RingHandle()
+{
+	if(ring)
+	{
+		// keep the contents around for a dump until the next new thread
+		// takes the ring over
+		Poco::FastMutex::ScopedLock lock(ring->mutex);
+		ring->bInUse = false;
+	}
+}
+
+ofxLogFlightRecorder::Ring* ofxLogFlightRecorder::_threadRing()
+{
+	static thread_local RingHandle handle;
+	if(handle.ring)
+	{
+		return handle.ring;
+	}
+
+	Poco::FastMutex::ScopedLock lock(mutex);
+
+	// reuse the ring of a thread that has exited, its lines would
+	// otherwise be dumped as the new thread's
+	for(unsigned int i = 0; i < rings.size(); ++i)
+	{
+		Poco::FastMutex::ScopedLock ringLock(rings[i]->mutex);
+		if(!rings[i]->bInUse)
+		{
+			rings[i]->next = 0;
+			rings[i]->count = 0;
+			rings[i]->bInUse = true;
+			handle.ring = rings[i];
+			return handle.ring;
+		}
+	}
+
+	Ring* ring = new Ring;
+	ring->entries.resize(size);
+	ring->next = 0;
+	ring->count = 0;
+	ring->bInUse = true;
+	rings.push_back(ring);
+
+	handle.ring = ring;
+	return ring;
+}
+
+void ofxLogFlightRecorder::_drainRing(Ring& ring, std::vector<Entry>& entries)
+{
+	if(ring.count == 0)
+	{
+		return;
+	}
+
+	unsigned int num = ring.entries.size();
+	unsigned int oldest = (ring.next + num - ring.count) % num;
+	for(unsigned int i = 0; i < ring.count; ++i)
+	{
+		entries.push_back(ring.entries[(oldest+i) % num]);
+	}
+	ring.next = 0;
+	ring.count = 0;
+}
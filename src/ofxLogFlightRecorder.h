@@ -0,0 +1,94 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxLogRecord.h"
+
+#include <Poco/Mutex.h>
+#include <Poco/Timestamp.h>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogFlightRecorder
+/// \brief an in-memory ring of the low level log lines that were not printed
+///
+/// Every thread that logs gets its own fixed size ring so recording does not
+/// contend with other threads. Each slot keeps the raw message along with the
+/// time, frame num, and elapsed millis it was logged at; the header is only
+/// built when the ring is dumped. Slots are reused, so once a ring is warm
+/// recording a message of a similar length doesn't allocate.
+///
+/// The recorder doesn't print anything by itself, see
+/// ofxLogger::enableFlightRecorder().
+///
+class ofxLogFlightRecorder
+{
+	public:
+
+		/// a single recorded message
+		struct Entry
+		{
+			ofLogLevel level;			///< log level
+			Poco::Timestamp time;		///< when the message was logged
+			int frameNum;				///< frame num when logged
+			unsigned long millis;		///< elapsed millis when logged
+			unsigned int threadId;		///< the logging thread
+			std::string message;		///< the raw message (incl. topic)
+		};
+
+		ofxLogFlightRecorder();
+		~ofxLogFlightRecorder();
+
+		/// Set the number of messages kept per thread (default 256). Existing
+		/// rings are cleared when resized.
+		void setSize(unsigned int numEntries);
+		unsigned int getSize();
+
+		/// record a log record into the calling thread's ring
+		void record(const ofxLogRecord& record);
+
+		/// Move the recorded messages into entries, oldest first, and clear
+		/// the rings. Only the calling thread's ring is drained unless
+		/// allThreads is set, in which case all rings are merged by time.
+		void drain(std::vector<Entry>& entries, bool allThreads);
+
+		/// clear all rings
+		void clear();
+
+		/// For ofxLogCrashHandler only: write the recorded messages to the
+		/// fd, oldest first for each thread, without locking & with
+		/// async-signal-safe calls.
+		void crashDump(int fd);
+
+	private:
+
+		/// a per thread ring of entries
+		struct Ring
+		{
+			Poco::FastMutex mutex;
+			std::vector<Entry> entries;
+			unsigned int next;		///< next slot to write
+			unsigned int count;		///< number of valid slots
+			bool bInUse;			///< owned by a running thread?
+		};
+
+		/// releases a thread's ring when the thread exits
+		struct RingHandle
+		{
+			RingHandle() : ring(NULL) {}
+			~RingHandle();
+			Ring* ring;
+		};
+
+		/// returns the calling thread's ring, creating or reusing one as needed
+		Ring* _threadRing();
+
+		/// append a ring's entries to entries, oldest first, and clear it
+		/// (the ring must be locked)
+		void _drainRing(Ring& ring, std::vector<Entry>& entries);
+
+		Poco::FastMutex mutex;		///< guards rings & size
+		std::vector<Ring*> rings;	///< all rings, never freed while running
+		unsigned int size;			///< num entries per ring
+
+		ofxLogFlightRecorder(ofxLogFlightRecorder const&);				// not defined, not copyable
+		ofxLogFlightRecorder& operator=(ofxLogFlightRecorder const&);	// not defined, not assignable
+};
@@ -0,0 +1,144 @@
+#include "ofxLogFormat.h"
+
+//--------------------------------------------------------------
+// Walks the format calling literal(start, length) for each run of literal
+// text and arg() after each placeholder. Returns false if stopped early.
+template <class Handler>
+static bool scanFormat(const char* format, Handler& handler)
+{
+	unsigned int start = 0;
+	unsigned int i = 0;
+	while(format[i] != '\0')
+	{
+		char c = format[i];
+		if((c == '{' || c == '}') && format[i+1] == c)
+		{
+			// escaped brace: keep the first, skip the second
+			if(!handler.literal(start, i+1-start, false))
+			{
+				return false;
+			}
+			i += 2;
+			start = i;
+		}
+		else if(c == '{' && format[i+1] == '}')
+		{
+			if(!handler.literal(start, i-start, true))
+			{
+				return false;
+			}
+			i += 2;
+			start = i;
+		}
+		else
+		{
+			i++;
+		}
+	}
+	return handler.literal(start, i-start, false);
+}
+
+// collects the runs into a spec
+struct SpecBuilder
+{
+	ofxLogFormatSpec& spec;
+
+	SpecBuilder(ofxLogFormatSpec& spec) : spec(spec) {}
+
+	bool literal(unsigned int start, unsigned int length, bool bArg)
+	{
+		if(length == 0 && !bArg)
+		{
+			return true;
+		}
+		if(spec.numOps == ofxLogFormatSpec::s_maxOps)
+		{
+			return false;
+		}
+		ofxLogFormatSpec::Op& op = spec.ops[spec.numOps++];
+		op.start = start;
+		op.length = length;
+		op.bArg = bArg;
+		return true;
+	}
+};
+
+// formats straight from the scan, for formats that didn't fit in a spec
+struct DirectFormatter
+{
+	ofxLogBuffer& buffer;
+	const char* format;
+	const ofxLogFormatArg* args;
+	unsigned int numArgs;
+	unsigned int nextArg;
+
+	DirectFormatter(ofxLogBuffer& buffer, const char* format,
+					const ofxLogFormatArg* args, unsigned int numArgs) :
+		buffer(buffer), format(format), args(args), numArgs(numArgs), nextArg(0) {}
+
+	bool literal(unsigned int start, unsigned int length, bool bArg)
+	{
+		buffer.append(format+start, length);
+		if(bArg)
+		{
+			if(nextArg < numArgs)
+			{
+				args[nextArg++].appendTo(buffer);
+			}
+			else
+			{
+				buffer.append("{}", 2);
+			}
+		}
+		return true;
+	}
+};
+
+//--------------------------------------------------------------
+ofxLogFormatSpec::ofxLogFormatSpec(const char* format)
+{
+	this->format = format;
+	numOps = 0;
+	SpecBuilder builder(*this);
+	bParsed = scanFormat(format, builder);
+}
+
+//--------------------------------------------------------------
+void ofxLogFormatArgs(ofxLogBuffer& buffer, const ofxLogFormatSpec& spec,
+					  const ofxLogFormatArg* args, unsigned int numArgs)
+{
+	unsigned int nextArg = 0;
+
+	if(spec.bParsed)
+	{
+		for(unsigned int i = 0; i < spec.numOps; ++i)
+		{
+			const ofxLogFormatSpec::Op& op = spec.ops[i];
+			buffer.append(spec.format+op.start, op.length);
+			if(op.bArg)
+			{
+				if(nextArg < numArgs)
+				{
+					args[nextArg++].appendTo(buffer);
+				}
+				else
+				{
+					buffer.append("{}", 2);
+				}
+			}
+		}
+	}
+	else
+	{
+		DirectFormatter formatter(buffer, spec.format, args, numArgs);
+		scanFormat(spec.format, formatter);
+		nextArg = formatter.nextArg;
+	}
+
+	// don't lose arguments without a placeholder
+	for(; nextArg < numArgs; ++nextArg)
+	{
+		buffer.append(' ');
+		args[nextArg].appendTo(buffer);
+	}
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "ofxLogBuffer.h"
+
+#include <tuple>
+
+//------------------------------------------------------------------------------
+/// \section Log Format
+///
+/// A type safe replacement for printf style log formatting. Each "{}" in the
+/// format string is replaced by the next argument, which can be of any type
+/// that ofxLogBuffer (or an ostream) can print. Use "{{" and "}}" for literal
+/// braces:
+///
+///		ofxLog::format(OF_LOG_NOTICE, "render", "{}: {} ms", name, ms);
+///
+/// There is no fixed line size: long lines are never truncated.
+///
+
+/// counts the "{}" placeholders in a format string at compile time
+constexpr unsigned int ofxLogFormatCount(const char* format)
+{
+	return *format == '\0' ? 0 :
+		((format[0] == '{' && format[1] == '{') || (format[0] == '}' && format[1] == '}')) ?
+			ofxLogFormatCount(format+2) :
+		(format[0] == '{' && format[1] == '}') ?
+			1+ofxLogFormatCount(format+2) :
+			ofxLogFormatCount(format+1);
+}
+
+//------------------------------------------------------------------------------
+/// \class ofxLogFormatSpec
+/// \brief a parsed format string
+///
+/// The format string is split once into the literal runs between the
+/// placeholders, so formatting is a series of memcpys & argument appends.
+/// The OFX_LOG_FORMAT macro keeps a static spec for each call site, so the
+/// string is only parsed the first time the line is logged.
+///
+/// Formats with more than s_maxOps runs are scanned on every call instead.
+///
+class ofxLogFormatSpec
+{
+	public:
+
+		explicit ofxLogFormatSpec(const char* format);
+
+		static const unsigned int s_maxOps = 32;	///< max literal runs
+
+		/// a literal run, followed by an argument if bArg is set
+		struct Op
+		{
+			unsigned int start;		///< offset of the literal in the format
+			unsigned int length;	///< literal length
+			bool bArg;				///< print the next argument after the literal
+		};
+
+		const char* format;			///< the format string (not copied)
+		Op ops[s_maxOps];			///< the parsed runs
+		unsigned int numOps;		///< number of runs
+		bool bParsed;				///< false if the format was too complex
+};
+
+//------------------------------------------------------------------------------
+/// \class ofxLogFormatArg
+/// \brief a type erased format argument
+///
+/// Holds a pointer to the argument and the function that appends its type,
+/// so the formatting loop itself isn't a template.
+///
+class ofxLogFormatArg
+{
+	public:
+
+		template <class T>
+		ofxLogFormatArg(const T& value)
+		{
+			this->value = &value;
+			this->appendFunc = &ofxLogFormatArg::_append<T>;
+		}
+
+		void appendTo(ofxLogBuffer& buffer) const
+		{
+			appendFunc(buffer, value);
+		}
+
+	private:
+
+		template <class T>
+		static void _append(ofxLogBuffer& buffer, const void* value)
+		{
+			buffer.append(*static_cast<const T*>(value));
+		}
+
+		const void* value;
+		void (*appendFunc)(ofxLogBuffer&, const void*);
+};
+
+/// Format into a buffer. Placeholders without an argument are printed as is,
+/// extra arguments are appended, separated by spaces.
+void ofxLogFormatArgs(ofxLogBuffer& buffer, const ofxLogFormatSpec& spec,
+					  const ofxLogFormatArg* args, unsigned int numArgs);
+
+inline void ofxLogFormatTo(ofxLogBuffer& buffer, const ofxLogFormatSpec& spec)
+{
+	ofxLogFormatArgs(buffer, spec, NULL, 0);
+}
+
+template <class... Args>
+void ofxLogFormatTo(ofxLogBuffer& buffer, const ofxLogFormatSpec& spec, const Args&... args)
+{
+	const ofxLogFormatArg argArray[] = {ofxLogFormatArg(args)...};
+	ofxLogFormatArgs(buffer, spec, argArray, sizeof...(Args));
+}
+
+//------------------------------------------------------------------------------
+/// Log a formatted line, checking at compile time that the number of
+/// placeholders matches the number of arguments and parsing the format string
+/// only once. The format must be a string literal & there must be at least one
+/// argument:
+///
+///		OFX_LOG_FORMAT(OF_LOG_NOTICE, "render", "{}: {} ms", name, ms);
+///
+#define OFX_LOG_FORMAT(level, topic, fmt, ...) \
+	do { \
+		static_assert(ofxLogFormatCount(fmt) == \
+			std::tuple_size<decltype(std::make_tuple(__VA_ARGS__))>::value, \
+			"OFX_LOG_FORMAT: number of {} placeholders doesn't match the number of arguments"); \
+		static const ofxLogFormatSpec ofxLogFormatSpec_(fmt); \
+		ofxLog::format(level, topic, ofxLogFormatSpec_, __VA_ARGS__); \
+	} while(0)
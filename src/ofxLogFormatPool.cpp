@@ -0,0 +1,245 @@
+#include "ofxLogFormatPool.h"
+
+#include "ofxLogBuffer.h"
+#include "ofxLogCrashHandler.h"
+
+#include <thread>
+
+static const unsigned int s_maxWriteBatch = 64;	// records written per wake up
+
+//--------------------------------------------------------------
+ofxLogFormatPool::ofxLogFormatPool() : worker(*this), writer(*this)
+{
+	nextSeq = 0;
+	claimSeq = 0;
+	writeSeq = 0;
+	bRunning = false;
+	bStopping = false;
+}
+
+ofxLogFormatPool::~ofxLogFormatPool()
+{
+	stop();
+}
+
+//--------------------------------------------------------------
+void ofxLogFormatPool::start(unsigned int numWorkers, unsigned int queueSize)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	if(bRunning)
+	{
+		return;
+	}
+	if(numWorkers == 0)
+	{
+		numWorkers = std::max(2u, std::thread::hardware_concurrency())-1;
+	}
+	unsigned int size = 1;
+	while(size < queueSize)
+	{
+		size *= 2;
+	}
+	slots.assign(size, Item());
+	nextSeq = claimSeq = writeSeq = 0;
+	bRunning = true;
+	bStopping = false;
+
+	for(unsigned int i = 0; i < numWorkers; ++i)
+	{
+		workerThreads.push_back(new Poco::Thread);
+		workerThreads.back()->start(worker);
+	}
+	writerThread.start(writer);
+}
+
+void ofxLogFormatPool::stop()
+{
+	{
+		Poco::FastMutex::ScopedLock lock(mutex);
+		if(!bRunning || bStopping)
+		{
+			return;
+		}
+		bStopping = true;
+		workCondition.broadcast();
+		doneCondition.broadcast();
+	}
+
+	for(unsigned int i = 0; i < workerThreads.size(); ++i)
+	{
+		workerThreads[i]->join();
+		delete workerThreads[i];
+	}
+	workerThreads.clear();
+	writerThread.join();
+
+	Poco::FastMutex::ScopedLock lock(mutex);
+	slots.clear();
+	bRunning = false;
+	bStopping = false;
+	spaceCondition.broadcast();
+}
+
+bool ofxLogFormatPool::isRunning()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return bRunning && !bStopping;
+}
+
+unsigned int ofxLogFormatPool::getNumWorkers()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return workerThreads.size();
+}
+
+//--------------------------------------------------------------
+bool ofxLogFormatPool::push(ofxLogRecord* record, const Poco::AutoPtr<ofxLogPattern>& pattern,
+							const Poco::AutoPtr<ofxLogSplitterChannel>& channel)
+{
+	// a channel logging from the writer would wait on itself
+	if(Poco::Thread::current() == &writerThread)
+	{
+		return false;
+	}
+	Poco::FastMutex::ScopedLock lock(mutex);
+
+	// wait for a free slot instead of dropping, the order has to hold
+	while(bRunning && !bStopping && nextSeq-writeSeq >= slots.size())
+	{
+		spaceCondition.wait(mutex);
+	}
+	if(!bRunning || bStopping)
+	{
+		return false;
+	}
+
+	Item& item = slots[nextSeq & (slots.size()-1)];
+	item.record = Poco::AutoPtr<ofxLogRecord>(record, true);
+	item.pattern = pattern;
+	item.channel = channel;
+	item.bDone = false;
+	nextSeq++;
+	workCondition.signal();
+	return true;
+}
+
+void ofxLogFormatPool::drain()
+{
+	if(Poco::Thread::current() == &writerThread)
+	{
+		return;
+	}
+	Poco::FastMutex::ScopedLock lock(mutex);
+	uint64_t seq = nextSeq;
+	while(bRunning && writeSeq < seq)
+	{
+		spaceCondition.wait(mutex);
+	}
+}
+
+void ofxLogFormatPool::crashDump(int fd)
+{
+	std::size_t numSlots = slots.size();
+	if(numSlots == 0)
+	{
+		return;
+	}
+	for(uint64_t seq = writeSeq; seq < nextSeq && seq-writeSeq < numSlots; ++seq)
+	{
+		const ofxLogRecord* record = slots[seq & (numSlots-1)].record.get();
+		if(!record)
+		{
+			continue;
+		}
+		ofxLogText text = record->getLine();
+		if(text.empty())
+		{
+			text = record->getMessage();
+		}
+		ofxLogCrashHandler::write(fd, text.data(), text.size());
+		ofxLogCrashHandler::write(fd, "\n", 1);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLogFormatPool::Worker::run()
+{
+	Poco::FastMutex::ScopedLock lock(pool.mutex);
+	while(true)
+	{
+		while(pool.claimSeq == pool.nextSeq && !pool.bStopping)
+		{
+			pool.workCondition.wait(pool.mutex);
+		}
+		if(pool.claimSeq == pool.nextSeq)
+		{
+			return; // stopping & nothing left
+		}
+
+		uint64_t seq = pool.claimSeq++;
+		Item& item = pool.slots[seq & (pool.slots.size()-1)];
+		ofxLogRecord* record = item.record;
+		ofxLogPattern* pattern = item.pattern;
+		pool.mutex.unlock();
+
+		// the slot stays ours until it's done, the writer doesn't get past
+		// it, so the record & pattern stay referenced
+		ofxLogBuffer line;
+		ofxLogText message = record->getMessage();
+		pattern->format(line, record->getLevel(), record->getTopic(), message.data(),
+			message.size(), record->getTime(), record->getFrameNum(), record->getMillis(),
+			record->getThreadId());
+		record->setLine(line.c_str(), line.size());
+
+		pool.mutex.lock();
+		item.bDone = true;
+		if(seq == pool.writeSeq)
+		{
+			pool.doneCondition.signal();
+		}
+	}
+}
+
+void ofxLogFormatPool::Writer::run()
+{
+	std::vector<Item> batch;
+	Poco::FastMutex::ScopedLock lock(pool.mutex);
+	while(true)
+	{
+		std::size_t mask = pool.slots.size()-1;
+		while(!(pool.writeSeq < pool.nextSeq && pool.slots[pool.writeSeq & mask].bDone) &&
+			  !(pool.bStopping && pool.writeSeq == pool.nextSeq))
+		{
+			pool.doneCondition.wait(pool.mutex);
+		}
+		if(pool.writeSeq == pool.nextSeq)
+		{
+			return; // stopping & everything is written
+		}
+
+		// take the run of finished records in sequence order
+		uint64_t seq = pool.writeSeq;
+		while(seq < pool.nextSeq && pool.slots[seq & mask].bDone && batch.size() < s_maxWriteBatch)
+		{
+			Item& item = pool.slots[seq & mask];
+			batch.push_back(item);
+			item = Item();
+			seq++;
+		}
+		pool.mutex.unlock();
+
+		// only the channels are called here, the listeners were notified on
+		// the logging thread
+		for(unsigned int i = 0; i < batch.size(); ++i)
+		{
+			batch[i].channel->log(*batch[i].record);
+		}
+		batch.clear();
+
+		// the slots are only given back once their records are written, so
+		// drain() returns after the channels have them
+		pool.mutex.lock();
+		pool.writeSeq = seq;
+		pool.spaceCondition.broadcast();
+	}
+}
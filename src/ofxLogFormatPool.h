@@ -0,0 +1,126 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include "ofxLogRecord.h"
+#include "ofxLogPattern.h"
+#include "ofxLogSplitterChannel.h"
+
+#include <Poco/AutoPtr.h>
+#include <Poco/Mutex.h>
+#include <Poco/Condition.h>
+#include <Poco/Thread.h>
+#include <Poco/Runnable.h>
+
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogFormatPool
+/// \brief formats log lines on worker threads & writes them in order
+///
+/// The logging thread only copies the message into a record (with room for
+/// its line, see ofxLogRecord::createUnformatted()) & queues it with the next
+/// sequence number. A few workers build the printed lines (header, level,
+/// topic & message, see ofxLogPattern) into the records in parallel and a
+/// single writer thread hands the finished records to the channels strictly
+/// in sequence order, so the sinks see the lines in the order they were
+/// logged while formatting scales with the cores.
+///
+/// The queue holds a fixed number of records, logging waits for a free slot
+/// when it's full so nothing is dropped or reordered. drain() waits until
+/// everything queued so far has been written.
+///
+/// Only the channels are called from the writer thread, the listeners are
+/// notified by the logging thread before the record is queued. See
+/// ofxLogger::enableFormatWorkers().
+///
+class ofxLogFormatPool
+{
+	public:
+
+		ofxLogFormatPool();
+
+		/// writes everything queued & stops the threads
+		~ofxLogFormatPool();
+
+		/// Start the workers & the writer, 0 workers uses one less than the
+		/// number of cores (at least 1). The queue size is rounded up to a
+		/// power of 2.
+		void start(unsigned int numWorkers=0, unsigned int queueSize=4096);
+
+		/// writes everything queued & stops the threads
+		void stop();
+
+		bool isRunning();
+		unsigned int getNumWorkers();
+
+		/// Queue a record made with ofxLogRecord::createUnformatted() to be
+		/// formatted with the pattern & written to the channel. Returns false
+		/// if the pool isn't running or is stopping, or if it's called from
+		/// the writer thread (ie. a channel that logs); drain() before
+		/// writing the record some other way so it stays in order.
+		bool push(ofxLogRecord* record, const Poco::AutoPtr<ofxLogPattern>& pattern,
+				  const Poco::AutoPtr<ofxLogSplitterChannel>& channel);
+
+		/// wait until everything queued so far has been written, returns
+		/// right away on the writer thread
+		void drain();
+
+		/// For ofxLogCrashHandler only: write the records that haven't been
+		/// written yet to the fd without locking & with async-signal-safe
+		/// calls, the formatted line if it's done or else the message.
+		void crashDump(int fd);
+
+	private:
+
+		/// a queued record, in the slot of its sequence number
+		struct Item
+		{
+			Item() : bDone(false) {}
+
+			Poco::AutoPtr<ofxLogRecord> record;			///< the line is set by a worker
+			Poco::AutoPtr<ofxLogPattern> pattern;
+			Poco::AutoPtr<ofxLogSplitterChannel> channel;
+			bool bDone;									///< formatted, ready to write
+		};
+
+		/// formats the queued records
+		class Worker : public Poco::Runnable
+		{
+			public:
+				Worker(ofxLogFormatPool& pool) : pool(pool) {}
+				void run();
+			private:
+				ofxLogFormatPool& pool;
+		};
+
+		/// writes the formatted records in order
+		class Writer : public Poco::Runnable
+		{
+			public:
+				Writer(ofxLogFormatPool& pool) : pool(pool) {}
+				void run();
+			private:
+				ofxLogFormatPool& pool;
+		};
+
+		Poco::FastMutex mutex;				///< guards everything below
+		Poco::Condition workCondition;		///< a record was queued
+		Poco::Condition doneCondition;		///< the next record to write is done
+		Poco::Condition spaceCondition;		///< records were written
+
+		std::vector<Item> slots;			///< the queue, by sequence number
+		uint64_t nextSeq;					///< sequence number of the next queued record
+		uint64_t claimSeq;					///< next record for a worker
+		uint64_t writeSeq;					///< next record to write
+		bool bRunning;
+		bool bStopping;						///< write what's queued, then stop
+
+		Worker worker;
+		Writer writer;
+		std::vector<Poco::Thread*> workerThreads;
+		Poco::Thread writerThread;
+
+		ofxLogFormatPool(ofxLogFormatPool const&);				// not defined, not copyable
+		ofxLogFormatPool& operator=(ofxLogFormatPool const&);	// not defined, not assignable
+};
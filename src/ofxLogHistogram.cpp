@@ -0,0 +1,133 @@
+#include "ofxLogHistogram.h"
+
+#include <cmath>
+
+static const unsigned int s_subCount = 1 << ofxLogHistogram::s_subBits;
+
+// index of the highest set bit, value > 0
+static inline unsigned int highestBit(uint64_t value)
+{
+	#if defined(__GNUC__)
+		return 63-__builtin_clzll(value);
+	#else
+		unsigned int bit = 0;
+		while(value >>= 1)
+		{
+			++bit;
+		}
+		return bit;
+	#endif
+}
+
+static inline double toMillis(uint64_t nanos)
+{
+	return nanos/1000000.0;
+}
+
+//--------------------------------------------------------------
+std::string ofxLogHistogram::Stats::toString() const
+{
+	char text[160];
+	snprintf(text, sizeof(text), "n=%llu mean=%.3fms p50=%.3fms p90=%.3fms p99=%.3fms max=%.3fms",
+		(unsigned long long) count, mean, p50, p90, p99, max);
+	return text;
+}
+
+//--------------------------------------------------------------
+ofxLogHistogram::ofxLogHistogram()
+{
+	reset();
+}
+
+void ofxLogHistogram::add(uint64_t nanos)
+{
+	buckets[getBucket(nanos)].fetch_add(1, std::memory_order_relaxed);
+	count.fetch_add(1, std::memory_order_relaxed);
+	sum.fetch_add(nanos, std::memory_order_relaxed);
+
+	uint64_t oldMax = max.load(std::memory_order_relaxed);
+	while(nanos > oldMax && !max.compare_exchange_weak(oldMax, nanos, std::memory_order_relaxed))
+	{
+	}
+}
+
+ofxLogHistogram::Stats ofxLogHistogram::getStats(bool reset)
+{
+	// take the counts, zeroing them as we go when resetting
+	uint32_t counts[s_numBuckets];
+	uint64_t total = 0;
+	for(unsigned int i = 0; i < s_numBuckets; ++i)
+	{
+		counts[i] = reset ? buckets[i].exchange(0, std::memory_order_relaxed) :
+							buckets[i].load(std::memory_order_relaxed);
+		total += counts[i];
+	}
+	uint64_t totalSum = reset ? sum.exchange(0, std::memory_order_relaxed) : sum.load(std::memory_order_relaxed);
+	uint64_t maxNanos = reset ? max.exchange(0, std::memory_order_relaxed) : max.load(std::memory_order_relaxed);
+	if(reset)
+	{
+		count.exchange(0, std::memory_order_relaxed);
+	}
+
+	Stats stats;
+	stats.count = total;
+	stats.mean = total > 0 ? toMillis(totalSum)/total : 0;
+	stats.max = toMillis(maxNanos);
+
+	// walk the buckets to the rank of each percentile
+	const double percentiles[3] = {0.5, 0.9, 0.99};
+	double* values[3] = {&stats.p50, &stats.p90, &stats.p99};
+	uint64_t seen = 0;
+	unsigned int bucket = 0;
+	for(unsigned int p = 0; p < 3; ++p)
+	{
+		uint64_t rank = (uint64_t) ceil(percentiles[p]*total);
+		while(bucket < s_numBuckets && seen+counts[bucket] < rank)
+		{
+			seen += counts[bucket];
+			++bucket;
+		}
+		*values[p] = total > 0 ? std::min(toMillis(getBucketValue(bucket)), stats.max) : 0;
+	}
+	return stats;
+}
+
+void ofxLogHistogram::reset()
+{
+	for(unsigned int i = 0; i < s_numBuckets; ++i)
+	{
+		buckets[i].store(0, std::memory_order_relaxed);
+	}
+	count.store(0, std::memory_order_relaxed);
+	sum.store(0, std::memory_order_relaxed);
+	max.store(0, std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------
+unsigned int ofxLogHistogram::getBucket(uint64_t nanos)
+{
+	if(nanos < s_subCount)
+	{
+		return (unsigned int) nanos;
+	}
+
+	// the power of 2 picks the row, the next bits below the top one the column
+	unsigned int exponent = highestBit(nanos);
+	unsigned int sub = (unsigned int) (nanos >> (exponent-s_subBits)) & (s_subCount-1);
+	unsigned int bucket = ((exponent-s_subBits+1) << s_subBits) + sub;
+	return std::min(bucket, s_numBuckets-1);
+}
+
+uint64_t ofxLogHistogram::getBucketValue(unsigned int bucket)
+{
+	if(bucket < s_subCount)
+	{
+		return bucket;
+	}
+
+	// the middle of the bucket
+	unsigned int exponent = (bucket >> s_subBits)+s_subBits-1;
+	uint64_t sub = bucket & (s_subCount-1);
+	uint64_t width = 1ULL << (exponent-s_subBits);
+	return ((s_subCount+sub) << (exponent-s_subBits)) + width/2;
+}
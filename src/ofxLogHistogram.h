@@ -0,0 +1,66 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <atomic>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogHistogram
+/// \brief a lock-free histogram of durations
+///
+/// Durations in nanoseconds are counted in log-linear buckets: 16 buckets
+/// for each power of 2, so a percentile is within about 6% of the real
+/// value. Any number of threads can add at the same time, adding is an
+/// atomic increment on the bucket plus the count, sum, and max.
+///
+/// Durations from 1ns up to about 36 minutes are counted, longer ones are
+/// counted in the last bucket (the max is still exact).
+///
+class ofxLogHistogram
+{
+	public:
+
+		/// the percentiles of the added durations, in millis
+		struct Stats
+		{
+			uint64_t count;		///< number of durations
+			double mean;
+			double p50;
+			double p90;
+			double p99;
+			double max;
+
+			/// "n=600 mean=1.204ms p50=1.180ms p90=1.410ms p99=2.510ms max=4.102ms"
+			std::string toString() const;
+		};
+
+		ofxLogHistogram();
+
+		/// add a duration
+		void add(uint64_t nanos);
+
+		/// The stats of the durations added so far, reset starts over. Adds
+		/// that happen during a reset are counted in this or the next round.
+		Stats getStats(bool reset=false);
+
+		/// start over
+		void reset();
+
+		static const unsigned int s_subBits = 4;
+		static const unsigned int s_numBuckets = (42-s_subBits)<<s_subBits;	///< up to 2^41 nanos
+
+		/// the bucket of a duration & the duration a bucket stands for
+		static unsigned int getBucket(uint64_t nanos);
+		static uint64_t getBucketValue(unsigned int bucket);
+
+	private:
+
+		std::atomic<uint32_t> buckets[s_numBuckets];
+		std::atomic<uint64_t> count;
+		std::atomic<uint64_t> sum;		///< in nanos
+		std::atomic<uint64_t> max;		///< in nanos
+
+		ofxLogHistogram(ofxLogHistogram const&);				// not defined, not copyable
+		ofxLogHistogram& operator=(ofxLogHistogram const&);	// not defined, not assignable
+};
@@ -0,0 +1,170 @@
+#include "ofxLogPattern.h"
+
+#include "ofxLogRecord.h"
+
+#include <Poco/LocalDateTime.h>
+
+const char* const ofxLogPattern::s_levelNames[OF_LOG_SILENT] =
+	{"verbose", "notice", "warning", "error", "fatal"};
+const char* const ofxLogPattern::s_levelPrefixes[OF_LOG_SILENT] =
+	{"OF_VERBOSE: ", "", "OF_WARNING: ", "OF_ERROR: ", "OF_FATAL_ERROR: "};
+
+// the local time of the last second formatted on this thread
+struct ofxLogLocalTime
+{
+	ofxLogLocalTime() : second(-1) {}
+
+	Poco::Timestamp::TimeVal second;	///< seconds since the epoch
+	int year, month, day;
+	int hour, minute, sec;
+};
+
+static thread_local ofxLogLocalTime t_localTime;
+
+// converts to local time when the second changes
+static const ofxLogLocalTime& localTime(const Poco::Timestamp& time)
+{
+	ofxLogLocalTime& local = t_localTime;
+	Poco::Timestamp::TimeVal second = time.epochMicroseconds()/Poco::Timestamp::resolution();
+	if(second != local.second)
+	{
+		Poco::LocalDateTime date(Poco::Timestamp(second*Poco::Timestamp::resolution()));
+		local.second = second;
+		local.year = date.year();
+		local.month = date.month();
+		local.day = date.day();
+		local.hour = date.hour();
+		local.minute = date.minute();
+		local.sec = date.second();
+	}
+	return local;
+}
+
+// appends a zero padded number
+static inline void appendPadded(ofxLogBuffer& buffer, int value, int width)
+{
+	char digits[8];
+	for(int i = width-1; i >= 0; --i)
+	{
+		digits[i] = '0'+(char)(value % 10);
+		value /= 10;
+	}
+	buffer.append(digits, width);
+}
+
+//--------------------------------------------------------------
+ofxLogPattern::ofxLogPattern(const std::string& pattern)
+{
+	this->pattern = pattern;
+	bTime = false;
+
+	std::size_t i = 0;
+	while(i < pattern.size())
+	{
+		std::size_t percent = pattern.find('%', i);
+		if(percent == std::string::npos || percent+1 == pattern.size())
+		{
+			_addLiteral(pattern.data()+i, pattern.size()-i);
+			break;
+		}
+		_addLiteral(pattern.data()+i, percent-i);
+		i = percent+2;
+
+		Op op;
+		op.start = 0;
+		op.size = 0;
+		switch(pattern[percent+1])
+		{
+			case 'Y': op.type = OP_YEAR;			bTime = true; break;
+			case 'm': op.type = OP_MONTH;			bTime = true; break;
+			case 'd': op.type = OP_DAY;				bTime = true; break;
+			case 'H': op.type = OP_HOUR;			bTime = true; break;
+			case 'M': op.type = OP_MINUTE;			bTime = true; break;
+			case 'S': op.type = OP_SECOND;			bTime = true; break;
+			case 'i': op.type = OP_MILLISECOND;		bTime = true; break;
+			case 't': op.type = OP_MESSAGE;			break;
+			case 'L': op.type = OP_LEVEL_NAME;		break;
+			case 'l': op.type = OP_LEVEL_PREFIX;	break;
+			case 'T': op.type = OP_TOPIC;			break;
+			case 'P': op.type = OP_TOPIC_PREFIX;	break;
+			case 'F': op.type = OP_FRAME_NUM;		break;
+			case 'E': op.type = OP_ELAPSED_MILLIS;	break;
+			case 'R': op.type = OP_THREAD;			break;
+
+			case '%':
+				_addLiteral("%", 1);
+				continue;
+
+			default: // unknown, print it as is
+				_addLiteral(pattern.data()+percent, 2);
+				continue;
+		}
+		ops.push_back(op);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLogPattern::format(ofxLogBuffer& line, ofLogLevel level, const std::string& topic,
+						   const char* message, std::size_t size, const Poco::Timestamp& time,
+						   int frameNum, unsigned long millis, unsigned int threadId) const
+{
+	if(level < 0 || level >= OF_LOG_SILENT)
+	{
+		level = OF_LOG_FATAL_ERROR;
+	}
+
+	const ofxLogLocalTime* local = bTime ? &localTime(time) : NULL;
+	for(std::size_t i = 0; i < ops.size(); ++i)
+	{
+		const Op& op = ops[i];
+		switch(op.type)
+		{
+			case OP_LITERAL:		line.append(literals.data()+op.start, op.size); break;
+			case OP_YEAR:			appendPadded(line, local->year, 4); break;
+			case OP_MONTH:			appendPadded(line, local->month, 2); break;
+			case OP_DAY:			appendPadded(line, local->day, 2); break;
+			case OP_HOUR:			appendPadded(line, local->hour, 2); break;
+			case OP_MINUTE:			appendPadded(line, local->minute, 2); break;
+			case OP_SECOND:			appendPadded(line, local->sec, 2); break;
+			case OP_MILLISECOND:
+				appendPadded(line, (int) (time.epochMicroseconds() % Poco::Timestamp::resolution())/1000, 3);
+				break;
+			case OP_MESSAGE:		line.append(message, size); break;
+			case OP_LEVEL_NAME:		line.append(s_levelNames[level]); break;
+			case OP_LEVEL_PREFIX:	line.append(s_levelPrefixes[level]); break;
+			case OP_TOPIC:			line.append(topic); break;
+			case OP_TOPIC_PREFIX:
+				if(!topic.empty())
+				{
+					line.append(topic);
+					line.append(": ", 2);
+				}
+				break;
+			case OP_FRAME_NUM:		line.append(frameNum); break;
+			case OP_ELAPSED_MILLIS:	line.append(millis); break;
+			case OP_THREAD:			line.append(threadId); break;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLogPattern::_addLiteral(const char* text, std::size_t size)
+{
+	if(size == 0)
+	{
+		return;
+	}
+	if(!ops.empty() && ops.back().type == OP_LITERAL)
+	{
+		ops.back().size += size;
+	}
+	else
+	{
+		Op op;
+		op.type = OP_LITERAL;
+		op.start = literals.size();
+		op.size = size;
+		ops.push_back(op);
+	}
+	literals.append(text, size);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include "ofxLogBuffer.h"
+
+#include <Poco/RefCountedObject.h>
+#include <Poco/Timestamp.h>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogPattern
+/// \brief a line layout compiled once into a list of formatting ops
+///
+/// The pattern is parsed when it's set into a flat list of ops: literal text
+/// and fields, each appended straight into the line buffer when a line is
+/// formatted. Nothing is parsed or concatenated per line & the local time is
+/// only converted once a second per thread.
+///
+/// Fields:
+///
+///	%Y year (4 digits)		%m month (01-12)		%d day (01-31)
+///	%H hour (00-23)			%M minute (00-59)		%S second (00-59)
+///	%i millisecond (000-999)
+///
+///	%t the message
+///	%L level name: verbose, notice, warning, error, fatal
+///	%l level prefix as ofxLogger always printed it: "OF_WARNING: ", etc,
+///	   nothing for notice
+///	%T topic
+///	%P topic prefix: "topic: ", nothing if there's no topic
+///	%F frame num
+///	%E elapsed millis
+///	%R thread id (see ofxLogRecord::currentThreadId())
+///	%% a '%'
+///
+/// The date & time codes follow Poco::DateTimeFormatter, so the message is %t
+/// (as in Poco::PatternFormatter) & %m is the month. Unknown codes are printed
+/// as they are.
+///
+/// Patterns are immutable & reference counted so a logger can swap in a new
+/// one while other threads are formatting with the old one.
+///
+class ofxLogPattern : public Poco::RefCountedObject
+{
+	public:
+
+		/// compile a pattern, ie. "%Y-%m-%d %H:%M:%S.%i %l%P%t"
+		ofxLogPattern(const std::string& pattern);
+
+		/// the pattern as it was set
+		const std::string& getPattern() const {return pattern;}
+
+		/// does the pattern use the date or time?
+		bool usesTime() const {return bTime;}
+
+		/// append a formatted line
+		void format(ofxLogBuffer& line, ofLogLevel level, const std::string& topic,
+					const char* message, std::size_t size, const Poco::Timestamp& time,
+					int frameNum, unsigned long millis, unsigned int threadId) const;
+
+		/// level names for %L & prefixes for %l, plain strings so they're
+		/// still there for the lines logged during static destruction
+		static const char* const s_levelNames[OF_LOG_SILENT];
+		static const char* const s_levelPrefixes[OF_LOG_SILENT];
+
+	protected:
+
+		~ofxLogPattern() {}
+
+	private:
+
+		enum OpType
+		{
+			OP_LITERAL,
+			OP_YEAR,
+			OP_MONTH,
+			OP_DAY,
+			OP_HOUR,
+			OP_MINUTE,
+			OP_SECOND,
+			OP_MILLISECOND,
+			OP_MESSAGE,
+			OP_LEVEL_NAME,
+			OP_LEVEL_PREFIX,
+			OP_TOPIC,
+			OP_TOPIC_PREFIX,
+			OP_FRAME_NUM,
+			OP_ELAPSED_MILLIS,
+			OP_THREAD
+		};
+
+		struct Op
+		{
+			OpType type;
+			std::size_t start;	///< literal text in literals
+			std::size_t size;
+		};
+
+		/// adds literal text, merged with the previous literal
+		void _addLiteral(const char* text, std::size_t size);
+
+		std::string pattern;	///< the source pattern
+		std::string literals;	///< the literal text of all the ops
+		std::vector<Op> ops;	///< the compiled pattern
+		bool bTime;				///< any date or time fields?
+
+		ofxLogPattern(ofxLogPattern const&);				// not defined, not copyable
+		ofxLogPattern& operator=(ofxLogPattern const&);	// not defined, not assignable
+};
@@ -0,0 +1,436 @@
+#include "ofxLogPool.h"
+
+#include <Poco/Mutex.h>
+
+#include <atomic>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+struct ofxLogThreadPool;
+
+// The header in front of each block, 16 bytes so the data after it is
+// aligned. A free block keeps the next free block in its first data bytes.
+struct alignas(16) ofxLogPoolBlock
+{
+	ofxLogThreadPool* owner;	///< the pool it was carved from, NULL for heap blocks
+	uint32_t sizeClass;			///< s_numClasses for heap blocks
+	uint32_t requested;			///< bytes asked for, for the stats
+};
+
+static ofxLogPoolBlock*& nextBlock(ofxLogPoolBlock* block)
+{
+	return *(ofxLogPoolBlock**) (block+1);
+}
+
+// A thread's pool. Everything but remoteFrees is only touched by the thread
+// that owns the pool, the counters are atomics only so getStats() can read
+// them, they are written without read-modify-write.
+//
+// The counters only ever grow & count what the owning thread did: the blocks
+// it allocated & the blocks it freed, whichever pool they belong to. A free is
+// counted when free() is called, not when the block gets back to its pool, so
+// the stats are right while blocks sit in a batch or on a parked pool.
+struct ofxLogThreadPool
+{
+	ofxLogThreadPool() : remoteFrees(NULL), numAllocs(0), numFrees(0), numRemoteFrees(0),
+		numSlabs(0), bytesAllocated(0), bytesFreed(0), requestedAllocated(0), requestedFreed(0)
+	{
+		for(unsigned int i = 0; i < ofxLogPool::s_numClasses; ++i)
+		{
+			freeLists[i] = NULL;
+		}
+		slab = NULL;
+		slabLeft = 0;
+		batchOwner = NULL;
+		batchHead = NULL;
+		batchTail = NULL;
+		batchSize = 0;
+	}
+
+	ofxLogPoolBlock* freeLists[ofxLogPool::s_numClasses];
+	std::atomic<ofxLogPoolBlock*> remoteFrees;	///< pushed by other threads, taken all at once
+
+	char* slab;				///< the slab being carved up
+	std::size_t slabLeft;	///< bytes left in the slab
+
+	// blocks freed on this thread that belong to another pool
+	ofxLogThreadPool* batchOwner;
+	ofxLogPoolBlock* batchHead;
+	ofxLogPoolBlock* batchTail;
+	unsigned int batchSize;
+
+	std::atomic<uint64_t> numAllocs;
+	std::atomic<uint64_t> numFrees;
+	std::atomic<uint64_t> numRemoteFrees;
+	std::atomic<uint64_t> numSlabs;
+	std::atomic<uint64_t> bytesAllocated;		///< size class bytes
+	std::atomic<uint64_t> bytesFreed;
+	std::atomic<uint64_t> requestedAllocated;	///< bytes asked for
+	std::atomic<uint64_t> requestedFreed;
+};
+
+// all the pools, never freed so blocks can be returned during static
+// destruction & from threads exiting after main
+struct ofxLogPoolRegistry
+{
+	Poco::FastMutex mutex;
+	std::vector<ofxLogThreadPool*> pools;
+	std::vector<ofxLogThreadPool*> parked;	///< pools of exited threads
+};
+
+static ofxLogPoolRegistry& registry()
+{
+	static ofxLogPoolRegistry* registry = new ofxLogPoolRegistry;
+	return *registry;
+}
+
+// counted outside the thread pools as they're rare
+static std::atomic<uint64_t> s_numHeapAllocs(0);
+static std::atomic<uint64_t> s_numLateFrees(0);	///< freed by a thread that has exited
+static std::atomic<uint64_t> s_lateBytesFreed(0);
+static std::atomic<uint64_t> s_lateRequestedFreed(0);
+
+//--------------------------------------------------------------
+// single writer counters, no locked instructions needed
+static inline void add(std::atomic<uint64_t>& counter, uint64_t n)
+{
+	counter.store(counter.load(std::memory_order_relaxed)+n, std::memory_order_relaxed);
+}
+
+static inline std::size_t classSize(unsigned int sizeClass)
+{
+	return ofxLogPool::s_minClassSize << sizeClass;
+}
+
+// the smallest class that fits a block, s_numClasses if none does
+static inline unsigned int sizeClassFor(std::size_t blockSize)
+{
+	unsigned int sizeClass = 0;
+	while(sizeClass < ofxLogPool::s_numClasses && classSize(sizeClass) < blockSize)
+	{
+		sizeClass++;
+	}
+	return sizeClass;
+}
+
+//--------------------------------------------------------------
+// hands a chain of blocks back to their pool with one atomic push
+static void pushRemote(ofxLogThreadPool* owner, ofxLogPoolBlock* head, ofxLogPoolBlock* tail)
+{
+	ofxLogPoolBlock* top = owner->remoteFrees.load(std::memory_order_relaxed);
+	do
+	{
+		nextBlock(tail) = top;
+	}
+	while(!owner->remoteFrees.compare_exchange_weak(top, head,
+		std::memory_order_release, std::memory_order_relaxed));
+}
+
+static void flushBatch(ofxLogThreadPool* pool)
+{
+	if(pool->batchSize == 0)
+	{
+		return;
+	}
+	pushRemote(pool->batchOwner, pool->batchHead, pool->batchTail);
+	pool->batchOwner = NULL;
+	pool->batchHead = NULL;
+	pool->batchTail = NULL;
+	pool->batchSize = 0;
+}
+
+// puts a block back on its own pool's free list
+static inline void freeLocal(ofxLogThreadPool* pool, ofxLogPoolBlock* block)
+{
+	nextBlock(block) = pool->freeLists[block->sizeClass];
+	pool->freeLists[block->sizeClass] = block;
+}
+
+// counts a free on the thread doing it
+static inline void countFree(ofxLogThreadPool* pool, ofxLogPoolBlock* block)
+{
+	add(pool->numFrees, 1);
+	add(pool->bytesFreed, classSize(block->sizeClass));
+	add(pool->requestedFreed, block->requested);
+}
+
+// takes the blocks other threads have given back
+static void drainRemote(ofxLogThreadPool* pool)
+{
+	ofxLogPoolBlock* block = pool->remoteFrees.exchange(NULL, std::memory_order_acquire);
+	while(block)
+	{
+		ofxLogPoolBlock* next = nextBlock(block);
+		freeLocal(pool, block);
+		block = next;
+	}
+}
+
+// cuts a new block from the slab, starting a new slab if needed
+static ofxLogPoolBlock* carve(ofxLogThreadPool* pool, unsigned int sizeClass)
+{
+	std::size_t size = classSize(sizeClass);
+	if(pool->slabLeft < size)
+	{
+		// the end of the slab goes to the smaller classes, it's always a
+		// multiple of the smallest class size
+		for(unsigned int c = sizeClass; c-- > 0;)
+		{
+			if(pool->slabLeft >= classSize(c))
+			{
+				ofxLogPoolBlock* rest = (ofxLogPoolBlock*) pool->slab;
+				rest->owner = pool;
+				rest->sizeClass = c;
+				nextBlock(rest) = pool->freeLists[c];
+				pool->freeLists[c] = rest;
+				pool->slab += classSize(c);
+				pool->slabLeft -= classSize(c);
+			}
+		}
+
+		pool->slab = (char*) malloc(ofxLogPool::s_slabSize);
+		if(!pool->slab)
+		{
+			pool->slabLeft = 0;
+			return NULL;
+		}
+		pool->slabLeft = ofxLogPool::s_slabSize;
+		add(pool->numSlabs, 1);
+	}
+
+	ofxLogPoolBlock* block = (ofxLogPoolBlock*) pool->slab;
+	block->owner = pool;
+	block->sizeClass = sizeClass;
+	pool->slab += size;
+	pool->slabLeft -= size;
+	return block;
+}
+
+//--------------------------------------------------------------
+// parks the thread's pool when the thread exits
+struct ofxLogPoolHandle
+{
+	ofxLogPoolHandle() : pool(NULL), bExited(false) {}
+
+	~ofxLogPoolHandle()
+	{
+		if(!pool)
+		{
+			bExited = true;
+			return;
+		}
+		// hand our batch back & take what's been given back to us so the
+		// parked pool's free lists are complete
+		flushBatch(pool);
+		drainRemote(pool);
+		ofxLogPoolRegistry& pools = registry();
+		Poco::FastMutex::ScopedLock lock(pools.mutex);
+		pools.parked.push_back(pool);
+		pool = NULL;
+		bExited = true;
+	}
+
+	ofxLogThreadPool* pool;
+	bool bExited;	///< the thread is exiting, don't start a new pool
+};
+
+static thread_local ofxLogPoolHandle t_handle;
+
+// the calling thread's pool, NULL once the thread is exiting
+static inline ofxLogThreadPool* threadPool()
+{
+	ofxLogPoolHandle& handle = t_handle;
+	if(handle.pool || handle.bExited)
+	{
+		return handle.pool;
+	}
+
+	ofxLogPoolRegistry& pools = registry();
+	Poco::FastMutex::ScopedLock lock(pools.mutex);
+	if(!pools.parked.empty())
+	{
+		handle.pool = pools.parked.back();
+		pools.parked.pop_back();
+	}
+	else
+	{
+		handle.pool = new ofxLogThreadPool;
+		pools.pools.push_back(handle.pool);
+	}
+	return handle.pool;
+}
+
+//--------------------------------------------------------------
+void* ofxLogPool::allocate(std::size_t size)
+{
+	std::size_t blockSize = size+sizeof(ofxLogPoolBlock);
+	unsigned int sizeClass = sizeClassFor(blockSize);
+	ofxLogThreadPool* pool = sizeClass < s_numClasses ? threadPool() : NULL;
+
+	ofxLogPoolBlock* block = NULL;
+	if(pool)
+	{
+		block = pool->freeLists[sizeClass];
+		if(!block)
+		{
+			drainRemote(pool);
+			block = pool->freeLists[sizeClass];
+		}
+		if(block)
+		{
+			pool->freeLists[sizeClass] = nextBlock(block);
+		}
+		else
+		{
+			block = carve(pool, sizeClass);
+		}
+	}
+
+	if(block)
+	{
+		add(pool->numAllocs, 1);
+		add(pool->bytesAllocated, classSize(sizeClass));
+		add(pool->requestedAllocated, size);
+	}
+	else
+	{
+		// too big, or the thread is exiting
+		block = (ofxLogPoolBlock*) malloc(blockSize);
+		if(!block)
+		{
+			throw std::bad_alloc();
+		}
+		block->owner = NULL;
+		block->sizeClass = s_numClasses;
+		s_numHeapAllocs.fetch_add(1, std::memory_order_relaxed);
+	}
+	block->requested = (uint32_t) size;
+	return block+1;
+}
+
+void ofxLogPool::free(void* p)
+{
+	if(!p)
+	{
+		return;
+	}
+
+	ofxLogPoolBlock* block = (ofxLogPoolBlock*) p-1;
+	ofxLogThreadPool* owner = block->owner;
+	if(!owner)
+	{
+		::free(block);
+		return;
+	}
+
+	ofxLogThreadPool* pool = threadPool();
+	if(pool == owner)
+	{
+		countFree(pool, block);
+		freeLocal(pool, block);
+		return;
+	}
+
+	if(!pool)
+	{
+		// the thread is exiting, give the block straight back
+		s_numLateFrees.fetch_add(1, std::memory_order_relaxed);
+		s_lateBytesFreed.fetch_add(classSize(block->sizeClass), std::memory_order_relaxed);
+		s_lateRequestedFreed.fetch_add(block->requested, std::memory_order_relaxed);
+		pushRemote(owner, block, block);
+		return;
+	}
+
+	countFree(pool, block);
+
+	// collect blocks for the same owner, frees usually come in runs from
+	// the same producer
+	if(pool->batchOwner != owner)
+	{
+		flushBatch(pool);
+		pool->batchOwner = owner;
+		pool->batchTail = block;
+	}
+	nextBlock(block) = pool->batchHead;
+	pool->batchHead = block;
+	pool->batchSize++;
+	add(pool->numRemoteFrees, 1);
+	if(pool->batchSize >= s_batchSize)
+	{
+		flushBatch(pool);
+	}
+}
+
+//--------------------------------------------------------------
+ofxLogPool::Stats ofxLogPool::getStats()
+{
+	Stats stats;
+	uint64_t bytesAllocated = 0, bytesFreed = s_lateBytesFreed.load(std::memory_order_relaxed);
+	uint64_t requestedAllocated = 0, requestedFreed = s_lateRequestedFreed.load(std::memory_order_relaxed);
+	uint64_t numLateFrees = s_numLateFrees.load(std::memory_order_relaxed);
+	ofxLogPoolRegistry& pools = registry();
+	Poco::FastMutex::ScopedLock lock(pools.mutex);
+	for(unsigned int i = 0; i < pools.pools.size(); ++i)
+	{
+		const ofxLogThreadPool* pool = pools.pools[i];
+		stats.numAllocs += pool->numAllocs.load(std::memory_order_relaxed);
+		stats.numFrees += pool->numFrees.load(std::memory_order_relaxed);
+		stats.numRemoteFrees += pool->numRemoteFrees.load(std::memory_order_relaxed);
+		stats.numSlabs += pool->numSlabs.load(std::memory_order_relaxed);
+		bytesAllocated += pool->bytesAllocated.load(std::memory_order_relaxed);
+		bytesFreed += pool->bytesFreed.load(std::memory_order_relaxed);
+		requestedAllocated += pool->requestedAllocated.load(std::memory_order_relaxed);
+		requestedFreed += pool->requestedFreed.load(std::memory_order_relaxed);
+	}
+	stats.numFrees += numLateFrees;
+	stats.numRemoteFrees += numLateFrees;
+
+	// the counters are read one after the other while other threads carry
+	// on, a free may be counted before its alloc
+	stats.bytesInUse = bytesAllocated > bytesFreed ? bytesAllocated-bytesFreed : 0;
+	stats.bytesRequested = requestedAllocated > requestedFreed ? requestedAllocated-requestedFreed : 0;
+	stats.numHeapAllocs = s_numHeapAllocs.load(std::memory_order_relaxed);
+	stats.bytesReserved = stats.numSlabs*s_slabSize;
+	stats.numPools = pools.pools.size();
+	stats.numParked = pools.parked.size();
+	return stats;
+}
+
+//--------------------------------------------------------------
+ofxLogPool::Stats::Stats()
+{
+	numAllocs = 0;
+	numFrees = 0;
+	numRemoteFrees = 0;
+	numHeapAllocs = 0;
+	numSlabs = 0;
+	bytesReserved = 0;
+	bytesInUse = 0;
+	bytesRequested = 0;
+	numPools = 0;
+	numParked = 0;
+}
+
+double ofxLogPool::Stats::getFragmentation() const
+{
+	if(bytesReserved == 0)
+	{
+		return 0;
+	}
+	return 1.0-(double) bytesRequested/bytesReserved;
+}
+
+std::string ofxLogPool::Stats::toString() const
+{
+	char text[256];
+	snprintf(text, sizeof(text),
+		"log pool: %llu allocs, %llu frees (%llu remote), %llu heap allocs, "
+		"%llu KB reserved, %llu KB in use, %.1f%% fragmentation, %u pools (%u parked)",
+		(unsigned long long) numAllocs, (unsigned long long) numFrees,
+		(unsigned long long) numRemoteFrees, (unsigned long long) numHeapAllocs,
+		(unsigned long long) bytesReserved/1024, (unsigned long long) bytesInUse/1024,
+		getFragmentation()*100, numPools, numParked);
+	return text;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogPool
+/// \brief a per thread block pool for log records & their text
+///
+/// Log records, their message & line, and long ofxLogBuffer lines are carved
+/// out of this pool instead of coming from the general heap, so once an app
+/// is warmed up logging doesn't call malloc & doesn't contend with the app's
+/// own threads for the heap lock.
+///
+/// Each thread that logs gets its own pool with a free list per size class
+/// (64 bytes up to 8 KB). Blocks are carved from 64 KB slabs which are never
+/// given back, a freed block goes back to the free list of the pool it came
+/// from:
+///
+/// - freed on the thread that allocated it: straight onto its free list
+/// - freed on another thread (a listener that kept the record, a sink
+///   thread, etc): collected in a small batch on the freeing thread & handed
+///   back to the owner all at once with a single atomic push, the owner picks
+///   the batch up the next time one of its free lists runs empty
+///
+/// A thread's pool outlives the thread: when it exits, its pool (with all its
+/// free blocks) is parked & the next new thread that logs adopts it, so apps
+/// that create short lived threads don't keep growing.
+///
+/// Blocks bigger than the largest size class come from the heap & are
+/// counted in the stats, as are all the allocations & the bytes reserved vs
+/// in use, see getStats().
+///
+class ofxLogPool
+{
+	public:
+
+		/// Get a block of at least size bytes, aligned for any type. Never
+		/// returns NULL.
+		static void* allocate(std::size_t size);
+
+		/// Give a block back, can be called from any thread. NULL is ignored.
+		static void free(void* p);
+
+		/// pool counters, summed over all the thread pools
+		struct Stats
+		{
+			uint64_t numAllocs;			///< blocks handed out
+			uint64_t numFrees;			///< blocks given back, counted when freed
+			uint64_t numRemoteFrees;	///< blocks given back by another thread
+			uint64_t numHeapAllocs;		///< allocations too big for a size class
+			uint64_t numSlabs;			///< slabs carved up so far
+			uint64_t bytesReserved;		///< slab bytes taken from the heap
+			uint64_t bytesInUse;		///< size class bytes handed out & not freed yet
+			uint64_t bytesRequested;	///< bytes asked for by the blocks in use
+			unsigned int numPools;		///< thread pools, live or parked
+			unsigned int numParked;		///< pools of exited threads waiting to be adopted
+
+			Stats();
+
+			/// Fraction of the reserved bytes not holding requested data: free
+			/// blocks, rounding up to the size class, & slab ends too small to
+			/// use. 0 is none, goes toward 1 as the pool gets emptier.
+			double getFragmentation() const;
+
+			/// a one line summary for printing
+			std::string toString() const;
+		};
+
+		/// Get a snapshot of the counters. They are updated without locking so
+		/// they may be slightly behind while other threads are logging.
+		static Stats getStats();
+
+		static const unsigned int s_numClasses = 8;		///< 64 bytes ... 8 KB
+		static const std::size_t s_minClassSize = 64;	///< smallest block, header included
+		static const std::size_t s_slabSize = 64*1024;	///< bytes carved at once
+		static const unsigned int s_batchSize = 32;		///< remote frees handed back at once
+
+	private:
+
+		ofxLogPool();	// not defined, static only
+};
@@ -0,0 +1,1009 @@
+#include "ofxLogQuery.h"
+
+#include "ofxLogCompressedFileChannel.h"
+
+#include <Poco/File.h>
+#include <Poco/Path.h>
+#include <Poco/Mutex.h>
+#include <Poco/Thread.h>
+#include <Poco/Runnable.h>
+
+#include <zlib.h>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <set>
+
+#ifndef TARGET_WIN32
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+// size of the blocks in the side index
+static const std::size_t s_indexBlockSize = 64*1024;
+
+static const char s_indexMagic[8] = {'O','F','X','L','G','I','D','X'};
+static const char* s_indexDir = ".ofxLogIndex";	///< next to the logs, not matched by the purge
+static const unsigned int s_indexVersion = 2;
+static const std::size_t s_stampHashSize = 4096;	///< start of the file hashed into the stamp
+
+static const long long s_millisPerDay = 86400000LL;
+
+//--------------------------------------------------------------
+// a block of lines in the side index
+struct IndexBlock
+{
+	unsigned long long offset;		///< start of the first line
+	unsigned long long length;		///< length up to the end of the last line
+	long long minKey, maxKey;		///< date+time range in millis, -1 if no dates
+	int minMillis, maxMillis;		///< time of day range, -1 if no times
+	unsigned int levelMask;			///< bit per ofLogLevel
+	unsigned int pad;
+	unsigned long long topicBloom;	///< bit per topic hash, incl. parent topics
+};
+
+// the index file header
+struct IndexHeader
+{
+	char magic[8];
+	unsigned int version;
+	unsigned int numBlocks;
+	unsigned long long sourceSize;	///< size of the indexed file on disk
+	long long sourceModified;		///< last modified time, epoch micros
+	unsigned int sourceHash;		///< crc32 of the start of the file
+	unsigned int pad;
+};
+
+// what an index is matched to its file by
+struct FileStamp
+{
+	unsigned long long size;
+	long long modified;
+	unsigned int hash;
+};
+
+//--------------------------------------------------------------
+// a file's contents, memory mapped or inflated
+class FileData
+{
+	public:
+
+		FileData() : data(NULL), size(0), bMapped(false) {}
+
+		~FileData()
+		{
+			#ifndef TARGET_WIN32
+				if(bMapped)
+				{
+					munmap((void*) data, size);
+				}
+			#endif
+		}
+
+		bool load(const std::string& path)
+		{
+			if(path.size() > 3 && path.compare(path.size()-3, 3, ".gz") == 0)
+			{
+				return _inflate(path);
+			}
+
+			#ifndef TARGET_WIN32
+				int fd = open(path.c_str(), O_RDONLY);
+				if(fd < 0)
+				{
+					return false;
+				}
+				struct stat info;
+				if(fstat(fd, &info) < 0)
+				{
+					::close(fd);
+					return false;
+				}
+				size = info.st_size;
+				if(size > 0)
+				{
+					void* p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if(p == MAP_FAILED)
+					{
+						::close(fd);
+						return false;
+					}
+					madvise(p, size, MADV_SEQUENTIAL);
+					data = (const char*) p;
+					bMapped = true;
+				}
+				::close(fd);
+				return true;
+			#else
+				std::ifstream file(path.c_str(), std::ios::binary);
+				if(!file.is_open())
+				{
+					return false;
+				}
+				buffer.assign(std::istreambuf_iterator<char>(file),
+							  std::istreambuf_iterator<char>());
+				data = buffer.data();
+				size = buffer.size();
+				return true;
+			#endif
+		}
+
+		const char* data;
+		std::size_t size;
+
+	private:
+
+		// inflate a gzip file, handles concatenated gzip members
+		bool _inflate(const std::string& path)
+		{
+			// files written by ofxLogCompressedFileChannel are inflated block by
+			// block, which skips a last block torn by a crash
+			std::vector<ofxLogCompressedFileChannel::Block> blocks;
+			if(ofxLogCompressedFileChannel::readBlocks(path, blocks) && !blocks.empty())
+			{
+				std::ifstream file(path.c_str(), std::ios::binary);
+				std::string compressed((std::istreambuf_iterator<char>(file)),
+									   std::istreambuf_iterator<char>());
+				for(std::size_t i = 0; i < blocks.size(); ++i)
+				{
+					if(blocks[i].offset+blocks[i].size > compressed.size() ||
+					   !ofxLogCompressedFileChannel::inflateBlock(compressed.data()+blocks[i].offset,
+						   blocks[i].size, buffer))
+					{
+						return false;
+					}
+				}
+				data = buffer.data();
+				size = buffer.size();
+				return true;
+			}
+
+			gzFile file = gzopen(path.c_str(), "rb");
+			if(!file)
+			{
+				return false;
+			}
+			char chunk[64*1024];
+			int num;
+			while((num = gzread(file, chunk, sizeof(chunk))) > 0)
+			{
+				buffer.append(chunk, num);
+			}
+			gzclose(file);
+			data = buffer.data();
+			size = buffer.size();
+			return num == 0;
+		}
+
+		std::string buffer;		///< inflated or read contents
+		bool bMapped;
+
+		FileData(FileData const&);				// not defined, not copyable
+		FileData& operator=(FileData const&);	// not defined, not assignable
+};
+
+//--------------------------------------------------------------
+// the day number of a civil date, from Howard Hinnant's days_from_civil
+static long long daysFromCivil(int y, int m, int d)
+{
+	y -= m <= 2;
+	long long era = (y >= 0 ? y : y-399) / 400;
+	unsigned int yoe = (unsigned int)(y - era * 400);
+	unsigned int doy = (153*(m + (m > 2 ? -3 : 9)) + 2)/5 + d-1;
+	unsigned int doe = yoe * 365 + yoe/4 - yoe/100 + doy;
+	return era * 146097 + (long long) doe - 719468;
+}
+
+// reads num digits, returns -1 if they aren't all digits
+static int readDigits(const char* p, int num)
+{
+	int value = 0;
+	for(int i = 0; i < num; ++i)
+	{
+		if(p[i] < '0' || p[i] > '9')
+		{
+			return -1;
+		}
+		value = value*10 + (p[i]-'0');
+	}
+	return value;
+}
+
+// FNV-1a, picks a bloom bit for a topic
+static unsigned long long topicBit(const char* topic, std::size_t length)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	for(std::size_t i = 0; i < length; ++i)
+	{
+		hash ^= (unsigned char) topic[i];
+		hash *= 1099511628211ULL;
+	}
+	return 1ULL << (hash % 64);
+}
+
+// the bits for a topic and all of its parents ("a.b.c" -> "a", "a.b", "a.b.c")
+static unsigned long long topicBloom(const char* topic, std::size_t length)
+{
+	unsigned long long bits = 0;
+	for(std::size_t i = 0; i < length; ++i)
+	{
+		if(topic[i] == '.')
+		{
+			bits |= topicBit(topic, i);
+		}
+	}
+	return bits | topicBit(topic, length);
+}
+
+static bool isTopicChar(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+		   (c >= '0' && c <= '9') || c == '_' || c == '.' || c == '-';
+}
+
+static bool isArchive(const std::string& path)
+{
+	if(path.size() > 3 && path.compare(path.size()-3, 3, ".gz") == 0)
+	{
+		return true;
+	}
+	std::string ext = Poco::Path(path).getExtension();
+	if(ext.empty())
+	{
+		return false;
+	}
+	for(std::size_t i = 0; i < ext.size(); ++i)
+	{
+		if(ext[i] < '0' || ext[i] > '9')
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+// finds the blocks of a file and what's in them
+static void indexData(const char* data, std::size_t size, std::vector<IndexBlock>& blocks)
+{
+	std::size_t pos = 0;
+	while(pos < size)
+	{
+		IndexBlock block;
+		block.offset = pos;
+		block.minKey = block.maxKey = -1;
+		block.minMillis = block.maxMillis = -1;
+		block.levelMask = 0;
+		block.pad = 0;
+		block.topicBloom = 0;
+		long long firstDay = -1;
+		bool bManyDays = false;
+
+		std::size_t end = std::min(pos+s_indexBlockSize, size);
+		while(pos < size && (pos < end || pos == block.offset))
+		{
+			const char* line = data+pos;
+			const char* newline = (const char*) memchr(line, '\n', size-pos);
+			std::size_t length = newline ? newline-line : size-pos;
+
+			ofxLogQuery::LineInfo info;
+			ofxLogQuery::parseLine(line, length, info);
+
+			block.levelMask |= 1 << info.level;
+			if(info.topic)
+			{
+				block.topicBloom |= topicBloom(info.topic, info.topicLength);
+			}
+			if(info.millis >= 0)
+			{
+				if(block.minMillis < 0 || info.millis < block.minMillis)
+				{
+					block.minMillis = info.millis;
+				}
+				if(info.millis > block.maxMillis)
+				{
+					block.maxMillis = info.millis;
+				}
+			}
+			if(info.day >= 0)
+			{
+				long long key = info.day*s_millisPerDay + std::max(info.millis, 0);
+				if(block.minKey < 0 || key < block.minKey)
+				{
+					block.minKey = key;
+				}
+				if(key > block.maxKey)
+				{
+					block.maxKey = key;
+				}
+				if(firstDay < 0)
+				{
+					firstDay = info.day;
+				}
+				else if(info.day != firstDay)
+				{
+					bManyDays = true;
+				}
+			}
+
+			pos += length + (newline ? 1 : 0);
+		}
+
+		// the time of day range is meaningless across midnight
+		if(bManyDays)
+		{
+			block.minMillis = 0;
+			block.maxMillis = s_millisPerDay-1;
+		}
+
+		block.length = pos-block.offset;
+		blocks.push_back(block);
+	}
+}
+
+// the size & modified time alone can be shared by two logs in the same
+// folder (ie. the main log & a route log rotated together), the hash of the
+// first block tells them apart & still survives a rename
+static bool getFileStamp(const std::string& path, FileStamp& stamp)
+{
+	try
+	{
+		Poco::File file(path);
+		stamp.size = file.getSize();
+		stamp.modified = file.getLastModified().epochMicroseconds();
+	}
+	catch(Poco::Exception& e)
+	{
+		return false;
+	}
+
+	std::ifstream in(path.c_str(), std::ios::binary);
+	if(!in.is_open())
+	{
+		return false;
+	}
+	char head[s_stampHashSize];
+	in.read(head, sizeof(head));
+	stamp.hash = crc32(0L, (const Bytef*) head, (uInt) in.gcount());
+	return true;
+}
+
+// removes the indexes of files that are no longer in the directory, ie.
+// archives that were purged
+static void pruneIndexes(const std::string& path)
+{
+	try
+	{
+		Poco::Path dir = Poco::Path(path).parent();
+		std::vector<std::string> names;
+		Poco::File(dir).list(names);
+		std::set<std::string> current;
+		for(std::size_t i = 0; i < names.size(); ++i)
+		{
+			std::string indexPath = ofxLogQuery::getIndexPath(Poco::Path(dir, names[i]).toString());
+			if(!indexPath.empty())
+			{
+				current.insert(Poco::Path(indexPath).getFileName());
+			}
+		}
+
+		Poco::Path indexDir(dir);
+		indexDir.pushDirectory(s_indexDir);
+		std::vector<std::string> indexes;
+		Poco::File(indexDir).list(indexes);
+		for(std::size_t i = 0; i < indexes.size(); ++i)
+		{
+			if(current.find(indexes[i]) == current.end())
+			{
+				Poco::File(Poco::Path(indexDir, indexes[i])).remove();
+			}
+		}
+	}
+	catch(Poco::Exception& e)
+	{
+		// a stale index is only wasted space
+	}
+}
+
+static bool writeIndex(const std::string& path, const std::vector<IndexBlock>& blocks)
+{
+	IndexHeader header;
+	memcpy(header.magic, s_indexMagic, sizeof(header.magic));
+	header.version = s_indexVersion;
+	header.numBlocks = blocks.size();
+	header.pad = 0;
+	FileStamp stamp;
+	if(!getFileStamp(path, stamp))
+	{
+		return false;
+	}
+	header.sourceSize = stamp.size;
+	header.sourceModified = stamp.modified;
+	header.sourceHash = stamp.hash;
+
+	// write to a temp file & rename so a reader never sees half an index
+	std::string indexPath = ofxLogQuery::getIndexPath(path);
+	if(indexPath.empty())
+	{
+		return false;
+	}
+	try
+	{
+		Poco::File(Poco::Path(indexPath).parent()).createDirectories();
+	}
+	catch(Poco::Exception& e)
+	{
+		return false;
+	}
+	std::string tempPath = indexPath+".tmp";
+	{
+		std::ofstream file(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+		if(!file.is_open())
+		{
+			return false;
+		}
+		file.write((const char*) &header, sizeof(header));
+		if(!blocks.empty())
+		{
+			file.write((const char*) &blocks[0], sizeof(IndexBlock)*blocks.size());
+		}
+		if(!file.good())
+		{
+			return false;
+		}
+	}
+	if(rename(tempPath.c_str(), indexPath.c_str()) != 0)
+	{
+		return false;
+	}
+	pruneIndexes(path);
+	return true;
+}
+
+// returns false if there is no index or it's out of date
+static bool readIndex(const std::string& path, std::vector<IndexBlock>& blocks)
+{
+	std::ifstream file(ofxLogQuery::getIndexPath(path).c_str(), std::ios::binary);
+	if(!file.is_open())
+	{
+		return false;
+	}
+
+	IndexHeader header;
+	file.read((char*) &header, sizeof(header));
+	if(!file.good() || memcmp(header.magic, s_indexMagic, sizeof(header.magic)) != 0 ||
+	   header.version != s_indexVersion)
+	{
+		return false;
+	}
+
+	FileStamp stamp;
+	if(!getFileStamp(path, stamp) || stamp.size != header.sourceSize ||
+	   stamp.modified != header.sourceModified || stamp.hash != header.sourceHash)
+	{
+		return false;
+	}
+
+	blocks.resize(header.numBlocks);
+	if(header.numBlocks > 0)
+	{
+		file.read((char*) &blocks[0], sizeof(IndexBlock)*header.numBlocks);
+	}
+	return file.good();
+}
+
+//--------------------------------------------------------------
+// searches files from a shared list until there are none left
+class ofxLogQueryWorker : public Poco::Runnable
+{
+	public:
+
+		ofxLogQueryWorker(ofxLogQuery& query, const std::vector<std::string>& files,
+						  std::vector<std::vector<ofxLogQuery::Match> >& results,
+						  Poco::FastMutex& mutex, std::size_t& next) :
+			query(query), files(files), results(results), mutex(mutex), next(next) {}
+
+		void run()
+		{
+			while(true)
+			{
+				std::size_t i;
+				{
+					Poco::FastMutex::ScopedLock lock(mutex);
+					if(next >= files.size())
+					{
+						return;
+					}
+					i = next++;
+				}
+				query._searchFile(files[i], isArchive(files[i]), results[i]);
+			}
+		}
+
+	private:
+
+		ofxLogQuery& query;
+		const std::vector<std::string>& files;
+		std::vector<std::vector<ofxLogQuery::Match> >& results;
+		Poco::FastMutex& mutex;
+		std::size_t& next;
+};
+
+//--------------------------------------------------------------
+ofxLogQuery::ofxLogQuery()
+{
+	minLevel = OF_LOG_VERBOSE;
+	fromDay = untilDay = -1;
+	fromMillis = untilMillis = -1;
+	numThreads = 0;
+	bWriteIndexes = true;
+}
+
+//--------------------------------------------------------------
+void ofxLogQuery::setMinLevel(ofLogLevel level)
+{
+	minLevel = level;
+}
+
+void ofxLogQuery::setTopic(const std::string& topic)
+{
+	this->topic = topic;
+}
+
+bool ofxLogQuery::setFrom(const std::string& time)
+{
+	if(time.empty())
+	{
+		fromDay = -1;
+		fromMillis = -1;
+		return true;
+	}
+	if(!parseTime(time, fromDay, fromMillis))
+	{
+		return false;
+	}
+	if(fromMillis < 0)
+	{
+		fromMillis = 0;	// start of the day
+	}
+	return true;
+}
+
+bool ofxLogQuery::setUntil(const std::string& time)
+{
+	if(time.empty())
+	{
+		untilDay = -1;
+		untilMillis = -1;
+		return true;
+	}
+	if(!parseTime(time, untilDay, untilMillis))
+	{
+		return false;
+	}
+	if(untilMillis < 0)
+	{
+		untilMillis = s_millisPerDay-1;	// end of the day
+	}
+	else if(time.find('.') == std::string::npos)
+	{
+		// "14:05" includes everything up to 14:05:59.999, "14:05:30" up to .999
+		int colons = std::count(time.begin(), time.end(), ':');
+		untilMillis += colons == 1 ? 59999 : 999;
+	}
+	return true;
+}
+
+void ofxLogQuery::setText(const std::string& text)
+{
+	this->text = text;
+}
+
+void ofxLogQuery::setNumThreads(unsigned int num)
+{
+	numThreads = num;
+}
+
+void ofxLogQuery::setWriteIndexes(bool write)
+{
+	bWriteIndexes = write;
+}
+
+//--------------------------------------------------------------
+std::vector<ofxLogQuery::Match> ofxLogQuery::search(const std::vector<std::string>& files)
+{
+	std::vector<std::vector<Match> > results(files.size());
+
+	unsigned int num = numThreads;
+	if(num == 0)
+	{
+		num = std::max(1u, std::thread::hardware_concurrency());
+	}
+	num = std::min<std::size_t>(num, files.size());
+
+	Poco::FastMutex mutex;
+	std::size_t next = 0;
+	ofxLogQueryWorker worker(*this, files, results, mutex, next);
+
+	// the calling thread works too
+	std::vector<Poco::Thread*> threads;
+	for(unsigned int i = 1; i < num; ++i)
+	{
+		threads.push_back(new Poco::Thread);
+		threads.back()->start(worker);
+	}
+	worker.run();
+	for(unsigned int i = 0; i < threads.size(); ++i)
+	{
+		threads[i]->join();
+		delete threads[i];
+	}
+
+	std::vector<Match> matches;
+	for(std::size_t i = 0; i < results.size(); ++i)
+	{
+		matches.insert(matches.end(), results[i].begin(), results[i].end());
+	}
+	return matches;
+}
+
+//--------------------------------------------------------------
+std::vector<std::string> ofxLogQuery::findArchives(const std::string& logPath)
+{
+	Poco::Path path(logPath);
+	std::string name = path.getFileName();
+	std::string dir = path.parent().toString();
+
+	std::vector<std::string> names;
+	try
+	{
+		Poco::File(dir.empty() ? "." : dir).list(names);
+	}
+	catch(Poco::Exception& e)
+	{
+		names.clear();
+	}
+
+	// archives are named "log.N" (N=0 is the newest) or "log.YYYYMMDDHHMMSSmmm",
+	// optionally gzipped
+	std::vector<std::pair<std::string, std::string> > archives; // sort key, path
+	for(std::size_t i = 0; i < names.size(); ++i)
+	{
+		const std::string& archive = names[i];
+		if(archive.size() <= name.size()+1 || archive.compare(0, name.size(), name) != 0 ||
+		   archive[name.size()] != '.')
+		{
+			continue;
+		}
+		std::string suffix = archive.substr(name.size()+1);
+		if(suffix.size() > 3 && suffix.compare(suffix.size()-3, 3, ".gz") == 0)
+		{
+			suffix.resize(suffix.size()-3);
+		}
+		if(suffix.empty() || suffix.find_first_not_of("0123456789") != std::string::npos)
+		{
+			continue;
+		}
+
+		std::string key;
+		if(suffix.size() < 10)
+		{
+			// numbers count up with age, pad & invert so the oldest sorts first
+			char padded[16];
+			snprintf(padded, sizeof(padded), "0%09u", 999999999u-(unsigned int) atoi(suffix.c_str()));
+			key = padded;
+		}
+		else
+		{
+			key = "1"+suffix; // timestamps sort as is, after numbers
+		}
+		archives.push_back(std::make_pair(key, Poco::Path(dir, archive).toString()));
+	}
+	std::sort(archives.begin(), archives.end());
+
+	std::vector<std::string> files;
+	for(std::size_t i = 0; i < archives.size(); ++i)
+	{
+		files.push_back(archives[i].second);
+	}
+	if(Poco::File(logPath).exists())
+	{
+		files.push_back(logPath);
+	}
+	return files;
+}
+
+bool ofxLogQuery::buildIndex(const std::string& file)
+{
+	FileData data;
+	if(!data.load(file))
+	{
+		return false;
+	}
+	std::vector<IndexBlock> blocks;
+	indexData(data.data, data.size, blocks);
+	return writeIndex(file, blocks);
+}
+
+std::string ofxLogQuery::getIndexPath(const std::string& file)
+{
+	// keyed by the size, modified time & hash of the first block, which a
+	// rename (the number rotation moves log.N to log.N+1) keeps
+	FileStamp stamp;
+	if(!getFileStamp(file, stamp))
+	{
+		return "";
+	}
+	char name[64];
+	snprintf(name, sizeof(name), "%llx-%llx-%08x.idx", stamp.size,
+			 (unsigned long long) stamp.modified, stamp.hash);
+
+	Poco::Path path = Poco::Path(file).parent();
+	path.pushDirectory(s_indexDir);
+	path.setFileName(name);
+	return path.toString();
+}
+
+//--------------------------------------------------------------
+void ofxLogQuery::parseLine(const char* line, std::size_t length, LineInfo& info)
+{
+	info.day = -1;
+	info.millis = -1;
+	info.level = OF_LOG_NOTICE;
+	info.topic = NULL;
+	info.topicLength = 0;
+
+	const char* p = line;
+	const char* end = line+length;
+
+	// YYYY-MM-DD
+	if(end-p >= 11 && p[4] == '-' && p[7] == '-' && p[10] == ' ')
+	{
+		int y = readDigits(p, 4), m = readDigits(p+5, 2), d = readDigits(p+8, 2);
+		if(y >= 0 && m >= 1 && m <= 12 && d >= 1 && d <= 31)
+		{
+			info.day = daysFromCivil(y, m, d);
+			p += 11;
+		}
+	}
+
+	// HH:MM:SS.mmm
+	if(end-p >= 13 && p[2] == ':' && p[5] == ':' && p[8] == '.' && p[12] == ' ')
+	{
+		int h = readDigits(p, 2), m = readDigits(p+3, 2), s = readDigits(p+6, 2), ms = readDigits(p+9, 3);
+		if(h >= 0 && m >= 0 && s >= 0 && ms >= 0)
+		{
+			info.millis = ((h*60 + m)*60 + s)*1000 + ms;
+			p += 13;
+		}
+	}
+
+	// frame num & elapsed millis, only looked for after a date or time as a
+	// message could start with a number
+	if(info.day >= 0 || info.millis >= 0)
+	{
+		for(int i = 0; i < 2; ++i)
+		{
+			const char* q = p;
+			while(q < end && *q >= '0' && *q <= '9')
+			{
+				q++;
+			}
+			if(q == p || q == end || *q != ' ')
+			{
+				break;
+			}
+			p = q+1;
+		}
+	}
+
+	// level prefix, notice doesn't have one
+	static const struct { const char* prefix; std::size_t length; ofLogLevel level; } levels[] = {
+		{"OF_VERBOSE: ", 12, OF_LOG_VERBOSE},
+		{"OF_WARNING: ", 12, OF_LOG_WARNING},
+		{"OF_ERROR: ", 10, OF_LOG_ERROR},
+		{"OF_FATAL_ERROR: ", 16, OF_LOG_FATAL_ERROR}
+	};
+	if(end-p > 3 && p[0] == 'O' && p[1] == 'F' && p[2] == '_')
+	{
+		for(int i = 0; i < 4; ++i)
+		{
+			if((std::size_t)(end-p) >= levels[i].length &&
+			   memcmp(p, levels[i].prefix, levels[i].length) == 0)
+			{
+				info.level = levels[i].level;
+				p += levels[i].length;
+				break;
+			}
+		}
+	}
+
+	// "topic: "
+	const char* q = p;
+	while(q < end && isTopicChar(*q))
+	{
+		q++;
+	}
+	if(q > p && end-q >= 2 && q[0] == ':' && q[1] == ' ')
+	{
+		info.topic = p;
+		info.topicLength = q-p;
+	}
+}
+
+bool ofxLogQuery::parseTime(const std::string& time, long long& day, int& millis)
+{
+	const char* p = time.c_str();
+	const char* end = p+time.size();
+	day = -1;
+	millis = -1;
+
+	if(end-p >= 10 && p[4] == '-' && p[7] == '-')
+	{
+		int y = readDigits(p, 4), m = readDigits(p+5, 2), d = readDigits(p+8, 2);
+		if(y < 0 || m < 1 || m > 12 || d < 1 || d > 31)
+		{
+			return false;
+		}
+		day = daysFromCivil(y, m, d);
+		p += 10;
+		while(p < end && (*p == ' ' || *p == 'T'))
+		{
+			p++;
+		}
+		if(p == end)
+		{
+			return true;
+		}
+	}
+
+	// HH:MM[:SS[.mmm]]
+	if(end-p < 5 || p[2] != ':')
+	{
+		return false;
+	}
+	int h = readDigits(p, 2), m = readDigits(p+3, 2), s = 0, ms = 0;
+	p += 5;
+	if(p < end && *p == ':')
+	{
+		if(end-p < 3 || (s = readDigits(p+1, 2)) < 0)
+		{
+			return false;
+		}
+		p += 3;
+		if(p < end && *p == '.')
+		{
+			if(end-p < 4 || (ms = readDigits(p+1, 3)) < 0)
+			{
+				return false;
+			}
+			p += 4;
+		}
+	}
+	if(p != end || h < 0 || h > 23 || m < 0 || m > 59 || s > 59)
+	{
+		return false;
+	}
+	millis = ((h*60 + m)*60 + s)*1000 + ms;
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxLogQuery::_searchFile(const std::string& file, bool bArchive, std::vector<Match>& matches)
+{
+	FileData data;
+	if(!data.load(file))
+	{
+		return;
+	}
+
+	// archives don't change, so their index only has to be built once
+	std::vector<IndexBlock> blocks;
+	if(!bArchive || !readIndex(file, blocks))
+	{
+		blocks.clear();
+		indexData(data.data, data.size, blocks);
+		if(bArchive && bWriteIndexes)
+		{
+			writeIndex(file, blocks);
+		}
+	}
+
+	long long fromKey = fromDay >= 0 ? fromDay*s_millisPerDay + fromMillis : -1;
+	long long untilKey = untilDay >= 0 ? untilDay*s_millisPerDay + untilMillis : -1;
+	unsigned int levelMask = 0;
+	for(int level = minLevel; level <= OF_LOG_FATAL_ERROR; ++level)
+	{
+		levelMask |= 1 << level;
+	}
+	unsigned long long topicMask = topic.empty() ? 0 : topicBit(topic.data(), topic.size());
+
+	for(std::size_t b = 0; b < blocks.size(); ++b)
+	{
+		const IndexBlock& block = blocks[b];
+
+		// skip the blocks that can't have a match
+		if((block.levelMask & levelMask) == 0 ||
+		   (topicMask && (block.topicBloom & topicMask) == 0) ||
+		   (fromKey >= 0 && (block.maxKey < 0 || block.maxKey < fromKey)) ||
+		   (untilKey >= 0 && (block.minKey < 0 || block.minKey > untilKey)) ||
+		   (fromDay < 0 && fromMillis >= 0 && (block.maxMillis < 0 || block.maxMillis < fromMillis)) ||
+		   (untilDay < 0 && untilMillis >= 0 && (block.minMillis < 0 || block.minMillis > untilMillis)))
+		{
+			continue;
+		}
+
+		std::size_t pos = block.offset;
+		std::size_t end = std::min<std::size_t>(block.offset+block.length, data.size);
+		while(pos < end)
+		{
+			const char* line = data.data+pos;
+			const char* newline = (const char*) memchr(line, '\n', end-pos);
+			std::size_t length = newline ? newline-line : end-pos;
+
+			if(_matches(line, length))
+			{
+				Match match;
+				match.file = file;
+				match.offset = pos;
+				match.line.assign(line, length);
+				matches.push_back(match);
+			}
+			pos += length + (newline ? 1 : 0);
+		}
+	}
+}
+
+bool ofxLogQuery::_matches(const char* line, std::size_t length)
+{
+	LineInfo info;
+	parseLine(line, length, info);
+
+	if(info.level < minLevel)
+	{
+		return false;
+	}
+
+	if(!topic.empty())
+	{
+		if(!info.topic || info.topicLength < topic.size() ||
+		   memcmp(info.topic, topic.data(), topic.size()) != 0 ||
+		   (info.topicLength > topic.size() && info.topic[topic.size()] != '.'))
+		{
+			return false;
+		}
+	}
+
+	if(fromDay >= 0 || untilDay >= 0)
+	{
+		if(info.day < 0)
+		{
+			return false;
+		}
+		long long key = info.day*s_millisPerDay + std::max(info.millis, 0);
+		if((fromDay >= 0 && key < fromDay*s_millisPerDay + fromMillis) ||
+		   (untilDay >= 0 && key > untilDay*s_millisPerDay + untilMillis))
+		{
+			return false;
+		}
+	}
+	if((fromDay < 0 && fromMillis >= 0) || (untilDay < 0 && untilMillis >= 0))
+	{
+		if(info.millis < 0 ||
+		   (fromDay < 0 && fromMillis >= 0 && info.millis < fromMillis) ||
+		   (untilDay < 0 && untilMillis >= 0 && info.millis > untilMillis))
+		{
+			return false;
+		}
+	}
+
+	if(!text.empty() &&
+	   std::search(line, line+length, text.begin(), text.end()) == line+length)
+	{
+		return false;
+	}
+
+	return true;
+}
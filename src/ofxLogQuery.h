@@ -0,0 +1,134 @@
+#pragma once
+
+#include "ofMain.h"
+
+//------------------------------------------------------------------------------
+/// \class ofxLogQuery
+/// \brief searches log files & their rotated archives
+///
+/// ofxLogQuery reads the lines written by ofxLogger, parses the optional
+/// header (date, time, frame num, millis), log level, and log topic of each
+/// line and returns the ones that match:
+///
+///		ofxLogQuery query;
+///		query.setMinLevel(OF_LOG_ERROR);
+///		query.setTopic("net");		// "net" & "net.*"
+///		query.setFrom("14:00");
+///		query.setUntil("14:05");
+///		vector<ofxLogQuery::Match> matches =
+///			query.search(ofxLogQuery::findArchives(ofToDataPath("openframeworks.log")));
+///
+/// Files are memory mapped (gzipped archives & compressed logs written by
+/// ofxLogCompressedFileChannel are inflated into memory) and
+/// searched in parallel, one file per thread.
+///
+/// Rotated archives don't change, so a sparse side index is written for each
+/// the first time it's searched. The indexes are kept in a ".ofxLogIndex"
+/// folder next to the logs, named by the archive's size, modified time &
+/// a hash of its first 4KB so they still match after the number rotation
+/// renames the archive but not another log that happens to share the size
+/// & time, and don't count towards the rotation's purgeCount. The index keeps the time
+/// range, levels, and topics of each ~64KB block of lines, so blocks that
+/// can't match are skipped without being read. The live log file is always
+/// scanned.
+///
+/// Lines without a time (the header was disabled) never match a time range.
+///
+class ofxLogQuery
+{
+	public:
+
+		/// a matching line
+		struct Match
+		{
+			std::string file;		///< the file it was found in
+			std::size_t offset;		///< byte offset of the line in the (inflated) file
+			std::string line;		///< the line without the newline
+		};
+
+		/// the parsed prefix of a line
+		struct LineInfo
+		{
+			long long day;			///< days since 1970-01-01, -1 if no date
+			int millis;				///< millis since midnight, -1 if no time
+			ofLogLevel level;		///< log level, OF_LOG_NOTICE if no level prefix
+			const char* topic;		///< start of the topic, NULL if no topic
+			std::size_t topicLength;
+		};
+
+		ofxLogQuery();
+
+		/// \section Filters
+
+		/// only match lines at this log level or above (default OF_LOG_VERBOSE)
+		void setMinLevel(ofLogLevel level);
+
+		/// only match this topic & its children, empty matches all (default)
+		void setTopic(const std::string& topic);
+
+		/// Only match lines logged at or after / at or before a time. Accepts
+		/// "YYYY-MM-DD", "YYYY-MM-DD HH:MM[:SS[.mmm]]", or "HH:MM[:SS[.mmm]]"
+		/// which matches that time on any day. An empty string clears the
+		/// limit. Returns false if the time couldn't be parsed.
+		bool setFrom(const std::string& time);
+		bool setUntil(const std::string& time);
+
+		/// only match lines containing this text, empty matches all (default)
+		void setText(const std::string& text);
+
+		/// \section Options
+
+		/// max number of files searched at the same time
+		/// (default is the number of cores)
+		void setNumThreads(unsigned int num);
+
+		/// Write an index for each archive that doesn't have a valid one.
+		/// (default true)
+		void setWriteIndexes(bool write);
+
+		/// \section Search
+
+		/// Search the files, matches are returned in the order of the files
+		/// and their lines.
+		std::vector<Match> search(const std::vector<std::string>& files);
+
+		/// Returns the rotated archives of a log file, oldest first, followed by
+		/// the log file itself. Handles number & timestamp suffixes and
+		/// gzipped archives.
+		static std::vector<std::string> findArchives(const std::string& logPath);
+
+		/// Write the index for a file, returns false on error.
+		static bool buildIndex(const std::string& file);
+
+		/// the index path for a file, from its size, modified time & a hash of
+		/// its first block, empty if the file doesn't exist
+		static std::string getIndexPath(const std::string& file);
+
+		/// parse the header, level & topic at the start of a line
+		static void parseLine(const char* line, std::size_t length, LineInfo& info);
+
+		/// parse a query time, returns false on error
+		/// day is -1 for a time without a date
+		static bool parseTime(const std::string& time, long long& day, int& millis);
+
+	protected:
+
+		/// searches one file
+		void _searchFile(const std::string& file, bool bArchive, std::vector<Match>& matches);
+
+		/// does a parsed line match the filters?
+		bool _matches(const char* line, std::size_t length);
+
+		ofLogLevel minLevel;
+		std::string topic;
+		long long fromDay, untilDay;	///< -1 for any day
+		int fromMillis, untilMillis;	///< -1 for no limit
+		std::string text;
+
+		unsigned int numThreads;
+		bool bWriteIndexes;
+
+	private:
+
+		friend class ofxLogQueryWorker;
+};
@@ -0,0 +1,218 @@
+#include "ofxLogRecord.h"
+
+#include <Poco/Mutex.h>
+
+#include <new>
+
+// interned topic names, a deque keeps the names in place as it grows
+struct ofxLogTopicTable
+{
+	ofxLogTopicTable() : names(1) {}	// 0 is the empty topic
+
+	Poco::FastMutex mutex;
+	std::deque<std::string> names;
+	std::map<std::string, unsigned int> ids;
+};
+
+// a function static so it's there for loggers used during static init,
+// never freed so the records written after main (ie. by a sink the shutdown
+// gave up on) can still read their topic names
+static ofxLogTopicTable& topicTable()
+{
+	static ofxLogTopicTable* table = new ofxLogTopicTable;
+	return *table;
+}
+
+static std::atomic<unsigned int> s_nextThreadId(1);
+
+//--------------------------------------------------------------
+ofxLogRecord::ofxLogRecord(ofLogLevel level, unsigned int topicId, const std::string& topic,
+	const Poco::Timestamp& time, int frameNum, unsigned long millis) :
+	refCount(1), time(time), clock(std::chrono::steady_clock::now())
+{
+	this->level = level;
+	this->priority = toPriority(level);
+	this->topicId = topicId;
+	this->topic = &topic;
+	this->threadId = currentThreadId();
+	this->frameNum = frameNum;
+	this->millis = millis;
+	this->site = NULL;
+	this->lineCapacity = 0;
+	this->lineBlock = NULL;
+	bLine.store(true, std::memory_order_relaxed);
+}
+
+ofxLogRecord::~ofxLogRecord()
+{
+	ofxLogPool::free(lineBlock);
+}
+
+ofxLogRecord* ofxLogRecord::create(ofLogLevel level, unsigned int topicId, const std::string& topic,
+	const char* message, std::size_t messageSize, const char* line, std::size_t lineSize,
+	const Poco::Timestamp& time, int frameNum, unsigned long millis, const ofxLogSite* site)
+{
+	// one block: the record, the message & the line, each null terminated
+	void* block = ofxLogPool::allocate(sizeof(ofxLogRecord)+messageSize+1+lineSize+1);
+	ofxLogRecord* record = new (block) ofxLogRecord(level, topicId, topic, time, frameNum, millis);
+	record->site = site;
+
+	char* text = (char*) (record+1);
+	memcpy(text, message, messageSize);
+	text[messageSize] = '\0';
+	record->message = text;
+	record->messageSize = messageSize;
+
+	text += messageSize+1;
+	memcpy(text, line, lineSize);
+	text[lineSize] = '\0';
+	record->line = text;
+	record->lineSize = lineSize;
+	return record;
+}
+
+ofxLogRecord* ofxLogRecord::create(const Poco::Message& msg)
+{
+	const std::string& text = msg.getText();
+	unsigned int topicId = internTopic(msg.getSource());
+
+	void* block = ofxLogPool::allocate(sizeof(ofxLogRecord)+text.size()+1);
+	ofxLogRecord* record = new (block) ofxLogRecord(toLevel(msg.getPriority()), topicId,
+		getTopicName(topicId), msg.getTime(), ofGetFrameNum(), ofGetElapsedTimeMillis());
+	record->priority = msg.getPriority();
+
+	// the line is the message, they share the text
+	char* copy = (char*) (record+1);
+	memcpy(copy, text.c_str(), text.size()+1);
+	record->message = copy;
+	record->messageSize = text.size();
+	record->line = copy;
+	record->lineSize = text.size();
+	return record;
+}
+
+ofxLogRecord* ofxLogRecord::createUnformatted(ofLogLevel level, unsigned int topicId,
+	const std::string& topic, const char* message, std::size_t messageSize,
+	std::size_t lineCapacity, const Poco::Timestamp& time, int frameNum,
+	unsigned long millis, const ofxLogSite* site)
+{
+	// one block: the record, the message & the room for the line
+	void* block = ofxLogPool::allocate(sizeof(ofxLogRecord)+messageSize+1+lineCapacity+1);
+	ofxLogRecord* record = new (block) ofxLogRecord(level, topicId, topic, time, frameNum, millis);
+	record->site = site;
+
+	char* text = (char*) (record+1);
+	memcpy(text, message, messageSize);
+	text[messageSize] = '\0';
+	record->message = text;
+	record->messageSize = messageSize;
+
+	text += messageSize+1;
+	text[0] = '\0';
+	record->line = text;
+	record->lineSize = 0;
+	record->lineCapacity = lineCapacity;
+	record->bLine.store(false, std::memory_order_relaxed);
+	return record;
+}
+
+void ofxLogRecord::setLine(const char* line, std::size_t lineSize)
+{
+	char* text = const_cast<char*>(this->line);
+	if(lineSize > lineCapacity)
+	{
+		lineBlock = ofxLogPool::allocate(lineSize+1);
+		text = (char*) lineBlock;
+	}
+	memcpy(text, line, lineSize);
+	text[lineSize] = '\0';
+	this->line = text;
+	this->lineSize = lineSize;
+	bLine.store(true, std::memory_order_release);
+}
+
+//--------------------------------------------------------------
+unsigned int ofxLogRecord::internTopic(const std::string& topic)
+{
+	if(topic.empty())
+	{
+		return 0;
+	}
+	ofxLogTopicTable& table = topicTable();
+	Poco::FastMutex::ScopedLock lock(table.mutex);
+	std::map<std::string, unsigned int>::iterator iter = table.ids.find(topic);
+	if(iter != table.ids.end())
+	{
+		return iter->second;
+	}
+	unsigned int id = table.names.size();
+	table.names.push_back(topic);
+	table.ids[topic] = id;
+	return id;
+}
+
+const std::string& ofxLogRecord::getTopicName(unsigned int topicId)
+{
+	ofxLogTopicTable& table = topicTable();
+	Poco::FastMutex::ScopedLock lock(table.mutex);
+	if(topicId >= table.names.size())
+	{
+		return table.names[0];
+	}
+	return table.names[topicId];
+}
+
+unsigned int ofxLogRecord::currentThreadId()
+{
+	static thread_local unsigned int threadId = 0;
+	if(threadId == 0)
+	{
+		threadId = s_nextThreadId.fetch_add(1, std::memory_order_relaxed);
+	}
+	return threadId;
+}
+
+//--------------------------------------------------------------
+int ofxLogRecord::toPriority(ofLogLevel level)
+{
+	switch(level)
+	{
+		case OF_LOG_VERBOSE:
+			return Poco::Message::PRIO_TRACE;
+
+		case OF_LOG_NOTICE:
+			return Poco::Message::PRIO_NOTICE;
+
+		case OF_LOG_WARNING:
+			return Poco::Message::PRIO_WARNING;
+
+		case OF_LOG_ERROR:
+			return Poco::Message::PRIO_ERROR;
+
+		default:
+			return Poco::Message::PRIO_FATAL;
+	}
+}
+
+ofLogLevel ofxLogRecord::toLevel(int priority)
+{
+	switch(priority)
+	{
+		case Poco::Message::PRIO_FATAL:
+			return OF_LOG_FATAL_ERROR;
+
+		case Poco::Message::PRIO_CRITICAL:
+		case Poco::Message::PRIO_ERROR:
+			return OF_LOG_ERROR;
+
+		case Poco::Message::PRIO_WARNING:
+			return OF_LOG_WARNING;
+
+		case Poco::Message::PRIO_NOTICE:
+		case Poco::Message::PRIO_INFORMATION:
+			return OF_LOG_NOTICE;
+
+		default:
+			return OF_LOG_VERBOSE;
+	}
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include "ofxLogPool.h"
+
+#include <Poco/Message.h>
+#include <Poco/Timestamp.h>
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+
+class ofxLogSite;
+
+//------------------------------------------------------------------------------
+/// \class ofxLogText
+/// \brief a read only string kept inside a log record
+///
+/// Converts to a std::string (a copy) where one is needed, use data() & size()
+/// to read it without copying.
+///
+class ofxLogText
+{
+	public:
+
+		ofxLogText(const char* text, std::size_t size) : text(text), textLength(size) {}
+
+		const char* data() const	{return text;}
+		const char* c_str() const	{return text;}		///< always null terminated
+		std::size_t size() const	{return textLength;}
+		std::size_t length() const	{return textLength;}		///< same as size(), like std::string
+		bool empty() const			{return textLength == 0;}
+
+		std::string str() const		{return std::string(text, textLength);}
+		operator std::string() const	{return str();}
+
+	private:
+
+		const char* text;
+		std::size_t textLength;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const ofxLogText& text)
+{
+	return os.write(text.data(), text.size());
+}
+
+//------------------------------------------------------------------------------
+/// \class ofxLogRecord
+/// \brief a single logged message, shared by all sinks & listeners
+///
+/// A record is built once per log call and then only read: the channels,
+/// the event listeners, and the flight recorder all get a reference to the
+/// same record instead of their own copy of the message. The printed line
+/// (header, log level, topic & message) is built once when the record is
+/// created, unless the record is below the log level & won't be printed.
+///
+/// Records are reference counted with an atomic counter and work with
+/// Poco::AutoPtr, a new record starts with a count of 1:
+///
+///		Poco::AutoPtr<ofxLogRecord> record(ofxLogRecord::create(...));
+///
+/// A record & its text are one block from the log pool (see ofxLogPool), so
+/// creating & releasing records doesn't use the general heap.
+///
+/// Topic names are interned, so a record only points at its topic name and
+/// topics can be compared by id.
+///
+class ofxLogRecord
+{
+	public:
+
+		/// Create a record, the message & line are copied in. The topic must
+		/// be the interned name of the topic id (see getTopicName()). Pass an
+		/// empty line if the record won't be printed & the static site if the
+		/// message was logged from one.
+		static ofxLogRecord* create(ofLogLevel level, unsigned int topicId, const std::string& topic,
+			const char* message, std::size_t messageSize, const char* line, std::size_t lineSize,
+			const Poco::Timestamp& time, int frameNum, unsigned long millis,
+			const ofxLogSite* site=NULL);
+
+		/// create a record for a message logged through the Poco API
+		static ofxLogRecord* create(const Poco::Message& msg);
+
+		/// Create a record whose line is built after it's logged (see
+		/// ofxLogFormatPool), with room for a line of lineCapacity bytes. The
+		/// line reads as empty until setLine() is called.
+		static ofxLogRecord* createUnformatted(ofLogLevel level, unsigned int topicId,
+			const std::string& topic, const char* message, std::size_t messageSize,
+			std::size_t lineCapacity, const Poco::Timestamp& time, int frameNum,
+			unsigned long millis, const ofxLogSite* site=NULL);
+
+		/// Set the line of a record made with createUnformatted(), once. It's
+		/// copied into the room kept for it, or into a block from the log pool
+		/// if it's longer. Other threads reading the record see no line or the
+		/// whole line, never part of it.
+		void setLine(const char* line, std::size_t lineSize);
+
+		/// \section Access
+
+		ofLogLevel getLevel() const					{return level;}
+		int getPriority() const						{return priority;}		///< the Poco::Message priority
+		unsigned int getTopicId() const				{return topicId;}		///< 0 for no topic
+		const std::string& getTopic() const			{return *topic;}		///< "" for no topic
+		const Poco::Timestamp& getTime() const		{return time;}
+		std::chrono::steady_clock::time_point getClock() const	{return clock;}	///< when it was logged on the steady clock, to line up with ofxLogScope timings
+		unsigned int getThreadId() const			{return threadId;}		///< see currentThreadId()
+		int getFrameNum() const						{return frameNum;}
+		unsigned long getMillis() const				{return millis;}		///< elapsed millis
+		ofxLogText getMessage() const				{return ofxLogText(message, messageSize);}	///< the message as logged
+		ofxLogText getLine() const;		///< the line as printed, no newline, empty if below the log level or not built yet
+		const ofxLogSite* getSite() const			{return site;}			///< the static site (file, line, format, etc), NULL if not logged from one
+
+		/// \section Reference Counting
+
+		void duplicate() const
+		{
+			refCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void release() const
+		{
+			if(refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				this->~ofxLogRecord();
+				ofxLogPool::free(const_cast<ofxLogRecord*>(this));
+			}
+		}
+
+		int referenceCount() const
+		{
+			return refCount.load(std::memory_order_relaxed);
+		}
+
+		/// \section Topics & Threads
+
+		/// Returns the id of a topic name, adding it if it's new. Ids are never
+		/// reused, the empty topic is 0.
+		static unsigned int internTopic(const std::string& topic);
+
+		/// the name of an interned topic, the reference stays valid
+		static const std::string& getTopicName(unsigned int topicId);
+
+		/// a small number identifying the calling thread, 1 for the first
+		/// thread that logs, 2 for the next, etc
+		static unsigned int currentThreadId();
+
+		/// convert between OF levels & Poco priorities
+		static int toPriority(ofLogLevel level);
+		static ofLogLevel toLevel(int priority);
+
+	private:
+
+		ofxLogRecord(ofLogLevel level, unsigned int topicId, const std::string& topic,
+			const Poco::Timestamp& time, int frameNum, unsigned long millis);
+		~ofxLogRecord();
+
+		mutable std::atomic<int> refCount;
+
+		ofLogLevel level;
+		int priority;
+		unsigned int topicId;
+		const std::string* topic;	///< interned name, never freed
+		Poco::Timestamp time;
+		std::chrono::steady_clock::time_point clock;	///< doesn't jump with the wall clock
+		unsigned int threadId;
+		int frameNum;
+		unsigned long millis;
+		const char* message;		///< stored after the record
+		std::size_t messageSize;
+		const char* line;			///< stored after the message, or in lineBlock
+		std::size_t lineSize;
+		std::size_t lineCapacity;	///< room for the line after the message
+		void* lineBlock;			///< a line too long for its room, from the log pool
+		std::atomic<bool> bLine;	///< is the line set? see setLine()
+		const ofxLogSite* site;		///< never freed
+
+		ofxLogRecord(ofxLogRecord const&);				// not defined, not copyable
+		ofxLogRecord& operator=(ofxLogRecord const&);	// not defined, not assignable
+};
+
+inline ofxLogText ofxLogRecord::getLine() const
+{
+	if(!bLine.load(std::memory_order_acquire))
+	{
+		return ofxLogText("", 0);
+	}
+	return ofxLogText(line, lineSize);
+}
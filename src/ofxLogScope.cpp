@@ -0,0 +1,199 @@
+#include "ofxLogScope.h"
+
+#include "ofxLogger.h"
+#include "ofxLogTraceChannel.h"
+
+#include <Poco/Mutex.h>
+#include <Poco/Thread.h>
+#include <Poco/Runnable.h>
+#include <Poco/Event.h>
+
+#include <stdint.h>
+
+static const unsigned int s_cacheSize = 64;		// per thread, a power of 2
+static const unsigned int s_cacheProbes = 4;
+
+// logs the reports every few seconds
+class ofxLogScopeReporter : public Poco::Runnable
+{
+	public:
+		ofxLogScopeReporter() : seconds(0), bRunning(false) {}
+		void run()
+		{
+			while(!stopEvent.tryWait(seconds*1000))
+			{
+				ofxLogScope::report();
+			}
+		}
+
+		unsigned int seconds;
+		bool bRunning;			///< guarded by the registry mutex
+		Poco::Thread thread;
+		Poco::Event stopEvent;
+};
+
+// the histograms by name, never freed so scopes in static destructors &
+// threads exiting after main still have somewhere to go
+struct ofxLogScopeRegistry
+{
+	Poco::FastMutex mutex;
+	std::map<std::string, ofxLogHistogram*> histograms;
+	ofxLogScopeReporter reporter;
+};
+
+static ofxLogScopeRegistry& scopeRegistry()
+{
+	static ofxLogScopeRegistry* registry = new ofxLogScopeRegistry;
+	return *registry;
+}
+
+// the histograms this thread has used, by name address
+struct ofxLogScopeCache
+{
+	const char* names[s_cacheSize];
+	ofxLogHistogram* histograms[s_cacheSize];
+};
+
+static thread_local ofxLogScopeCache t_scopeCache;
+
+// the histogram of a name & the name as the table keeps it
+static ofxLogHistogram* findHistogram(const std::string& name, const char*& tableName)
+{
+	ofxLogScopeRegistry& registry = scopeRegistry();
+	Poco::FastMutex::ScopedLock lock(registry.mutex);
+	std::map<std::string, ofxLogHistogram*>::iterator iter = registry.histograms.find(name);
+	if(iter == registry.histograms.end())
+	{
+		iter = registry.histograms.insert(std::make_pair(name, new ofxLogHistogram)).first;
+	}
+	tableName = iter->first.c_str();
+	return iter->second;
+}
+
+static ofxLogHistogram* findHistogram(const char* name)
+{
+	ofxLogScopeCache& cache = t_scopeCache;
+	uintptr_t hash = ((uintptr_t) name >> 3)*2654435761u;
+	for(unsigned int i = 0; i < s_cacheProbes; ++i)
+	{
+		unsigned int slot = (hash+i) & (s_cacheSize-1);
+		if(cache.names[slot] == name)
+		{
+			return cache.histograms[slot];
+		}
+	}
+
+	// first use on this thread, a full neighborhood loses its first slot
+	ofxLogHistogram* histogram = &ofxLogScope::getHistogram(name);
+	unsigned int slot = hash & (s_cacheSize-1);
+	for(unsigned int i = 0; i < s_cacheProbes; ++i)
+	{
+		if(!cache.names[(hash+i) & (s_cacheSize-1)])
+		{
+			slot = (hash+i) & (s_cacheSize-1);
+			break;
+		}
+	}
+	cache.names[slot] = name;
+	cache.histograms[slot] = histogram;
+	return histogram;
+}
+
+//--------------------------------------------------------------
+ofxLogScope::ofxLogScope(const char* name)
+{
+	this->name = name;
+	histogram = findHistogram(name);
+	start = std::chrono::steady_clock::now();
+}
+
+ofxLogScope::ofxLogScope(const std::string& name)
+{
+	histogram = findHistogram(name, this->name);
+	start = std::chrono::steady_clock::now();
+}
+
+ofxLogScope::~ofxLogScope()
+{
+	std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now()-start;
+	histogram->add((uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+	if(ofxLogTraceChannel::isTracing())
+	{
+		ofxLogTraceChannel::traceScope(name, start, duration);
+	}
+}
+
+//--------------------------------------------------------------
+std::vector<ofxLogScope::Stats> ofxLogScope::getStats(bool reset)
+{
+	// the histograms are never removed, copy the table & read them unlocked
+	std::map<std::string, ofxLogHistogram*> histograms;
+	{
+		ofxLogScopeRegistry& registry = scopeRegistry();
+		Poco::FastMutex::ScopedLock lock(registry.mutex);
+		histograms = registry.histograms;
+	}
+
+	std::vector<Stats> stats;
+	for(std::map<std::string, ofxLogHistogram*>::iterator iter = histograms.begin();
+		iter != histograms.end(); ++iter)
+	{
+		Stats scope;
+		scope.name = iter->first;
+		scope.histogram = iter->second->getStats(reset);
+		if(scope.histogram.count > 0)
+		{
+			stats.push_back(scope);
+		}
+	}
+	return stats;
+}
+
+void ofxLogScope::report(bool reset)
+{
+	std::vector<Stats> stats = getStats(reset);
+	for(unsigned int i = 0; i < stats.size(); ++i)
+	{
+		ofxLogger::instance().log(OF_LOG_NOTICE, "scope "+stats[i].name+": "+stats[i].histogram.toString());
+	}
+}
+
+ofxLogHistogram& ofxLogScope::getHistogram(const std::string& name)
+{
+	const char* tableName;
+	return *findHistogram(name, tableName);
+}
+
+//--------------------------------------------------------------
+void ofxLogScope::startReports(unsigned int seconds)
+{
+	stopReports();
+	ofxLogScopeRegistry& registry = scopeRegistry();
+	Poco::FastMutex::ScopedLock lock(registry.mutex);
+	registry.reporter.seconds = std::max(seconds, 1u);
+	registry.reporter.bRunning = true;
+	registry.reporter.stopEvent.reset();
+	registry.reporter.thread.start(registry.reporter);
+}
+
+void ofxLogScope::stopReports()
+{
+	ofxLogScopeRegistry& registry = scopeRegistry();
+	{
+		Poco::FastMutex::ScopedLock lock(registry.mutex);
+		if(!registry.reporter.bRunning)
+		{
+			return;
+		}
+		registry.reporter.bRunning = false;
+	}
+	registry.reporter.stopEvent.set();
+	registry.reporter.thread.join();
+}
+
+bool ofxLogScope::usingReports()
+{
+	ofxLogScopeRegistry& registry = scopeRegistry();
+	Poco::FastMutex::ScopedLock lock(registry.mutex);
+	return registry.reporter.bRunning;
+}
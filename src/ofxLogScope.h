@@ -0,0 +1,76 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include "ofxLogHistogram.h"
+
+#include <chrono>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogScope
+/// \brief times a scope into a histogram instead of logging a line
+///
+/// Measures how long it lives with a monotonic clock & adds the duration to
+/// the histogram of its name:
+///
+///		void drawShadows()
+///		{
+///			ofxLogScope scope("render.shadow");
+///			...
+///		}
+///
+/// Nothing is logged per scope (each scope is written to the timeline while
+/// an ofxLogTraceChannel is open). The percentiles of each name are logged
+/// through the normal ofxLogger sinks by report(), every few seconds with
+/// ofxLogger::enableScopeReports(), and when the app exits:
+///
+///		scope render.shadow: n=600 mean=1.204ms p50=1.180ms p90=1.410ms p99=2.510ms max=4.102ms
+///
+/// The histogram of a name is looked up in a small per thread cache keyed
+/// by the name's address, so a name should be a string literal (or another
+/// string that doesn't change while the app runs). Use the std::string
+/// version for names that are built at runtime, it looks the name up in
+/// the shared table each time.
+///
+class ofxLogScope
+{
+	public:
+
+		ofxLogScope(const char* name);
+		ofxLogScope(const std::string& name);
+
+		/// adds the duration to the histogram
+		~ofxLogScope();
+
+		/// the stats of a scope name
+		struct Stats
+		{
+			std::string name;
+			ofxLogHistogram::Stats histogram;
+		};
+
+		/// The stats of the names with any durations, sorted by name. reset
+		/// starts each histogram over.
+		static std::vector<Stats> getStats(bool reset=false);
+
+		/// Log a line with the percentiles of each name with durations since
+		/// the last reset, then start the histograms over.
+		static void report(bool reset=true);
+
+		/// the histogram of a name, created on first use
+		static ofxLogHistogram& getHistogram(const std::string& name);
+
+		/// Call report() every few seconds on a background thread.
+		static void startReports(unsigned int seconds);
+		static void stopReports();
+		static bool usingReports();
+
+	private:
+
+		const char* name;				///< for the trace, see ofxLogTraceChannel
+		ofxLogHistogram* histogram;
+		std::chrono::steady_clock::time_point start;
+
+		ofxLogScope(ofxLogScope const&);				// not defined, not copyable
+		ofxLogScope& operator=(ofxLogScope const&);	// not defined, not assignable
+};
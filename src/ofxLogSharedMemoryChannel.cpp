@@ -0,0 +1,170 @@
+#include "ofxLogSharedMemoryChannel.h"
+
+#ifndef TARGET_WIN32
+	#include <unistd.h>
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+// the atomics are shared with other processes, they can't hide a lock
+#if ATOMIC_LLONG_LOCK_FREE != 2
+	#error "ofxLogSharedMemoryChannel needs lock free 64 bit atomics"
+#endif
+
+//--------------------------------------------------------------
+ofxLogSharedMemoryChannel::ofxLogSharedMemoryChannel()
+{
+	name = "/ofxLogger";
+	numSlots = 4096;
+	header = NULL;
+	mapSize = 0;
+}
+
+ofxLogSharedMemoryChannel::ofxLogSharedMemoryChannel(const std::string& name)
+{
+	this->name = name;
+	numSlots = 4096;
+	header = NULL;
+	mapSize = 0;
+}
+
+ofxLogSharedMemoryChannel::~ofxLogSharedMemoryChannel()
+{
+	close();
+}
+
+//--------------------------------------------------------------
+void ofxLogSharedMemoryChannel::open()
+{
+	#ifndef TARGET_WIN32
+		if(header)
+		{
+			return;
+		}
+
+		int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0644);
+		if(fd < 0)
+		{
+			return;
+		}
+
+		std::size_t size = sizeof(Header)+numSlots*s_slotSize;
+		struct stat info;
+		bool bResize = fstat(fd, &info) != 0 || (std::size_t) info.st_size != size;
+		if(bResize && ftruncate(fd, size) != 0)
+		{
+			::close(fd);
+			return;
+		}
+
+		void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		::close(fd);
+		if(p == MAP_FAILED)
+		{
+			return;
+		}
+
+		// a segment left by an earlier run with the same layout keeps its
+		// sequence numbers, so a tail that's still attached just keeps going
+		Header* newHeader = (Header*) p;
+		if(bResize || newHeader->magic != s_magic || newHeader->version != s_version ||
+		   newHeader->slotSize != s_slotSize || newHeader->numSlots != numSlots)
+		{
+			memset(p, 0, size);
+			newHeader->version = s_version;
+			newHeader->slotSize = s_slotSize;
+			newHeader->numSlots = numSlots;
+			newHeader->writeSeq.store(0);
+			std::atomic_thread_fence(std::memory_order_release);
+			newHeader->magic = s_magic;
+		}
+
+		header = newHeader;
+		mapSize = size;
+	#endif
+}
+
+void ofxLogSharedMemoryChannel::close()
+{
+	#ifndef TARGET_WIN32
+		if(!header)
+		{
+			return;
+		}
+		munmap(header, mapSize);
+		header = NULL;
+		mapSize = 0;
+	#endif
+}
+
+bool ofxLogSharedMemoryChannel::isOpen()
+{
+	return header != NULL;
+}
+
+//--------------------------------------------------------------
+void ofxLogSharedMemoryChannel::log(const ofxLogRecord& record)
+{
+	if(!header)
+	{
+		return;
+	}
+
+	// claim a slot, the oldest line is overwritten
+	uint64_t seq = header->writeSeq.fetch_add(1, std::memory_order_relaxed);
+	Slot* slot = getSlot(header, seq);
+
+	// odd stamp: readers copying this slot now will throw the copy away
+	slot->stamp.store(seq*2+1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	const std::string& topic = record.getTopic();
+	ofxLogText text = record.getLine();
+	std::size_t topicSize = std::min(topic.size(), (std::size_t) 255);
+	std::size_t textSize = std::min(text.size(), sizeof(slot->data)-topicSize);
+
+	slot->time = record.getTime().epochMicroseconds();
+	slot->priority = (uint8_t) record.getPriority();
+	slot->topicSize = (uint8_t) topicSize;
+	slot->textSize = (uint16_t) textSize;
+	memcpy(slot->data, topic.data(), topicSize);
+	memcpy(slot->data+topicSize, text.data(), textSize);
+
+	// even stamp: done
+	slot->stamp.store(seq*2+2, std::memory_order_release);
+}
+
+//--------------------------------------------------------------
+void ofxLogSharedMemoryChannel::setName(const std::string& name)
+{
+	this->name = name;
+}
+
+std::string ofxLogSharedMemoryChannel::getName()
+{
+	return name;
+}
+
+void ofxLogSharedMemoryChannel::setSize(unsigned int sizeKB)
+{
+	unsigned int wanted = std::max(sizeKB*1024/s_slotSize, 2u);
+	numSlots = 1;
+	while(numSlots < wanted)
+	{
+		numSlots *= 2;
+	}
+}
+
+unsigned int ofxLogSharedMemoryChannel::getSize()
+{
+	return numSlots*s_slotSize/1024;
+}
+
+//--------------------------------------------------------------
+void ofxLogSharedMemoryChannel::remove(const std::string& name)
+{
+	#ifndef TARGET_WIN32
+		shm_unlink(name.c_str());
+	#endif
+}
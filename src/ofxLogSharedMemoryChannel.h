@@ -0,0 +1,117 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include "ofxLogChannel.h"
+
+#include <Poco/Message.h>
+
+#include <atomic>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogSharedMemoryChannel
+/// \brief writes log lines into a ring buffer in shared memory
+///
+/// Each line is copied into the next slot of a fixed size ring in a POSIX
+/// shared memory segment, where a tail tool (see loggerTail) running in
+/// another process can follow it live. Nothing is written to disk or to the
+/// console, so verbose logging can be watched on a running app for about the
+/// cost of a memcpy.
+///
+/// Writers never wait: a slot is claimed with an atomic increment & a line
+/// simply overwrites the oldest one. Each slot has a sequence stamp that is
+/// odd while the slot is being written & even once it's done. A reader
+/// checks the stamp again after copying a slot, and also that the ring
+/// hasn't wrapped onto the slot in the meantime, so a line that was
+/// overwritten while being copied is counted as lost instead of printed
+/// torn. A reader that falls behind by more
+/// than the ring size skips ahead & reports how many lines it lost.
+///
+/// Lines longer than a slot are truncated. The segment stays around after
+/// the app exits so the last lines can still be read, use remove() to delete
+/// it.
+///
+/// Not available on Windows, lines are dropped.
+///
+class ofxLogSharedMemoryChannel : public ofxLogChannel
+{
+	public:
+
+		using ofxLogChannel::log;
+
+		ofxLogSharedMemoryChannel();
+		ofxLogSharedMemoryChannel(const std::string& name);
+
+		/// creates or attaches to the segment
+		void open();
+
+		/// unmaps the segment, it's not removed
+		void close();
+
+		/// is the segment mapped? false if open() failed
+		bool isOpen();
+
+		/// write a line into the ring
+		void log(const ofxLogRecord& record);
+
+		/// Set the segment name, must start with a '/' & be short (31 chars on
+		/// OS X). Used the next time the channel is opened. (default "/ofxLogger")
+		void setName(const std::string& name);
+		std::string getName();
+
+		/// Set the ring size in KB, rounded up to a power of 2 number of slots.
+		/// Used the next time the channel is opened. (default 2048, 4096 lines)
+		void setSize(unsigned int sizeKB);
+		unsigned int getSize();
+
+		/// delete a segment
+		static void remove(const std::string& name);
+
+		/// \section Layout
+
+		static const uint32_t s_magic = 0x4c58464f;	///< "OFXL" in little endian
+		static const uint32_t s_version = 1;
+		static const uint32_t s_slotSize = 512;		///< bytes per slot, header included
+
+		/// the segment header, followed by the slots
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t slotSize;
+			uint32_t numSlots;					///< a power of 2
+			std::atomic<uint64_t> writeSeq;		///< sequence number of the next line
+			char padding[40];					///< keep the slots on their own cache line
+		};
+
+		/// A slot, the line for sequence number n is in slot n % numSlots.
+		/// The stamp is 2n+1 while the line is written & 2n+2 when it's done.
+		struct Slot
+		{
+			std::atomic<uint64_t> stamp;
+			int64_t time;						///< microseconds since the epoch
+			uint8_t priority;					///< Poco::Message priority
+			uint8_t topicSize;
+			uint16_t textSize;
+			uint32_t padding;
+			char data[s_slotSize-24];			///< topic followed by the text
+		};
+
+		/// the slot for a sequence number
+		static Slot* getSlot(Header* header, uint64_t seq)
+		{
+			return (Slot*) ((char*) (header+1)+(seq & (header->numSlots-1))*header->slotSize);
+		}
+
+	protected:
+
+		~ofxLogSharedMemoryChannel();
+
+	private:
+
+		std::string name;		///< segment name
+		unsigned int numSlots;	///< ring size
+		Header* header;			///< the mapped segment, NULL if not open
+		std::size_t mapSize;	///< size of the mapping
+};
@@ -0,0 +1,128 @@
+#include "ofxLogSite.h"
+
+#include "ofxLogger.h"
+
+#include <algorithm>
+
+// the newest site, each site points at the one before it. Sites are only
+// added with the config mutex locked, the list is read without a lock
+static std::atomic<ofxLogSite*> s_newestSite(NULL);
+static unsigned int s_numSites = 0;
+
+//--------------------------------------------------------------
+ofxLogSite::ofxLogSite(const char* file, int line, const char* function, ofLogLevel level,
+					   const char* topic, const char* format) :
+	enabled(false), mode(DEFAULT)
+{
+	this->file = file;
+	this->line = line;
+	this->function = function;
+	this->level = level;
+	this->topic = topic;
+	this->format = format;
+	this->id = 0;
+	this->next = NULL;
+	ofxLogger::instance()._registerSite(*this);
+}
+
+string ofxLogSite::toString() const
+{
+	string name = file;
+	size_t slash = name.find_last_of("/\\");
+	if(slash != string::npos)
+	{
+		name = name.substr(slash+1);
+	}
+	return name+":"+ofToString(line);
+}
+
+bool ofxLogSite::matches(const string& file, int line) const
+{
+	if(line != 0 && line != this->line)
+	{
+		return false;
+	}
+	size_t length = strlen(this->file);
+	if(file.size() > length || file.compare(0, string::npos, this->file+length-file.size()) != 0)
+	{
+		return false;
+	}
+	// whole path components only, "App.cpp" doesn't match "testApp.cpp"
+	return file.size() == length || this->file[length-file.size()-1] == '/' ||
+		this->file[length-file.size()-1] == '\\';
+}
+
+//--------------------------------------------------------------
+vector<ofxLogSite*> ofxLogSite::getSites()
+{
+	vector<ofxLogSite*> sites;
+	for(ofxLogSite* site = s_newestSite.load(std::memory_order_acquire); site; site = site->next)
+	{
+		sites.push_back(site);
+	}
+	std::reverse(sites.begin(), sites.end());
+	return sites;
+}
+
+vector<ofxLogSite*> ofxLogSite::findSites(const string& file, int line)
+{
+	vector<ofxLogSite*> sites = getSites();
+	vector<ofxLogSite*> found;
+	for(unsigned int i = 0; i < sites.size(); ++i)
+	{
+		if(sites[i]->matches(file, line))
+		{
+			found.push_back(sites[i]);
+		}
+	}
+	return found;
+}
+
+void ofxLogSite::refreshAll(const ofxLogConfig& config)
+{
+	for(ofxLogSite* site = s_newestSite.load(std::memory_order_acquire); site; site = site->next)
+	{
+		site->_refresh(config);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLogSite::_setMode(Mode mode, const ofxLogConfig& config)
+{
+	this->mode.store(mode, std::memory_order_relaxed);
+	_refresh(config);
+}
+
+void ofxLogSite::_refresh(const ofxLogConfig& config)
+{
+	bool b;
+	switch(getMode())
+	{
+		case ON:
+			b = true;
+			break;
+
+		case OFF:
+			b = false;
+			break;
+
+		default:
+		{
+			// unknown topics are enabled so the missing topic warning is printed
+			const ofxLogConfig::Topic* t = topic.empty() ? &config.root : config.findTopic(topic);
+			b = level != OF_LOG_SILENT &&
+				(!t || config.isAccepted(*t, level) || config.isHeard(level) ||
+				 (config.bFlightRecorder && level <= OF_LOG_NOTICE));
+			break;
+		}
+	}
+	enabled.store(b, std::memory_order_relaxed);
+}
+
+void ofxLogSite::_register(const ofxLogConfig& config)
+{
+	_refresh(config);
+	id = s_numSites++;
+	next = s_newestSite.load(std::memory_order_relaxed);
+	s_newestSite.store(this, std::memory_order_release);
+}
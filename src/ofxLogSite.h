@@ -0,0 +1,157 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <atomic>
+
+class ofxLogConfig;
+
+//------------------------------------------------------------------------------
+/// \class ofxLogSite
+/// \brief the static descriptor of one log statement
+///
+/// The OFX_LOG_* macros below keep a static site for each place they're
+/// used, holding the file, line, function, level, topic & format string.
+/// The sites are registered with ofxLogger the first time they're reached &
+/// can be listed at runtime with getSites(), so a single noisy verbose line
+/// can be switched on in a release build without enabling its whole topic:
+///
+///		ofxLog::setSiteMode("testApp.cpp", 42, ofxLogSite::ON);
+///
+/// or "site.testApp.cpp:42 = on" in the config file.
+///
+/// Each site keeps whether it's enabled in an atomic flag that's updated
+/// whenever the settings change, so the check before a line is built is a
+/// single load. The sites are never freed & their id (the registration
+/// order) stays the same while the app runs, so a binary or deferred format
+/// sink can write the id with the arguments & the descriptor once, see
+/// ofxLogRecord::getSite().
+///
+class ofxLogSite
+{
+	public:
+
+		/// how the site's enabled flag is set
+		enum Mode
+		{
+			DEFAULT,	///< follows the level of the topic
+			ON,			///< printed whatever the topic's level (the sink levels still apply)
+			OFF			///< never printed
+		};
+
+		/// Registers the site, the strings must stay valid while the app
+		/// runs (string literals, __func__). Use an empty topic for no topic
+		/// & NULL for no format string.
+		ofxLogSite(const char* file, int line, const char* function, ofLogLevel level,
+				   const char* topic, const char* format=NULL);
+
+		/// would a line from this site be printed (or kept by the flight
+		/// recorder)? the hot path check
+		bool isEnabled() const
+		{
+			return enabled.load(std::memory_order_relaxed);
+		}
+
+		Mode getMode() const	{return (Mode) mode.load(std::memory_order_relaxed);}
+
+		/// file:line, ie. "testApp.cpp:42" (without the directories)
+		std::string toString() const;
+
+		/// Does the site match a file & line? the file matches if it's the
+		/// end of the site's file ("testApp.cpp" or "src/testApp.cpp"), a
+		/// line of 0 matches all the lines.
+		bool matches(const std::string& file, int line=0) const;
+
+		/// \section Descriptor
+
+		const char* file;			///< __FILE__
+		int line;					///< __LINE__
+		const char* function;		///< __func__
+		ofLogLevel level;			///< the level logged at
+		std::string topic;			///< "" for no topic
+		const char* format;			///< the format string, NULL for stream sites
+		unsigned int id;			///< registration order, starting at 0
+
+		/// \section Registry
+
+		/// all the sites reached so far, in registration order
+		static std::vector<ofxLogSite*> getSites();
+
+		/// the sites matching a file & line, see matches()
+		static std::vector<ofxLogSite*> findSites(const std::string& file, int line=0);
+
+		/// Update the enabled flags from a config snapshot, called by
+		/// ofxLogConfigHolder when a snapshot is published (with its mutex
+		/// locked).
+		static void refreshAll(const ofxLogConfig& config);
+
+	private:
+
+		friend class ofxLogger;
+
+		/// sets the mode & enabled flag, called by ofxLogger with the config
+		/// mutex locked
+		void _setMode(Mode mode, const ofxLogConfig& config);
+		void _refresh(const ofxLogConfig& config);
+
+		/// adds the site to the registry, called by ofxLogger with the
+		/// config mutex locked
+		void _register(const ofxLogConfig& config);
+
+		std::atomic<bool> enabled;		///< the cached check
+		std::atomic<int> mode;			///< a Mode
+		ofxLogSite* next;				///< the next older site, set once
+
+		ofxLogSite(ofxLogSite const&);				// not defined, not copyable
+		ofxLogSite& operator=(ofxLogSite const&);	// not defined, not assignable
+};
+
+//------------------------------------------------------------------------------
+/// \section Site Macros
+///
+/// Stream log statements with a static site, use "" for no topic:
+///
+///		OFX_LOG_VERBOSE("mesh") << "vertices: " << mesh.getNumVertices();
+///		OFX_LOG_NOTICE("") << "started";
+///
+/// The level & topic must be constants (the site is built the first time
+/// the line is reached). Nothing after the macro is evaluated when the site
+/// isn't enabled.
+///
+
+/// the static site of the call site, __func__ is passed in as it would be
+/// the lambda's name otherwise
+#define OFX_LOG_SITE(level, topic, fmt) \
+	([](const char* ofxLogFunc_) -> ofxLogSite& { \
+		static ofxLogSite ofxLogSite_(__FILE__, __LINE__, ofxLogFunc_, level, topic, fmt); \
+		return ofxLogSite_; \
+	}(__func__))
+
+#define OFX_LOG_STREAM(level, topic) \
+	for(ofxLogSite* ofxLogSitePtr_ = &OFX_LOG_SITE(level, topic, NULL); ofxLogSitePtr_; ofxLogSitePtr_ = NULL) \
+		if(!ofxLogSitePtr_->isEnabled()) {} else ofxLog(*ofxLogSitePtr_)
+
+#define OFX_LOG_VERBOSE(topic)		OFX_LOG_STREAM(OF_LOG_VERBOSE, topic)
+#define OFX_LOG_NOTICE(topic)		OFX_LOG_STREAM(OF_LOG_NOTICE, topic)
+#define OFX_LOG_WARNING(topic)		OFX_LOG_STREAM(OF_LOG_WARNING, topic)
+#define OFX_LOG_ERROR(topic)		OFX_LOG_STREAM(OF_LOG_ERROR, topic)
+#define OFX_LOG_FATAL_ERROR(topic)	OFX_LOG_STREAM(OF_LOG_FATAL_ERROR, topic)
+
+/// OFX_LOG_FORMAT with a site. As with OFX_LOG_FORMAT, the format must be a
+/// string literal & there must be at least one argument, log a line without
+/// arguments with the stream macros:
+///
+///		OFX_LOG_SITE_FORMAT(OF_LOG_NOTICE, "render", "{}: {} ms", name, ms);
+///		OFX_LOG_NOTICE("render") << "started";
+///
+#define OFX_LOG_SITE_FORMAT(level, topic, fmt, ...) \
+	do { \
+		static_assert(ofxLogFormatCount(fmt) == \
+			std::tuple_size<decltype(std::make_tuple(__VA_ARGS__))>::value, \
+			"OFX_LOG_SITE_FORMAT: number of {} placeholders doesn't match the number of arguments"); \
+		ofxLogSite& ofxLogSiteRef_ = OFX_LOG_SITE(level, topic, fmt); \
+		if(ofxLogSiteRef_.isEnabled()) { \
+			static const ofxLogFormatSpec ofxLogFormatSpec_(fmt); \
+			ofxLog::format(ofxLogSiteRef_, ofxLogFormatSpec_, __VA_ARGS__); \
+		} \
+	} while(0)
@@ -0,0 +1,465 @@
+#include "ofxLogSocketChannel.h"
+
+#ifndef TARGET_WIN32
+	#include <unistd.h>
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <sys/types.h>
+	#include <sys/socket.h>
+	#include <sys/uio.h>
+	#include <sys/un.h>
+#endif
+
+// no SIGPIPE when the collector goes away
+#ifdef MSG_NOSIGNAL
+	#define OFX_LOG_SOCKET_SEND_FLAGS MSG_NOSIGNAL
+#else
+	#define OFX_LOG_SOCKET_SEND_FLAGS 0
+#endif
+
+static const std::size_t s_recordHeaderSize = 6;	// size, priority, topic size
+static const unsigned int s_reconnectMillis = 1000;
+
+//--------------------------------------------------------------
+static void appendUInt32(std::string& data, Poco::UInt32 value)
+{
+	data.append((const char*) &value, sizeof(value));
+}
+
+static Poco::UInt32 readUInt32(const char* data)
+{
+	Poco::UInt32 value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+//--------------------------------------------------------------
+ofxLogSocketChannel::ofxLogSocketChannel() : sender(*this)
+{
+	_init();
+}
+
+ofxLogSocketChannel::ofxLogSocketChannel(const std::string& path) : sender(*this)
+{
+	_init();
+	this->path = path;
+}
+
+ofxLogSocketChannel::~ofxLogSocketChannel()
+{
+	close();
+}
+
+void ofxLogSocketChannel::_init()
+{
+	#ifdef TARGET_WIN32
+		name = "ofApp";
+	#else
+		name = "pid"+ofToString(getpid());
+	#endif
+	bPathChanged = false;
+
+	maxBatchSize = 32*1024;
+	lingerMillis = 10;
+	queueSize = 1024*1024;
+
+	numDropped = 0;
+	numPendingDrops = 0;
+
+	socketFd = -1;
+	bConnected = false;
+	bRunning = false;
+}
+
+//--------------------------------------------------------------
+void ofxLogSocketChannel::open()
+{
+	Poco::FastMutex::ScopedLock lock(queueMutex);
+	if(bRunning)
+	{
+		return;
+	}
+	bRunning = true;
+	thread.start(sender);
+}
+
+void ofxLogSocketChannel::close()
+{
+	{
+		Poco::FastMutex::ScopedLock lock(queueMutex);
+		if(!bRunning)
+		{
+			return;
+		}
+		bRunning = false;
+	}
+	wakeEvent.set();
+	thread.join();
+
+	Poco::FastMutex::ScopedLock lock(sendMutex);
+	_send();
+	_disconnect();
+}
+
+//--------------------------------------------------------------
+void ofxLogSocketChannel::log(const ofxLogRecord& record)
+{
+	Poco::FastMutex::ScopedLock lock(queueMutex);
+
+	ofxLogText text = record.getLine();
+	if(queue.size()+text.size() > queueSize)
+	{
+		numDropped++;
+		numPendingDrops++;
+		return;
+	}
+
+	bool bWasEmpty = queue.empty();
+	_queue(record.getPriority(), record.getTopic(), text.data(), text.size());
+	if(bWasEmpty)
+	{
+		wakeEvent.set();
+	}
+}
+
+void ofxLogSocketChannel::flush()
+{
+	Poco::FastMutex::ScopedLock lock(sendMutex);
+	_send();
+}
+
+//--------------------------------------------------------------
+void ofxLogSocketChannel::setPath(const std::string& path)
+{
+	{
+		Poco::FastMutex::ScopedLock lock(queueMutex);
+		this->path = path;
+		bPathChanged = true;
+	}
+	wakeEvent.set();
+}
+
+std::string ofxLogSocketChannel::getPath()
+{
+	Poco::FastMutex::ScopedLock lock(queueMutex);
+	return path;
+}
+
+void ofxLogSocketChannel::setName(const std::string& name)
+{
+	Poco::FastMutex::ScopedLock lock(queueMutex);
+	this->name = name.substr(0, 255);
+}
+
+std::string ofxLogSocketChannel::getName()
+{
+	Poco::FastMutex::ScopedLock lock(queueMutex);
+	return name;
+}
+
+//--------------------------------------------------------------
+void ofxLogSocketChannel::setMaxBatchSize(unsigned int sizeKB)
+{
+	Poco::FastMutex::ScopedLock lock(queueMutex);
+	maxBatchSize = sizeKB*1024;
+}
+
+void ofxLogSocketChannel::setLingerMillis(unsigned int millis)
+{
+	Poco::FastMutex::ScopedLock lock(queueMutex);
+	lingerMillis = millis;
+}
+
+void ofxLogSocketChannel::setQueueSize(unsigned int sizeKB)
+{
+	Poco::FastMutex::ScopedLock lock(queueMutex);
+	queueSize = sizeKB*1024;
+}
+
+bool ofxLogSocketChannel::isConnected()
+{
+	Poco::FastMutex::ScopedLock lock(queueMutex);
+	return bConnected;
+}
+
+unsigned long ofxLogSocketChannel::getNumDropped()
+{
+	Poco::FastMutex::ScopedLock lock(queueMutex);
+	return numDropped;
+}
+
+//--------------------------------------------------------------
+bool ofxLogSocketChannel::decodeBatch(const char* data, std::size_t size,
+	std::string& name, std::vector<Record>& records)
+{
+	// header
+	if(size < 13 || readUInt32(data) != size || readUInt32(data+4) != s_magic)
+	{
+		return false;
+	}
+	unsigned int count = readUInt32(data+8);
+	std::size_t nameSize = (unsigned char) data[12];
+	if(13+nameSize > size)
+	{
+		return false;
+	}
+	name.assign(data+13, nameSize);
+
+	// records
+	const char* p = data+13+nameSize;
+	const char* end = data+size;
+	for(unsigned int i = 0; i < count; ++i)
+	{
+		if(end-p < (std::ptrdiff_t) s_recordHeaderSize)
+		{
+			return false;
+		}
+		std::size_t recordSize = readUInt32(p);
+		std::size_t topicSize = (unsigned char) p[5];
+		if(recordSize < s_recordHeaderSize+topicSize || recordSize > (std::size_t) (end-p))
+		{
+			return false;
+		}
+
+		Record record;
+		record.priority = (unsigned char) p[4];
+		record.topic.assign(p+s_recordHeaderSize, topicSize);
+		record.text.assign(p+s_recordHeaderSize+topicSize, recordSize-s_recordHeaderSize-topicSize);
+		records.push_back(record);
+
+		p += recordSize;
+	}
+	return p == end;
+}
+
+//--------------------------------------------------------------
+void ofxLogSocketChannel::Sender::run()
+{
+	while(true)
+	{
+		// wake up now & then to retry the connection
+		bool bWoken = channel.wakeEvent.tryWait(s_reconnectMillis);
+
+		unsigned int linger;
+		bool bRunning;
+		{
+			Poco::FastMutex::ScopedLock lock(channel.queueMutex);
+			linger = channel.lingerMillis;
+			bRunning = channel.bRunning;
+		}
+		if(!bRunning)
+		{
+			break;
+		}
+
+		// give the lines logged right after this one a chance to join in
+		if(bWoken && linger > 0)
+		{
+			Poco::Thread::sleep(linger);
+		}
+		channel.flush();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLogSocketChannel::_queue(int priority, const std::string& topic,
+								 const char* text, std::size_t textSize)
+{
+	std::size_t topicSize = std::min(topic.size(), (std::size_t) 255);
+	appendUInt32(queue, (Poco::UInt32) (s_recordHeaderSize+topicSize+textSize));
+	queue += (char) priority;
+	queue += (char) topicSize;
+	queue.append(topic, 0, topicSize);
+	queue.append(text, textSize);
+}
+
+void ofxLogSocketChannel::_send()
+{
+	std::size_t maxSize;
+	bool bReconnect;
+	{
+		Poco::FastMutex::ScopedLock lock(queueMutex);
+		bReconnect = bPathChanged;
+		bPathChanged = false;
+		if(queue.empty() && numPendingDrops == 0 && !bReconnect)
+		{
+			return;
+		}
+	}
+	if(bReconnect)
+	{
+		_disconnect();
+	}
+
+	// lines wait in the queue until the collector is there
+	if(socketFd < 0 && !_connect())
+	{
+		return;
+	}
+
+	{
+		Poco::FastMutex::ScopedLock lock(queueMutex);
+		if(numPendingDrops > 0)
+		{
+			std::string warning = "ofxLogSocketChannel: "+ofToString(numPendingDrops)+" lines dropped";
+			_queue(Poco::Message::PRIO_WARNING, "", warning.data(), warning.size());
+			numPendingDrops = 0;
+		}
+
+		// swap so logging threads can keep appending while this one sends,
+		// both strings keep their capacity
+		sending.clear();
+		sending.swap(queue);
+		maxSize = maxBatchSize > 13+name.size() ? maxBatchSize-13-name.size() : 0;
+	}
+
+	// split into batches at record boundaries
+	const char* start = sending.data();
+	const char* end = start+sending.size();
+	while(start < end)
+	{
+		const char* p = start;
+		unsigned int count = 0;
+		while(p < end)
+		{
+			std::size_t recordSize = readUInt32(p);
+			if(count > 0 && (std::size_t) (p-start)+recordSize > maxSize)
+			{
+				break;
+			}
+			p += recordSize;
+			count++;
+		}
+
+		if(!_sendBatch(start, p-start, count))
+		{
+			// put what's left back in front of the newer lines
+			Poco::FastMutex::ScopedLock lock(queueMutex);
+			queue.insert(0, start, end-start);
+			return;
+		}
+		start = p;
+	}
+}
+
+bool ofxLogSocketChannel::_sendBatch(const char* records, std::size_t size, unsigned int count)
+{
+	#ifdef TARGET_WIN32
+		return false;
+	#else
+		{
+			Poco::FastMutex::ScopedLock lock(queueMutex);
+			std::size_t headerSize = 13+name.size();
+			batch.clear();
+			appendUInt32(batch, (Poco::UInt32) (headerSize+size));
+			appendUInt32(batch, s_magic);
+			appendUInt32(batch, count);
+			batch += (char) name.size();
+			batch += name;
+		}
+
+		// header & records go out as one packet without copying the records
+		iovec parts[2];
+		parts[0].iov_base = (void*) batch.data();
+		parts[0].iov_len = batch.size();
+		parts[1].iov_base = (void*) records;
+		parts[1].iov_len = size;
+
+		msghdr header;
+		memset(&header, 0, sizeof(header));
+		header.msg_iov = parts;
+		header.msg_iovlen = 2;
+
+		while(true)
+		{
+			if(sendmsg(socketFd, &header, OFX_LOG_SOCKET_SEND_FLAGS) >= 0)
+			{
+				return true;
+			}
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			else if(errno == EMSGSIZE)
+			{
+				// can never be sent, drop it & go on with the rest
+				Poco::FastMutex::ScopedLock lock(queueMutex);
+				numDropped += count;
+				numPendingDrops += count;
+				return true;
+			}
+			else if(errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+			{
+				// the collector is busy, try again later
+				return false;
+			}
+			// the collector went away
+			_disconnect();
+			return false;
+		}
+	#endif
+}
+
+//--------------------------------------------------------------
+bool ofxLogSocketChannel::_connect()
+{
+	#ifdef TARGET_WIN32
+		return false;
+	#else
+		sockaddr_un address;
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		{
+			Poco::FastMutex::ScopedLock lock(queueMutex);
+			if(path.empty() || path.size() >= sizeof(address.sun_path))
+			{
+				return false;
+			}
+			strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path)-1);
+		}
+
+		// use whichever type the collector is listening on
+		const int types[] = {SOCK_SEQPACKET, SOCK_DGRAM};
+		for(unsigned int i = 0; i < 2; ++i)
+		{
+			int fd = ::socket(AF_UNIX, types[i], 0);
+			if(fd < 0)
+			{
+				continue;
+			}
+			fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+			// a stuck collector only stalls the sender thread this long
+			timeval timeout = {0, 100*1000};
+			setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+			#ifdef SO_NOSIGPIPE
+				int on = 1;
+				setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+			#endif
+
+			if(::connect(fd, (sockaddr*) &address, sizeof(address)) == 0)
+			{
+				Poco::FastMutex::ScopedLock lock(queueMutex);
+				socketFd = fd;
+				bConnected = true;
+				return true;
+			}
+			::close(fd);
+		}
+		return false;
+	#endif
+}
+
+void ofxLogSocketChannel::_disconnect()
+{
+	if(socketFd < 0)
+	{
+		return;
+	}
+	#ifndef TARGET_WIN32
+		::close(socketFd);
+	#endif
+	Poco::FastMutex::ScopedLock lock(queueMutex);
+	socketFd = -1;
+	bConnected = false;
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include "ofxLogChannel.h"
+
+#include <Poco/Message.h>
+#include <Poco/Mutex.h>
+#include <Poco/Thread.h>
+#include <Poco/Runnable.h>
+#include <Poco/Event.h>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogSocketChannel
+/// \brief sends log lines in batches to a local collector over a Unix socket
+///
+/// Lines are appended to a queue and a background thread sends them to a
+/// collector process (see loggerCollector) listening on a Unix domain socket,
+/// so several apps on one machine can share a single process writing to disk.
+///
+/// Lines are sent in batches of up to the max batch size, shortly after the
+/// first line arrives (the linger time). A SOCK_SEQPACKET socket is used
+/// when the collector listens on one, otherwise SOCK_DGRAM. Either way each
+/// batch is one packet, so the collector reads whole batches.
+///
+/// Logging never waits on the collector: if it isn't running (or restarts)
+/// the background thread retries the connection every second while lines
+/// queue up. When the queue is full new lines are dropped and counted, the
+/// count is sent once the collector is back.
+///
+/// Not available on Windows, lines are dropped.
+///
+/// \section Wire Format
+///
+/// All integers are in the host byte order (sender & collector are on the
+/// same machine).
+///
+///		batch:	uint32 size		total batch size in bytes, header included
+///				uint32 magic	s_magic
+///				uint32 count	number of records
+///				uint8  nameSize
+///				char   name[nameSize]	sender name (setName)
+///				record[count]
+///
+///		record:	uint32 size		record size in bytes, this field included
+///				uint8  priority	Poco::Message priority
+///				uint8  topicSize
+///				char   topic[topicSize]
+///				char   text[size-6-topicSize]	the line, no newline
+///
+class ofxLogSocketChannel : public ofxLogChannel
+{
+	public:
+
+		using ofxLogChannel::log;
+
+		ofxLogSocketChannel();
+		ofxLogSocketChannel(const std::string& path);
+
+		/// starts the background sender
+		void open();
+
+		/// sends everything queued (if connected) & stops the background sender
+		void close();
+
+		/// queue a line
+		void log(const ofxLogRecord& record);
+
+		/// send everything queued now, if connected
+		void flush();
+
+		/// Set the collector's socket path, reconnects if open.
+		void setPath(const std::string& path);
+		std::string getPath();
+
+		/// Set the name sent with each batch so the collector can tell the
+		/// senders apart. (default "pid" + the process id)
+		void setName(const std::string& name);
+		std::string getName();
+
+		/// Set the max size of a batch in KB, longer lines are sent in a batch
+		/// of their own. Keep it below the system's datagram size limit.
+		/// (default 32)
+		void setMaxBatchSize(unsigned int sizeKB);
+
+		/// Set how many millis the sender waits after the first queued line
+		/// before sending, lines arriving in the meantime are batched
+		/// together. (default 10)
+		void setLingerMillis(unsigned int millis);
+
+		/// Set the max size of the queue in KB, lines are dropped when it's
+		/// full. (default 1024)
+		void setQueueSize(unsigned int sizeKB);
+
+		/// is there a connection to the collector?
+		bool isConnected();
+
+		/// number of lines dropped because the queue was full or the
+		/// collector went away while a batch was being sent
+		unsigned long getNumDropped();
+
+		/// \section Decoding
+
+		static const unsigned int s_magic = 0x4258464f;	///< "OFXB" in little endian
+
+		/// a decoded record
+		struct Record
+		{
+			int priority;
+			std::string topic;
+			std::string text;
+		};
+
+		/// Decode a batch as received by the collector, returns false if the
+		/// batch is malformed.
+		static bool decodeBatch(const char* data, std::size_t size,
+			std::string& name, std::vector<Record>& records);
+
+	protected:
+
+		~ofxLogSocketChannel();
+
+	private:
+
+		/// background sender
+		class Sender : public Poco::Runnable
+		{
+			public:
+				Sender(ofxLogSocketChannel& channel) : channel(channel) {}
+				void run();
+			private:
+				ofxLogSocketChannel& channel;
+		};
+
+		/// common constructor setup
+		void _init();
+
+		/// append a record to the queue (call with queueMutex locked)
+		void _queue(int priority, const std::string& topic, const char* text, std::size_t textSize);
+
+		/// swap out the queue & send it in batches (call with sendMutex locked)
+		void _send();
+
+		/// Send one batch, returns false if it should be retried later.
+		/// (call with sendMutex locked)
+		bool _sendBatch(const char* records, std::size_t size, unsigned int count);
+
+		/// try to connect to the collector (call with sendMutex locked)
+		bool _connect();
+
+		/// close the socket (call with sendMutex locked)
+		void _disconnect();
+
+		Poco::FastMutex queueMutex;		///< guards queue & settings
+		Poco::FastMutex sendMutex;		///< serializes sends & the socket
+
+		std::string queue;				///< encoded records waiting to be sent
+		std::string sending;			///< records being sent
+		std::string batch;				///< batch header being built
+
+		std::string path;				///< collector socket path
+		std::string name;				///< sender name
+		bool bPathChanged;				///< reconnect to the new path?
+
+		std::size_t maxBatchSize;		///< max batch size in bytes
+		unsigned int lingerMillis;		///< wait before sending
+		std::size_t queueSize;			///< max queue size in bytes
+
+		unsigned long numDropped;		///< total dropped lines
+		unsigned long numPendingDrops;	///< dropped lines not reported yet
+
+		int socketFd;					///< socket descriptor, -1 if not connected
+		bool bConnected;				///< connected to the collector?
+		bool bRunning;					///< is the sender running?
+
+		Sender sender;
+		Poco::Thread thread;
+		Poco::Event wakeEvent;			///< set when the queue gets data
+};
@@ -0,0 +1,198 @@
+#include "ofxLogSplitterChannel.h"
+
+#include "ofxLogCrashHandler.h"
+
+//--------------------------------------------------------------
+ofxLogSplitterChannel::ofxLogSplitterChannel()
+{
+	bBatching = false;
+	watermark = 64*1024;
+}
+
+ofxLogSplitterChannel::~ofxLogSplitterChannel()
+{
+	close();
+}
+
+//--------------------------------------------------------------
+void ofxLogSplitterChannel::addChannel(Poco::Channel* channel, ofLogLevel level)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	for(unsigned int i = 0; i < sinks.size(); ++i)
+	{
+		if(sinks[i].channel.get() == channel)
+		{
+			sinks[i].level = level;
+			return;
+		}
+	}
+
+	// the cast is done once here instead of for every record
+	Sink sink;
+	sink.channel = Poco::AutoPtr<Poco::Channel>(channel, true);
+	sink.recordChannel = dynamic_cast<ofxLogChannel*>(channel);
+	sink.level = level;
+	sink.batchPriority = Poco::Message::PRIO_TRACE;
+	sinks.push_back(sink);
+}
+
+void ofxLogSplitterChannel::setChannelLevel(Poco::Channel* channel, ofLogLevel level)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	for(unsigned int i = 0; i < sinks.size(); ++i)
+	{
+		if(sinks[i].channel.get() == channel)
+		{
+			sinks[i].level = level;
+			return;
+		}
+	}
+}
+
+void ofxLogSplitterChannel::removeChannel(Poco::Channel* channel)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	for(std::vector<Sink>::iterator iter = sinks.begin(); iter != sinks.end(); ++iter)
+	{
+		if(iter->channel.get() == channel)
+		{
+			_flushSink(*iter);
+			sinks.erase(iter);
+			return;
+		}
+	}
+}
+
+int ofxLogSplitterChannel::count()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return sinks.size();
+}
+
+//--------------------------------------------------------------
+void ofxLogSplitterChannel::log(const ofxLogRecord& record)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+
+	// one message for all the plain Poco channels
+	Poco::Message message;
+	bool bMessage = false;
+	for(unsigned int i = 0; i < sinks.size(); ++i)
+	{
+		if(record.getLevel() < sinks[i].level)
+		{
+			continue;
+		}
+		if(sinks[i].recordChannel)
+		{
+			sinks[i].recordChannel->log(record);
+		}
+		else if(bBatching)
+		{
+			ofxLogText text = record.getLine();
+			Sink& sink = sinks[i];
+			if(sink.batch.empty())
+			{
+				sink.batchTime = record.getTime();
+			}
+			sink.batch.append(text.data(), text.size());
+			sink.batch += '\n';
+			if(record.getPriority() < sink.batchPriority)
+			{
+				sink.batchPriority = (Poco::Message::Priority) record.getPriority();
+			}
+
+			// errors are passed on right away in case the app is about to go down
+			if(sink.batch.size() >= watermark || record.getPriority() <= Poco::Message::PRIO_ERROR)
+			{
+				_flushSink(sink);
+			}
+		}
+		else
+		{
+			if(!bMessage)
+			{
+				message.setSource(record.getTopic());
+				message.setText(record.getLine().str());
+				message.setPriority((Poco::Message::Priority) record.getPriority());
+				message.setTime(record.getTime());
+				bMessage = true;
+			}
+			sinks[i].channel->log(message);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLogSplitterChannel::enableBatching(std::size_t watermark)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	this->watermark = watermark;
+	bBatching = true;
+}
+
+void ofxLogSplitterChannel::disableBatching()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	for(unsigned int i = 0; i < sinks.size(); ++i)
+	{
+		_flushSink(sinks[i]);
+	}
+	bBatching = false;
+}
+
+bool ofxLogSplitterChannel::usingBatching()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return bBatching;
+}
+
+std::size_t ofxLogSplitterChannel::getWatermark()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return watermark;
+}
+
+void ofxLogSplitterChannel::flush()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	for(unsigned int i = 0; i < sinks.size(); ++i)
+	{
+		_flushSink(sinks[i]);
+	}
+}
+
+void ofxLogSplitterChannel::crashDump(int fd)
+{
+	for(unsigned int i = 0; i < sinks.size(); ++i)
+	{
+		ofxLogCrashHandler::write(fd, sinks[i].batch.data(), sinks[i].batch.size());
+	}
+}
+
+void ofxLogSplitterChannel::close()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	for(unsigned int i = 0; i < sinks.size(); ++i)
+	{
+		_flushSink(sinks[i]);
+	}
+	sinks.clear();
+}
+
+//--------------------------------------------------------------
+void ofxLogSplitterChannel::_flushSink(Sink& sink)
+{
+	if(sink.batch.empty())
+	{
+		return;
+	}
+
+	// the channel adds the last newline, as it does for a single line
+	Poco::Message message("", "", sink.batchPriority);
+	message.setText(sink.batch.substr(0, sink.batch.size()-1));
+	message.setTime(sink.batchTime);
+	sink.batch.clear();
+	sink.batchPriority = Poco::Message::PRIO_TRACE;
+	sink.channel->log(message);
+}
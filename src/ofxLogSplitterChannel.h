@@ -0,0 +1,96 @@
+#pragma once
+
+#include "ofxLogChannel.h"
+
+#include <Poco/Mutex.h>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogSplitterChannel
+/// \brief sends each record to a number of channels
+///
+/// A replacement for the Poco::SplitterChannel that passes the shared
+/// record on to each ofxLogChannel. Plain Poco channels (ie. the
+/// Poco::FileChannel) all get the same Poco::Message, which is only built
+/// if there is at least one of them.
+///
+/// Each channel can have its own minimum log level, so one record can go to
+/// the file but not the console. Records below a channel's level are
+/// skipped before anything is built for it.
+///
+/// A channel that has been removed won't get any more records once
+/// removeChannel() returns.
+///
+/// With batching enabled, the lines for the plain Poco channels are
+/// collected & handed over as one multi line message on flush(), ie. one
+/// file write per frame instead of one per line. Errors & a batch reaching
+/// the watermark are passed on right away. The ofxLogChannels are not
+/// batched here, they buffer on their own.
+///
+class ofxLogSplitterChannel : public ofxLogChannel
+{
+	public:
+
+		using ofxLogChannel::log;
+
+		ofxLogSplitterChannel();
+
+		/// add a channel with the lowest level it gets, only sets the level
+		/// if it's already added
+		void addChannel(Poco::Channel* channel, ofLogLevel level=OF_LOG_VERBOSE);
+		
+		/// set the lowest level a channel gets
+		void setChannelLevel(Poco::Channel* channel, ofLogLevel level);
+
+		/// remove a channel
+		void removeChannel(Poco::Channel* channel);
+
+		/// number of channels
+		int count();
+
+		/// send a record to all channels
+		void log(const ofxLogRecord& record);
+
+		/// collect the lines for the plain Poco channels until flush(), the
+		/// watermark is the batch size in bytes that's passed on right away
+		void enableBatching(std::size_t watermark=64*1024);
+		
+		/// passes on what's collected & stops batching
+		void disableBatching();
+		bool usingBatching();
+		std::size_t getWatermark();
+
+		/// pass on the collected lines now
+		void flush();
+
+		/// For ofxLogCrashHandler only: write the collected lines to the fd
+		/// without locking & with async-signal-safe calls.
+		void crashDump(int fd);
+
+		/// closes all channels
+		void close();
+
+	protected:
+
+		~ofxLogSplitterChannel();
+
+	private:
+
+		/// a channel & its ofxLogChannel interface, if it has one
+		struct Sink
+		{
+			Poco::AutoPtr<Poco::Channel> channel;
+			ofxLogChannel* recordChannel;	///< NULL for a plain Poco channel
+			ofLogLevel level;				///< lowest level sent to the channel
+			std::string batch;				///< collected lines, each ends with a newline
+			Poco::Message::Priority batchPriority;	///< highest priority in the batch
+			Poco::Timestamp batchTime;		///< time of the first line in the batch
+		};
+
+		/// pass on a sink's batch (call with the mutex locked)
+		void _flushSink(Sink& sink);
+
+		Poco::FastMutex mutex;		///< guards the sinks
+		std::vector<Sink> sinks;
+		bool bBatching;				///< collect the plain channels' lines?
+		std::size_t watermark;		///< batch size passed on right away
+};
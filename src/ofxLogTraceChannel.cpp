@@ -0,0 +1,320 @@
+#include "ofxLogTraceChannel.h"
+
+#include "ofxLogPattern.h"
+
+#ifndef TARGET_WIN32
+	#include <unistd.h>
+#endif
+
+static const std::size_t s_maxNameSize = 120;		// longer messages are cut in the event name
+static const std::size_t s_fileBufferSize = 256*1024;
+
+std::atomic<bool> ofxLogTraceChannel::s_bTracing(false);
+
+// the channel the scopes are written to, never freed so scopes ending in
+// static destructors can still check it
+struct ofxLogTraceTarget
+{
+	Poco::FastMutex mutex;
+	ofxLogTraceChannel* channel;
+};
+
+static ofxLogTraceTarget& traceTarget()
+{
+	static ofxLogTraceTarget* target = new ofxLogTraceTarget();
+	return *target;
+}
+
+//--------------------------------------------------------------
+// appends text as the inside of a JSON string
+static void appendJson(std::string& json, const char* text, std::size_t size)
+{
+	for(std::size_t i = 0; i < size; ++i)
+	{
+		unsigned char c = (unsigned char) text[i];
+		switch(c)
+		{
+			case '"':	json += "\\\""; break;
+			case '\\':	json += "\\\\"; break;
+			case '\n':	json += "\\n"; break;
+			case '\r':	json += "\\r"; break;
+			case '\t':	json += "\\t"; break;
+			default:
+				if(c < 0x20)
+				{
+					char escaped[8];
+					snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+					json += escaped;
+				}
+				else
+				{
+					json += (char) c;
+				}
+		}
+	}
+}
+
+static void appendInt(std::string& json, int64_t value)
+{
+	char digits[24];
+	snprintf(digits, sizeof(digits), "%lld", (long long) value);
+	json += digits;
+}
+
+//--------------------------------------------------------------
+ofxLogTraceChannel::ofxLogTraceChannel()
+{
+	_init();
+}
+
+ofxLogTraceChannel::ofxLogTraceChannel(const std::string& path)
+{
+	_init();
+	this->path = path;
+}
+
+ofxLogTraceChannel::~ofxLogTraceChannel()
+{
+	close();
+}
+
+void ofxLogTraceChannel::_init()
+{
+	path = ofToDataPath("trace.json");
+	file = NULL;
+	bFirstEvent = true;
+	#ifdef TARGET_WIN32
+		pid = 1;
+	#else
+		pid = getpid();
+	#endif
+	frameNum = 0;
+	bFrameStarted = false;
+}
+
+//--------------------------------------------------------------
+void ofxLogTraceChannel::open()
+{
+	{
+		Poco::FastMutex::ScopedLock lock(mutex);
+		if(file)
+		{
+			return;
+		}
+		file = fopen(path.c_str(), "w");
+		if(!file)
+		{
+			return;
+		}
+		setvbuf(file, NULL, _IOFBF, s_fileBufferSize);
+		openClock = std::chrono::steady_clock::now();
+		bFirstEvent = true;
+		bFrameStarted = false;
+
+		fputs("[\n", file);
+		_beginEvent();
+		event += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":";
+		appendInt(event, pid);
+		event += ",\"args\":{\"name\":\"openFrameworks\"}}";
+		fwrite(event.data(), 1, event.size(), file);
+	}
+
+	ofAddListener(ofEvents.update, this, &ofxLogTraceChannel::onUpdate);
+
+	// one channel gets the scopes, the last one opened
+	ofxLogTraceTarget& target = traceTarget();
+	Poco::FastMutex::ScopedLock lock(target.mutex);
+	target.channel = this;
+	s_bTracing.store(true, std::memory_order_relaxed);
+}
+
+void ofxLogTraceChannel::close()
+{
+	{
+		ofxLogTraceTarget& target = traceTarget();
+		Poco::FastMutex::ScopedLock lock(target.mutex);
+		if(target.channel == this)
+		{
+			target.channel = NULL;
+			s_bTracing.store(false, std::memory_order_relaxed);
+		}
+	}
+
+	{
+		Poco::FastMutex::ScopedLock lock(mutex);
+		if(!file)
+		{
+			return;
+		}
+		fputs("\n]\n", file);
+		fclose(file);
+		file = NULL;
+	}
+	ofRemoveListener(ofEvents.update, this, &ofxLogTraceChannel::onUpdate);
+}
+
+bool ofxLogTraceChannel::isOpen()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return file != NULL;
+}
+
+//--------------------------------------------------------------
+void ofxLogTraceChannel::log(const ofxLogRecord& record)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	if(!file)
+	{
+		return;
+	}
+
+	ofxLogText message = record.getMessage();
+	ofLogLevel level = record.getLevel();
+	const std::string& topic = record.getTopic();
+
+	// cut long names between UTF-8 characters
+	std::size_t nameSize = message.size();
+	if(nameSize > s_maxNameSize)
+	{
+		nameSize = s_maxNameSize;
+		while(nameSize > 0 && (message.data()[nameSize] & 0xc0) == 0x80)
+		{
+			--nameSize;
+		}
+	}
+
+	_beginEvent();
+	event += "{\"name\":\"";
+	appendJson(event, message.data(), nameSize);
+	event += "\",\"cat\":\"";
+	if(topic.empty())
+	{
+		event += "log";
+	}
+	else
+	{
+		appendJson(event, topic.data(), topic.size());
+	}
+	event += "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":";
+	appendInt(event, _micros(record.getClock()));
+	event += ",\"pid\":";
+	appendInt(event, pid);
+	event += ",\"tid\":";
+	appendInt(event, record.getThreadId());
+	event += ",\"args\":{\"level\":\"";
+	event += level >= 0 && level < OF_LOG_SILENT ? ofxLogPattern::s_levelNames[level] : "fatal";
+	event += "\",\"frame\":";
+	appendInt(event, record.getFrameNum());
+	if(nameSize < message.size())
+	{
+		event += ",\"message\":\"";
+		appendJson(event, message.data(), message.size());
+		event += "\"";
+	}
+	event += "}}";
+	fwrite(event.data(), 1, event.size(), file);
+}
+
+void ofxLogTraceChannel::flush()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	if(file)
+	{
+		fflush(file);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLogTraceChannel::setPath(const std::string& path)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	this->path = path;
+}
+
+std::string ofxLogTraceChannel::getPath()
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	return path;
+}
+
+//--------------------------------------------------------------
+void ofxLogTraceChannel::traceScope(const char* name, std::chrono::steady_clock::time_point start,
+									std::chrono::steady_clock::duration duration)
+{
+	ofxLogTraceTarget& target = traceTarget();
+	Poco::FastMutex::ScopedLock targetLock(target.mutex);
+	ofxLogTraceChannel* channel = target.channel;
+	if(!channel)
+	{
+		return;
+	}
+
+	Poco::FastMutex::ScopedLock lock(channel->mutex);
+	if(!channel->file)
+	{
+		return;
+	}
+	channel->_writeComplete(name, strlen(name), "scope", channel->_micros(start),
+		std::chrono::duration_cast<std::chrono::microseconds>(duration).count(),
+		ofxLogRecord::currentThreadId(), ofGetFrameNum());
+}
+
+void ofxLogTraceChannel::onUpdate(ofEventArgs& args)
+{
+	Poco::FastMutex::ScopedLock lock(mutex);
+	if(!file)
+	{
+		return;
+	}
+
+	// the frame that just ended, from the last update to this one
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if(bFrameStarted)
+	{
+		std::string name = "frame "+ofToString(frameNum);
+		_writeComplete(name.data(), name.size(), "frame", _micros(frameStart),
+			std::chrono::duration_cast<std::chrono::microseconds>(now-frameStart).count(),
+			ofxLogRecord::currentThreadId(), frameNum);
+	}
+	frameStart = now;
+	frameNum = ofGetFrameNum();
+	bFrameStarted = true;
+}
+
+//--------------------------------------------------------------
+void ofxLogTraceChannel::_beginEvent()
+{
+	event.clear();
+	if(!bFirstEvent)
+	{
+		event += ",\n";
+	}
+	bFirstEvent = false;
+}
+
+void ofxLogTraceChannel::_writeComplete(const char* name, std::size_t nameSize, const char* category,
+										int64_t ts, int64_t dur, unsigned int threadId, int frameNum)
+{
+	_beginEvent();
+	event += "{\"name\":\"";
+	appendJson(event, name, nameSize);
+	event += "\",\"cat\":\"";
+	event += category;
+	event += "\",\"ph\":\"X\",\"ts\":";
+	appendInt(event, ts);
+	event += ",\"dur\":";
+	appendInt(event, dur);
+	event += ",\"pid\":";
+	appendInt(event, pid);
+	event += ",\"tid\":";
+	appendInt(event, threadId);
+	event += ",\"args\":{\"frame\":";
+	appendInt(event, frameNum);
+	event += "}}";
+	fwrite(event.data(), 1, event.size(), file);
+}
+
+int64_t ofxLogTraceChannel::_micros(std::chrono::steady_clock::time_point time)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(time-openClock).count();
+}
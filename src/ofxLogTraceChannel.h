@@ -0,0 +1,113 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include "ofxLogChannel.h"
+
+#include <Poco/Message.h>
+#include <Poco/Mutex.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+/// \class ofxLogTraceChannel
+/// \brief writes a timeline of log records, scopes & frames
+///
+/// Writes the Chrome trace event JSON format, which can be loaded into
+/// chrome://tracing or https://ui.perfetto.dev to see where log bursts,
+/// ofxLogScope timings & slow frames line up:
+///
+///  - each log record is an instant event on the thread that logged it,
+///    named after the message, with the level, topic & frame num
+///  - each ofxLogScope is a complete event ("ph":"X") with its duration,
+///    written when the scope ends
+///  - each frame is a complete event from one update to the next on the
+///    main thread, in the "frame" category, with its frame num
+///
+/// Events are streamed to the file through a stdio buffer as they happen, so
+/// a long capture doesn't have to fit in memory. The closing bracket is
+/// written on close(), the viewers also load a file without it (ie. after a
+/// crash).
+///
+/// Times are in micros on the steady clock since the channel was opened, so
+/// records, scopes & frames stay lined up when the wall clock is adjusted.
+/// Thread ids are the ones from ofxLogRecord::currentThreadId().
+///
+class ofxLogTraceChannel : public ofxLogChannel
+{
+	public:
+
+		using ofxLogChannel::log;
+
+		ofxLogTraceChannel();
+		ofxLogTraceChannel(const std::string& path);
+
+		/// creates the file & starts tracing scopes & frames
+		void open();
+
+		/// ends the JSON array & closes the file
+		void close();
+
+		/// is the file open? false if open() failed
+		bool isOpen();
+
+		/// write a record as an instant event
+		void log(const ofxLogRecord& record);
+
+		/// write what's buffered to the file
+		void flush();
+
+		/// Set the file path, used the next time the channel is opened.
+		/// (default "trace.json" in the data folder)
+		void setPath(const std::string& path);
+		std::string getPath();
+
+		/// Write a scope as a complete event to the open trace channel, if
+		/// there is one. Called by ofxLogScope.
+		static void traceScope(const char* name, std::chrono::steady_clock::time_point start,
+							   std::chrono::steady_clock::duration duration);
+
+		/// is a trace channel open? checked by ofxLogScope before timing
+		/// anything for the trace
+		static bool isTracing()	{return s_bTracing.load(std::memory_order_relaxed);}
+
+		/// the frame event listener, called on each update
+		void onUpdate(ofEventArgs& args);
+
+	protected:
+
+		~ofxLogTraceChannel();
+
+	private:
+
+		/// common constructor setup
+		void _init();
+
+		/// start an event, writes the separator (call with mutex locked)
+		void _beginEvent();
+
+		/// write a complete event (call with mutex locked)
+		void _writeComplete(const char* name, std::size_t nameSize, const char* category,
+							int64_t ts, int64_t dur, unsigned int threadId, int frameNum);
+
+		/// micros since the channel was opened
+		int64_t _micros(std::chrono::steady_clock::time_point time);
+
+		Poco::FastMutex mutex;			///< guards the file & the event
+
+		std::string path;				///< the file path
+		FILE* file;						///< the file, NULL if not open
+		std::string event;				///< the event being built
+		bool bFirstEvent;				///< no separator before the first event
+		int pid;						///< the process id for the events
+
+		std::chrono::steady_clock::time_point openClock;	///< when the channel was opened
+
+		std::chrono::steady_clock::time_point frameStart;	///< start of the current frame
+		int frameNum;					///< the current frame
+		bool bFrameStarted;				///< has an update been seen?
+
+		static std::atomic<bool> s_bTracing;	///< is a channel open for the scopes?
+};
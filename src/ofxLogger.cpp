@@ -1,17 +1,30 @@
 #include "ofxLogger.h"
 
-#include <Poco/PatternFormatter.h>
-#include <Poco/FormattingChannel.h>
 #include <Poco/Message.h>
-#include <Poco/LocalDateTime.h>
-#include <Poco/DateTimeFormatter.h>
+#include <Poco/String.h>
+#include <Poco/RunnableAdapter.h>
 
-const string ofxLogger::s_dateFormat = "%Y-%m-%d %H:%M:%S.%i";
-const string ofxLogger::s_timeFormat = "%H:%M:%S.%i";
-const string ofxLogger::s_dateAndTimeFormat = "%Y-%m-%d %H:%M:%S.%i";
+#include <fstream>
+#include <atomic>
+#include <algorithm>
+
+#ifndef TARGET_WIN32
+	#include <unistd.h>
+	#include <errno.h>
+#endif
 
 ofEvent<ofxLoggerEvent> ofxLoggerEventDispatcher;
 
+// a plain int so it's valid before the singleton is built & after the
+// other statics are destroyed
+static std::atomic<int> s_state(ofxLogger::RUNNING);
+static std::atomic<int> s_lateLevel(OF_LOG_NOTICE);	///< global level at the shutdown
+static std::atomic<bool> s_bDrainAbandoned(false);	///< the shutdown stopped waiting for the sinks
+
+// room kept in a queued record for the header of its line, on top of the
+// message & topic, a longer line gets a block of its own
+static const std::size_t s_headerRoom = 64;
+
 //
 // Useful references:
 //  - http://pocoproject.org/docs/Poco.Logger.html
@@ -21,29 +34,35 @@ ofEvent<ofxLoggerEvent> ofxLoggerEventDispatcher;
 // inspired by the Poco LogRotation sample
 ofxLogger::ofxLogger()
 {	
+	splitterChannel = new ofxLogSplitterChannel();
 
-	bConsole = true;
-	bFile = false;
-
-	bHeader = false;
-	bDate = true;
-	bTime = true;
-	bFrameNum = false;
-	bMillis = false;
-
-	splitterChannel = new Poco::SplitterChannel();
-
-	consoleChannel = new Poco::ConsoleChannel();
+	consoleChannel = new ofxLogConsoleChannel();
 	fileChannel = new Poco::FileChannel(ofToDataPath("openframeworks.log"));
+	socketChannel = new ofxLogSocketChannel();
+	sharedMemoryChannel = new ofxLogSharedMemoryChannel();
+	compressedFileChannel = new ofxLogCompressedFileChannel();
+	traceChannel = new ofxLogTraceChannel();
+	numListeners = 0;
+	frameFlushCount = 0;
+	consoleBufferSizeKB = 0;
+	shutdownTimeout = 2000;
 
 	// console open, file not opened (added) by default
 	splitterChannel->addChannel(consoleChannel);
+	consoleChannel->open();
+
+	// write out what's still buffered & close the sinks when the app exits
+	atexit(&ofxLogger::_shutdownAtExit);
 
-	Poco::AutoPtr<Poco::Formatter> formatter(new Poco::PatternFormatter("%t"));
-	formattingChannel = new Poco::FormattingChannel(formatter, splitterChannel);
+	// the root logger has an empty name, lines logged through the Poco API
+	// go to the same channels
+	logger = &Poco::Logger::create("", splitterChannel, ofxLogRecord::toPriority(OF_LOG_NOTICE));
 
-	// the root logger has an empty name
-	logger = &Poco::Logger::create("", formattingChannel, _convertOfLogLevel(OF_LOG_NOTICE));
+	// the default settings are in the first snapshot's constructor
+	ofxLogConfig* first = config.copy();
+	first->root.channel = splitterChannel;
+	first->pattern = new ofxLogPattern(_presetPattern(*first));
+	config.publish(first);
 
 	// setup file logger
 	fileChannel->setProperty("times", "local");		// use local system time
@@ -58,68 +77,263 @@ ofxLogger::ofxLogger()
 //-----------------------------------------------------------------
 ofxLogger& ofxLogger::instance()
 {
+	// never deleted, so it outlives the statics that log in their destructors
 	static ofxLogger* pointerToTheSingletonInstance = new ofxLogger;
 	return *pointerToTheSingletonInstance;
 }
 
+//--------------------------------------------------------------
+ofxLogger::State ofxLogger::getState()
+{
+	return (State) s_state.load(std::memory_order_acquire);
+}
+
+void ofxLogger::shutdown()
+{
+	if(s_state.load(std::memory_order_acquire) != RUNNING)
+	{
+		return;
+	}
+
+	// the config readers may be gone with the other statics later on, the
+	// late lines keep the level from here, set first as lines logged from
+	// here on go to stderr
+	s_lateLevel.store(getLevel(), std::memory_order_relaxed);
+	int expected = RUNNING;
+	if(!s_state.compare_exchange_strong(expected, SHUTTING_DOWN))
+	{
+		return;
+	}
+
+	// the sinks are written out on their own thread so a stuck one can't
+	// hold up the exit, the thread & runnable outlive it if it's given up on
+	Poco::RunnableAdapter<ofxLogger>* drain =
+		new Poco::RunnableAdapter<ofxLogger>(*this, &ofxLogger::_drain);
+	shutdownThread.start(*drain);
+	if(shutdownDone.tryWait(shutdownTimeout))
+	{
+		shutdownThread.join();
+		delete drain;
+	}
+	else
+	{
+		// the drain stops after the step it's stuck in, everything that step
+		// can still touch (the channels, records, topic names & pools) is
+		// never freed
+		s_bDrainAbandoned.store(true, std::memory_order_release);
+		const char warning[] = "ofxLogger: the sinks didn't finish writing before the shutdown timeout";
+		_logLate(OF_LOG_WARNING, "", warning, sizeof(warning)-1);
+	}
+
+	// nothing is pending anymore & the crash dump would read statics that
+	// are about to be destroyed
+	ofxLogCrashHandler::uninstall();
+	s_state.store(SHUT_DOWN, std::memory_order_release);
+}
+
+void ofxLogger::setShutdownTimeout(unsigned int millis)
+{
+	shutdownTimeout = millis;
+}
+
 //--------------------------------------------------------------------------------------
 void ofxLogger::log(ofLogLevel logLevel, const string& message){
 
-	_log(logLevel, message, logger);
+	log(logLevel, message.data(), message.size());
+}
+
+void ofxLogger::log(ofLogLevel logLevel, const char* message, std::size_t size)
+{
+	if(s_state.load(std::memory_order_relaxed) != RUNNING)
+	{
+		_logLate(logLevel, "", message, size);
+		return;
+	}
+	ofxLogConfigHolder::Reader reader(config);
+	_log(*reader, logLevel, message, size, reader->root);
 }
 
 void ofxLogger::log(const string& logTopic, ofLogLevel logLevel, const string& message)
 {
-	Poco::Logger* topicLogger = Poco::Logger::has(logTopic);
-	if(!topicLogger)
+	log(logTopic, logLevel, message.data(), message.size());
+}
+
+void ofxLogger::log(const string& logTopic, ofLogLevel logLevel, const char* message, std::size_t size)
+{
+	if(s_state.load(std::memory_order_relaxed) != RUNNING)
+	{
+		_logLate(logLevel, logTopic.c_str(), message, size);
+		return;
+	}
+	ofxLogConfigHolder::Reader reader(config);
+	const ofxLogConfig::Topic* topic = reader->findTopic(logTopic);
+	if(!topic)
+	{
+		string warning = "log topic \""+logTopic+"\" not found";
+		_log(*reader, OF_LOG_WARNING, warning.data(), warning.size(), reader->root);
+	}
+	else
+	{
+		_log(*reader, logLevel, message, size, *topic);
+	}
+}
+
+void ofxLogger::log(const ofxLogSite& site, const char* message, std::size_t size)
+{
+	if(s_state.load(std::memory_order_relaxed) != RUNNING)
 	{
-		_log(OF_LOG_WARNING, "log topic \""+logTopic+"\" not found", logger);
+		_logLate(site.level, site.topic.c_str(), message, size);
+		return;
+	}
+	ofxLogConfigHolder::Reader reader(config);
+	const ofxLogConfig::Topic* topic = site.topic.empty() ? &reader->root : reader->findTopic(site.topic);
+	if(!topic)
+	{
+		string warning = "log topic \""+site.topic+"\" not found ("+site.toString()+")";
+		_log(*reader, OF_LOG_WARNING, warning.data(), warning.size(), reader->root);
 	}
 	else
 	{
-		_log(logLevel, logTopic+": "+message, topicLogger);
+		_log(*reader, site.level, message, size, *topic, &site);
 	}
 }
 
 //--------------------------------------------------------------
 void ofxLogger::setLevel(ofLogLevel logLevel)
 {
-	logger->setLevel(_convertOfLogLevel(logLevel));
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	ofxLogConfig* next = config.copy();
+	next->root.level = logLevel;
+	config.publish(next);
+	// silent turns the Poco logger off, there's no priority for it
+	logger->setLevel(logLevel == OF_LOG_SILENT ? -1 : ofxLogRecord::toPriority(logLevel));
 }
 
 ofLogLevel ofxLogger::getLevel()
 {
-	return _convertPocoLogLevel(logger->getLevel());
+	return ofxLogConfigHolder::Reader(config)->root.level;
+}
+
+bool ofxLogger::isEnabled(ofLogLevel logLevel)
+{
+	if(s_state.load(std::memory_order_relaxed) != RUNNING)
+	{
+		return logLevel >= s_lateLevel.load(std::memory_order_relaxed);
+	}
+	ofxLogConfigHolder::Reader reader(config);
+	return _isEnabled(*reader, logLevel, reader->root);
+}
+
+bool ofxLogger::isEnabled(const string& logTopic, ofLogLevel logLevel)
+{
+	if(s_state.load(std::memory_order_relaxed) != RUNNING)
+	{
+		return logLevel >= s_lateLevel.load(std::memory_order_relaxed);
+	}
+	ofxLogConfigHolder::Reader reader(config);
+	const ofxLogConfig::Topic* topic = reader->findTopic(logTopic);
+	if(!topic)
+	{
+		return false;
+	}
+	return _isEnabled(*reader, logLevel, *topic);
 }
 
 //-------------------------------------------------
-void ofxLogger::enableConsole()
+void ofxLogger::setSinkLevel(ofxLogSink sink, ofLogLevel logLevel)
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	ofxLogConfig* next = config.copy();
+	next->sinkLevels[sink] = logLevel;
+	config.publish(next);
+
+	// the levels stay on the splitters while a sink is disabled
+	Poco::Channel* channel = _sinkChannel(sink);
+	if(!channel)
+	{
+		return;
+	}
+	splitterChannel->setChannelLevel(channel, logLevel);
+	for(unsigned int i = 0; i < topicRoutes.size(); ++i)
+	{
+		topicRoutes[i].splitterChannel->setChannelLevel(sink == OFX_LOG_SINK_FILE ?
+			(Poco::Channel*) topicRoutes[i].fileChannel : channel, logLevel);
+	}
+}
+
+ofLogLevel ofxLogger::getSinkLevel(ofxLogSink sink)
 {
+	return ofxLogConfigHolder::Reader(config)->sinkLevels[sink];
+}
 
-	splitterChannel->addChannel(consoleChannel);
+//-------------------------------------------------
+void ofxLogger::enableConsole()
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	if(config.current()->bConsole)
+	{
+		return;
+	}
+	_addChannel(consoleChannel, OFX_LOG_SINK_CONSOLE);
 	consoleChannel->open();
-	bConsole = true;
+	_setFlag(&ofxLogConfig::bConsole, true);
 }
 
 void ofxLogger::disableConsole()
 {
-	splitterChannel->removeChannel(consoleChannel);
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	if(!config.current()->bConsole)
+	{
+		return;
+	}
+	_removeChannel(consoleChannel);
 	consoleChannel->close();
-	bConsole = false;
-}	
+	_setFlag(&ofxLogConfig::bConsole, false);
+}
 
 bool ofxLogger::usingConsole()
 {
-	return bConsole;
+	return _getFlag(&ofxLogConfig::bConsole);
+}
+
+void ofxLogger::enableConsoleColors()
+{
+	consoleChannel->enableColors();
+}
+
+void ofxLogger::disableConsoleColors()
+{
+	consoleChannel->disableColors();
+}
+
+bool ofxLogger::usingConsoleColors()
+{
+	return consoleChannel->usingColors();
+}
+
+void ofxLogger::enableConsoleNonBlocking()
+{
+	consoleChannel->enableNonBlocking();
+}
+
+void ofxLogger::disableConsoleNonBlocking()
+{
+	consoleChannel->disableNonBlocking();
+}
+
+bool ofxLogger::usingConsoleNonBlocking()
+{
+	return consoleChannel->usingNonBlocking();
 }
 
 //----------------------------------------------------------------------------------------
-// using printf instead of the logger since we don't want to write this as a line
+// the color is applied to the lines by the console channel so it doesn't
+// interleave with lines logged from other threads
 void ofxLogger::setConsoleColor(int color){
 	#ifdef TARGET_WIN32
 		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), color);
 	#else
-		printf("\033[%im",  color);
+		consoleChannel->setDefaultColor(color);
 	#endif
 }
 
@@ -127,10 +341,84 @@ void ofxLogger::restoreConsoleColor(){
 	#ifdef TARGET_WIN32
 		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), OF_CONSOLE_COLOR_RESTORE);
 	#else
-		printf("\033[%im",  OF_CONSOLE_COLOR_RESTORE);
+		consoleChannel->setDefaultColor(OF_CONSOLE_COLOR_RESTORE);
 	#endif
 }
 
+//----------------------------------------------------------------------------------------
+void ofxLogger::flush()
+{
+	formatPool.drain();
+	_flushBatches();
+	consoleChannel->flush();
+	if(_getFlag(&ofxLogConfig::bSocket))
+	{
+		socketChannel->flush();
+	}
+	if(_getFlag(&ofxLogConfig::bCompressedFile))
+	{
+		compressedFileChannel->flush();
+	}
+	if(_getFlag(&ofxLogConfig::bTrace))
+	{
+		traceChannel->flush();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLogger::enableFrameFlush(unsigned int numFrames, unsigned int watermarkKB)
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	ofxLogConfig* next = config.copy();
+	bool bWasFlushing = next->bFrameFlush;
+	next->bFrameFlush = true;
+	next->frameFlushFrames = std::max(numFrames, 1u);
+	config.publish(next);
+
+	if(!bWasFlushing)
+	{
+		consoleBufferSizeKB = consoleChannel->getBufferSize();
+	}
+	consoleChannel->setBufferSize(watermarkKB);
+	consoleChannel->enableManualFlush();
+	splitterChannel->enableBatching(watermarkKB*1024);
+	for(unsigned int i = 0; i < topicRoutes.size(); ++i)
+	{
+		topicRoutes[i].splitterChannel->enableBatching(watermarkKB*1024);
+	}
+	if(!bWasFlushing)
+	{
+		ofAddListener(ofEvents.update, this, &ofxLogger::_onUpdate);
+		ofAddListener(ofEvents.exit, this, &ofxLogger::_onExit);
+	}
+}
+
+void ofxLogger::disableFrameFlush()
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	if(!config.current()->bFrameFlush)
+	{
+		return;
+	}
+	_setFlag(&ofxLogConfig::bFrameFlush, false);
+	ofRemoveListener(ofEvents.update, this, &ofxLogger::_onUpdate);
+	ofRemoveListener(ofEvents.exit, this, &ofxLogger::_onExit);
+
+	// what's waiting is written as the batching stops
+	splitterChannel->disableBatching();
+	for(unsigned int i = 0; i < topicRoutes.size(); ++i)
+	{
+		topicRoutes[i].splitterChannel->disableBatching();
+	}
+	consoleChannel->disableManualFlush();
+	consoleChannel->setBufferSize(consoleBufferSizeKB);
+}
+
+bool ofxLogger::usingFrameFlush()
+{
+	return _getFlag(&ofxLogConfig::bFrameFlush);
+}
+
 //----------------------------------------------
 void ofxLogger::setFilePath(const string& file)
 {
@@ -144,347 +432,1580 @@ string ofxLogger::getFilePath()
 
 void ofxLogger::enableFile()
 {
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	if(config.current()->bFile)
+	{
+		return;
+	}
+	ofLogLevel level = config.current()->sinkLevels[OFX_LOG_SINK_FILE];
 	fileChannel->open();
-	splitterChannel->addChannel(fileChannel);
-	bFile = true;
+	splitterChannel->addChannel(fileChannel, level);
+	for(unsigned int i = 0; i < topicRoutes.size(); ++i)
+	{
+		topicRoutes[i].fileChannel->open();
+		topicRoutes[i].splitterChannel->addChannel(topicRoutes[i].fileChannel, level);
+	}
+	_setFlag(&ofxLogConfig::bFile, true);
 }
 
 void ofxLogger::disableFile()
 {
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	if(!config.current()->bFile)
+	{
+		return;
+	}
+	splitterChannel->removeChannel(fileChannel);
 	fileChannel->close();
-	splitterChannel->addChannel(fileChannel);
-	bFile = false;
+	for(unsigned int i = 0; i < topicRoutes.size(); ++i)
+	{
+		topicRoutes[i].splitterChannel->removeChannel(topicRoutes[i].fileChannel);
+		topicRoutes[i].fileChannel->close();
+	}
+	_setFlag(&ofxLogConfig::bFile, false);
 }
 
 bool ofxLogger::usingFile()
 {
-	return bFile;
+	return _getFlag(&ofxLogConfig::bFile);
+}
+
+//-----------------------------------------------------------------------
+void ofxLogger::enableCompressedFile()
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	if(config.current()->bCompressedFile)
+	{
+		return;
+	}
+	compressedFileChannel->open();
+	if(!compressedFileChannel->isOpen())
+	{
+		log(OF_LOG_ERROR, "couldn't open compressed log file \""+getCompressedFilePath()+"\"");
+		return;
+	}
+	_addChannel(compressedFileChannel, OFX_LOG_SINK_COMPRESSED_FILE);
+	_setFlag(&ofxLogConfig::bCompressedFile, true);
+}
+
+void ofxLogger::disableCompressedFile()
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	if(!config.current()->bCompressedFile)
+	{
+		return;
+	}
+	_removeChannel(compressedFileChannel);
+	compressedFileChannel->close();
+	_setFlag(&ofxLogConfig::bCompressedFile, false);
+}
+
+bool ofxLogger::usingCompressedFile()
+{
+	return _getFlag(&ofxLogConfig::bCompressedFile);
+}
+
+void ofxLogger::setCompressedFilePath(const string& file)
+{
+	compressedFileChannel->setPath(file);
+}
+
+string ofxLogger::getCompressedFilePath()
+{
+	return compressedFileChannel->getPath();
+}
+
+void ofxLogger::setCompressedFileBlockSize(unsigned int sizeKB)
+{
+	compressedFileChannel->setBlockSize(sizeKB);
+}
+
+//-----------------------------------------------------------------------
+void ofxLogger::enableTrace()
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	if(config.current()->bTrace)
+	{
+		return;
+	}
+	traceChannel->open();
+	if(!traceChannel->isOpen())
+	{
+		log(OF_LOG_ERROR, "couldn't open trace file \""+getTracePath()+"\"");
+		return;
+	}
+	_addChannel(traceChannel, OFX_LOG_SINK_TRACE);
+	_setFlag(&ofxLogConfig::bTrace, true);
+}
+
+void ofxLogger::disableTrace()
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	if(!config.current()->bTrace)
+	{
+		return;
+	}
+	_removeChannel(traceChannel);
+	traceChannel->close();
+	_setFlag(&ofxLogConfig::bTrace, false);
+}
+
+bool ofxLogger::usingTrace()
+{
+	return _getFlag(&ofxLogConfig::bTrace);
+}
+
+void ofxLogger::setTracePath(const string& file)
+{
+	traceChannel->setPath(file);
+}
+
+string ofxLogger::getTracePath()
+{
+	return traceChannel->getPath();
 }
 
 //-----------------------------------------------------------------------
 void ofxLogger::enableFileRotationMins(unsigned int minutes)
 {
-	fileChannel->setProperty("rotation", ofToString(minutes)+" minutes");
+	_setFileProperty("rotation", ofToString(minutes)+" minutes");
 }
 
 void ofxLogger::enableFileRotationHours(unsigned int hours)
 {
-	fileChannel->setProperty("rotation", ofToString(hours)+" hours");
+	_setFileProperty("rotation", ofToString(hours)+" hours");
 }
 
 void ofxLogger::enableFileRotationDays(unsigned int days)
 {
-	fileChannel->setProperty("rotation", ofToString(days)+" days");
+	_setFileProperty("rotation", ofToString(days)+" days");
 }
 
 void ofxLogger::enableFileRotationMonths(unsigned int months)
 {
-	fileChannel->setProperty("rotation", ofToString(months)+" months");
+	_setFileProperty("rotation", ofToString(months)+" months");
 }
 
 void ofxLogger::enableFileRotationSize(unsigned int sizeKB)
 {
-	fileChannel->setProperty("rotation", ofToString(sizeKB)+" K");
+	_setFileProperty("rotation", ofToString(sizeKB)+" K");
 }
 
 void ofxLogger::disableFileRotation()
 {
-	fileChannel->setProperty("rotation", "never");
+	_setFileProperty("rotation", "never");
 }
 
 //--------------------------------------------------------------------------------
 void ofxLogger::setFileRotationMaxNum(unsigned int num)
 {
-	fileChannel->setProperty("purgeCount", ofToString(num));
+	_setFileProperty("purgeCount", ofToString(num));
 }
 
 //--------------------------------------------------------------------------------
 void ofxLogger::setFileRotationNumber()
 {
-	fileChannel->setProperty("archive", "number");
+	_setFileProperty("archive", "number");
 }
 
 void ofxLogger::setFileRotationTimestamp()
 {
-	fileChannel->setProperty("archive", "timestamp");
+	_setFileProperty("archive", "timestamp");
+}
+
+//--------------------------------------------------------------------------------
+void ofxLogger::enableSocket(const string& path)
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	socketChannel->setPath(path);
+	if(config.current()->bSocket)
+	{
+		return;
+	}
+	socketChannel->open();
+	_addChannel(socketChannel, OFX_LOG_SINK_SOCKET);
+	_setFlag(&ofxLogConfig::bSocket, true);
+}
+
+void ofxLogger::disableSocket()
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	if(!config.current()->bSocket)
+	{
+		return;
+	}
+	_removeChannel(socketChannel);
+	socketChannel->close();
+	_setFlag(&ofxLogConfig::bSocket, false);
+}
+
+bool ofxLogger::usingSocket()
+{
+	return _getFlag(&ofxLogConfig::bSocket);
+}
+
+void ofxLogger::setSocketName(const string& name)
+{
+	socketChannel->setName(name);
 }
 
 //--------------------------------------------------------------------------------
+void ofxLogger::enableSharedMemory(const string& name, unsigned int sizeKB)
+{
+	// the segment can only change while nothing is logging into it
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	disableSharedMemory();
+	sharedMemoryChannel->setName(name);
+	sharedMemoryChannel->setSize(sizeKB);
+	sharedMemoryChannel->open();
+	if(!sharedMemoryChannel->isOpen())
+	{
+		log(OF_LOG_ERROR, "couldn't open shared memory log \""+name+"\"");
+		return;
+	}
+	_addChannel(sharedMemoryChannel, OFX_LOG_SINK_SHARED_MEMORY);
+	_setFlag(&ofxLogConfig::bSharedMemory, true);
+}
+
+void ofxLogger::disableSharedMemory()
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	if(!config.current()->bSharedMemory)
+	{
+		return;
+	}
+	_removeChannel(sharedMemoryChannel);
+	sharedMemoryChannel->close();
+	_setFlag(&ofxLogConfig::bSharedMemory, false);
+}
+
+bool ofxLogger::usingSharedMemory()
+{
+	return _getFlag(&ofxLogConfig::bSharedMemory);
+}
+
 void ofxLogger::addTopic(const string& logTopic, ofLogLevel logLevel)
 {
-	try
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	if(config.current()->findTopic(logTopic))
+	{
+		log(OF_LOG_WARNING, "log topic \""+logTopic+"\" already exists");
+		return;
+	}
+	ofxLogConfig::Topic topic;
+	topic.id = ofxLogRecord::internTopic(logTopic);
+	topic.name = &ofxLogRecord::getTopicName(topic.id);
+	topic.level = logLevel;
+	topic.channel = _resolveTopicChannel(logTopic);
+
+	ofxLogConfig* next = config.copy();
+	next->topics[logTopic] = topic;
+	config.publish(next);
+}
+
+//--------------------------------------------------------------------------------
+void ofxLogger::addTopicRoute(const string& logTopic, const string& file)
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	string prefix = _routePrefix(logTopic);
+	removeTopicRoute(prefix);
+
+	TopicRoute route;
+	route.prefix = prefix;
+	route.splitterChannel = new ofxLogSplitterChannel();
+	route.fileChannel = new Poco::FileChannel(file);
+	if(splitterChannel->usingBatching())
+	{
+		route.splitterChannel->enableBatching(splitterChannel->getWatermark());
+	}
+
+	// same rotation settings as the main log file
+	const char* properties[] = {"times", "archive", "compress", "purgeCount", "rotation"};
+	for(unsigned int i = 0; i < sizeof(properties)/sizeof(properties[0]); ++i)
+	{
+		try
+		{
+			route.fileChannel->setProperty(properties[i], fileChannel->getProperty(properties[i]));
+		}
+		catch(Poco::Exception& e)
+		{
+			// not set on the main file either, keep the default
+		}
+	}
+
+	const ofxLogConfig* current = config.current();
+	const ofLogLevel* levels = current->sinkLevels;
+	if(current->bConsole)
+	{
+		route.splitterChannel->addChannel(consoleChannel, levels[OFX_LOG_SINK_CONSOLE]);
+	}
+	if(current->bFile)
+	{
+		route.fileChannel->open();
+		route.splitterChannel->addChannel(route.fileChannel, levels[OFX_LOG_SINK_FILE]);
+	}
+	if(current->bSocket)
+	{
+		route.splitterChannel->addChannel(socketChannel, levels[OFX_LOG_SINK_SOCKET]);
+	}
+	if(current->bSharedMemory)
+	{
+		route.splitterChannel->addChannel(sharedMemoryChannel, levels[OFX_LOG_SINK_SHARED_MEMORY]);
+	}
+	if(current->bCompressedFile)
+	{
+		route.splitterChannel->addChannel(compressedFileChannel, levels[OFX_LOG_SINK_COMPRESSED_FILE]);
+	}
+	if(current->bTrace)
 	{
-		Poco::Logger::create(logTopic, formattingChannel, _convertOfLogLevel(logLevel));
+		route.splitterChannel->addChannel(traceChannel, levels[OFX_LOG_SINK_TRACE]);
 	}
-	catch (Poco::ExistsException& e)
+	topicRoutes.push_back(route);
+
+	_reresolveTopics();
+}
+
+void ofxLogger::removeTopicRoute(const string& logTopic)
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	string prefix = _routePrefix(logTopic);
+	for(vector<TopicRoute>::iterator iter = topicRoutes.begin(); iter != topicRoutes.end(); ++iter)
 	{
-		log(OF_LOG_WARNING, "log topic \""+logTopic+"\" does not exist");
+		if(iter->prefix == prefix)
+		{
+			Poco::AutoPtr<ofxLogSplitterChannel> oldChannel = iter->splitterChannel;
+			Poco::AutoPtr<Poco::FileChannel> oldFile = iter->fileChannel;
+			topicRoutes.erase(iter);
+			_reresolveTopics();
+			oldChannel->flush();
+			oldFile->close();
+			return;
+		}
 	}
 }
 
 void ofxLogger::removeTopic(const string& logTopic)
 {
-	Poco::Logger::destroy(logTopic);
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	ofxLogConfig* next = config.copy();
+	next->topics.erase(logTopic);
+	config.publish(next);
 }
 
 bool ofxLogger::topicExists(const string& logTopic)
 {
-	return (bool) Poco::Logger::has(logTopic); // has returns NULL if topic not found
+	// the late lines don't look at topics
+	if(s_state.load(std::memory_order_relaxed) != RUNNING)
+	{
+		return true;
+	}
+	return ofxLogConfigHolder::Reader(config)->findTopic(logTopic) != NULL;
 }
 
 void ofxLogger::setTopicLogLevel(const string& logTopic, ofLogLevel logLevel)
 {
-	Poco::Logger* topicLogger = Poco::Logger::has(logTopic);
-	if(topicLogger)
-	{
-		topicLogger->setLevel(_convertOfLogLevel(logLevel));
-	}
-	else
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	if(!config.current()->findTopic(logTopic))
 	{
 		log(OF_LOG_WARNING, "log topic \""+logTopic+"\" not found");
+		return;
 	}
+	ofxLogConfig* next = config.copy();
+	next->topics[logTopic].level = logLevel;
+	config.publish(next);
 }
 void ofxLogger::resetTopicLogLevel(const string& logTopic)
 {
-	setTopicLogLevel(logTopic, _convertPocoLogLevel(logger->getLevel()));
+	setTopicLogLevel(logTopic, getLevel());
 }
 
 //--------------------------------------------------------
 void ofxLogger::enableHeader()
 {
-	bHeader = true;
+	_setHeaderFlag(&ofxLogConfig::bHeader, true);
 }
 
 void ofxLogger::disableHeader()
 {
-	bHeader = false;
+	_setHeaderFlag(&ofxLogConfig::bHeader, false);
 }
 
 bool ofxLogger::usingHeader()
 {
-	return bHeader;
+	return _getFlag(&ofxLogConfig::bHeader);
 }
 
 //----------------------------
 void ofxLogger::enableHeaderDate()
 {
-	bDate = true;
+	_setHeaderFlag(&ofxLogConfig::bDate, true);
 }
 void ofxLogger::disableHeaderDate()
 {
-	bDate = false;
+	_setHeaderFlag(&ofxLogConfig::bDate, false);
 }
 
 bool ofxLogger::usingHeaderDate()
 {
-	return bDate;
+	return _getFlag(&ofxLogConfig::bDate);
 }
 //----------------------------
 void ofxLogger::enableHeaderTime()
 {
-	bTime = true;
+	_setHeaderFlag(&ofxLogConfig::bTime, true);
 }
 
 void ofxLogger::disableHeaderTime()
 {
-	bTime = false;
+	_setHeaderFlag(&ofxLogConfig::bTime, false);
 }
 
 bool ofxLogger::usingHeaderTime()
 {
-	return bTime;
+	return _getFlag(&ofxLogConfig::bTime);
 }
 
 //-----------------------------
 void ofxLogger::enableHeaderFrameNum()
 {
-	bFrameNum = true;
+	_setHeaderFlag(&ofxLogConfig::bFrameNum, true);
 }
 
 void ofxLogger::disableHeaderFrameNum()
 {
-	bFrameNum = false;
+	_setHeaderFlag(&ofxLogConfig::bFrameNum, false);
 }
 
 bool ofxLogger::usingHeaderFrameNum()
 {
-	return bFrameNum;
+	return _getFlag(&ofxLogConfig::bFrameNum);
 }
 
 //-----------------------------
 void ofxLogger::enableHeaderMillis()
 {
-	bMillis = true;
+	_setHeaderFlag(&ofxLogConfig::bMillis, true);
 }
 
 void ofxLogger::disableHeaderMillis()
 {
-	bMillis = false;
+	_setHeaderFlag(&ofxLogConfig::bMillis, false);
 }
 
 bool ofxLogger::usingHeaderMillis()
 {
-	return bMillis;
+	return _getFlag(&ofxLogConfig::bMillis);
 }
 
-//---------------------------------------------------------------------------------
-void ofxLogger::_log(ofLogLevel logLevel, const string& message, Poco::Logger* theLogger)
+//-----------------------------
+void ofxLogger::setPattern(const string& pattern)
 {
-	string timestamp;
-	
-	// dispatch a simple logger event.
-	ofxLoggerEvent ev(message, logLevel);
-	ofNotifyEvent(ofxLoggerEventDispatcher, ev);
-	
-	// build the header
-	if(bHeader)
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	ofxLogConfig* next = config.copy();
+	next->pattern = new ofxLogPattern(pattern);
+	config.publish(next);
+}
+
+string ofxLogger::getPattern()
+{
+	return ofxLogConfigHolder::Reader(config)->pattern->getPattern();
+}
+
+//-----------------------------
+void ofxLogger::enableFlightRecorder(unsigned int numRecords)
+{
+	flightRecorder.setSize(numRecords);
+	_setFlag(&ofxLogConfig::bFlightRecorder, true);
+}
+
+void ofxLogger::disableFlightRecorder()
+{
+	_setFlag(&ofxLogConfig::bFlightRecorder, false);
+	flightRecorder.clear();
+}
+
+bool ofxLogger::usingFlightRecorder()
+{
+	return _getFlag(&ofxLogConfig::bFlightRecorder);
+}
+
+void ofxLogger::dumpFlightRecorder()
+{
+	ofxLogConfigHolder::Reader reader(config);
+	_dumpFlightRecorder(*reader, true);
+}
+
+//--------------------------------------------------------------
+void ofxLogger::enableCrashDump(const string& path)
+{
+	if(!ofxLogCrashHandler::install(path, &ofxLogger::_crashDump))
+	{
+		log(OF_LOG_ERROR, "couldn't open crash dump file \""+path+"\"");
+	}
+}
+
+void ofxLogger::disableCrashDump()
+{
+	ofxLogCrashHandler::uninstall();
+}
+
+bool ofxLogger::usingCrashDump()
+{
+	return ofxLogCrashHandler::isInstalled();
+}
+
+//--------------------------------------------------------------
+void ofxLogger::enableScopeReports(unsigned int seconds)
+{
+	ofxLogScope::startReports(seconds);
+}
+
+void ofxLogger::disableScopeReports()
+{
+	ofxLogScope::stopReports();
+}
+
+bool ofxLogger::usingScopeReports()
+{
+	return ofxLogScope::usingReports();
+}
+
+//--------------------------------------------------------------
+// is it one of the path keys?
+static bool isConfigPath(const pair<string, string>& value)
+{
+	const string& key = value.first;
+	return key == "filePath" || key == "socketPath" || key == "compressedFilePath" ||
+		key == "tracePath";
+}
+
+bool ofxLogger::loadConfigFile(const string& path)
+{
+	ifstream file(path.c_str());
+	if(!file)
 	{
-		Poco::LocalDateTime now;
+		log(OF_LOG_ERROR, "couldn't read log config file \""+path+"\"");
+		return false;
+	}
 
-		if(bDate && bTime)
+	// read it all first so the socket & file paths can be set before the
+	// sinks are switched on, whatever the order of the lines
+	vector<pair<string, string> > values;
+	map<string, string> keys;
+	string line;
+	while(getline(file, line))
+	{
+		Poco::trimInPlace(line);
+		if(line.empty() || line[0] == '#')
 		{
-			timestamp += Poco::DateTimeFormatter::format(now, s_dateAndTimeFormat)+" ";
+			continue;
 		}
-		else if(bDate)
+		size_t equals = line.find('=');
+		if(equals == string::npos)
 		{
-			timestamp += Poco::DateTimeFormatter::format(now, s_dateFormat)+" ";
+			log(OF_LOG_WARNING, "ignoring log config line \""+line+"\", expected key = value");
+			continue;
 		}
-		else if(bTime)
+		string key = Poco::trim(line.substr(0, equals));
+		string value = Poco::trim(line.substr(equals+1));
+		values.push_back(make_pair(key, value));
+		keys[key] = value;
+	}
+
+	// the whole file is one snapshot, the log calls carry on with the one
+	// they started with & the warnings wait until the mutex is released
+	vector<string> warnings;
+	{
+		ofxLogConfigHolder::Batch batch(config);
+
+		// the keys taken out of the file since the last load go back to
+		// their defaults, the topics follow the new global level so they go
+		// last
+		vector<string> removedTopics;
+		for(map<string, string>::const_iterator iter = configKeys.begin(); iter != configKeys.end(); ++iter)
 		{
-			timestamp += Poco::DateTimeFormatter::format(now, s_timeFormat)+" ";	
+			const string& key = iter->first;
+			if(keys.count(key))
+			{
+				continue;
+			}
+			if(key.compare(0, 6, "topic.") == 0)
+			{
+				removedTopics.push_back(key.substr(6));
+			}
+			else if(key.compare(0, 6, "route.") == 0)
+			{
+				removeTopicRoute(key.substr(6));
+			}
+			else
+			{
+				values.push_back(make_pair(key, _defaultConfigValue(key)));
+			}
 		}
 
-		if(bFrameNum)
+		// the paths are set first, before the sinks are opened with them
+		stable_partition(values.begin(), values.end(), isConfigPath);
+		for(unsigned int i = 0; i < values.size(); ++i)
 		{
-			timestamp += ofToString(ofGetFrameNum())+" ";
-		}
+			const string& key = values[i].first;
+			if(isConfigPath(values[i]) && !configPaths.count(key))
+			{
+				configPaths[key] = _defaultConfigValue(key);
+			}
 
-		if(bMillis)
+			// only what changed is applied, saving the file again mustn't
+			// restart the format workers, reopen the routes, reinstall the
+			// crash handler, ...
+			if(_isConfigValueCurrent(key, values[i].second))
+			{
+				continue;
+			}
+			if(!_applyConfigValue(key, values[i].second, warnings))
+			{
+				warnings.push_back("unknown log config setting \""+key+"\" in \""+path+"\"");
+				keys.erase(key);
+			}
+		}
+		for(unsigned int i = 0; i < removedTopics.size(); ++i)
 		{
-			timestamp += ofToString(ofGetElapsedTimeMillis())+" ";
+			if(config.current()->findTopic(removedTopics[i]))
+			{
+				setTopicLogLevel(removedTopics[i], config.current()->root.level);
+			}
 		}
+		configKeys.swap(keys);
 	}
 
-	// log the message
-	//
-	// Each log call is wrapped in a try / catch in case the logger is called
-	// when it has already been destroyed. This can happen if it is used in
-	// another destructor as the destruction order is not predictabale.
-	//
-	switch(logLevel)
+	for(unsigned int i = 0; i < warnings.size(); ++i)
 	{
-		case OF_LOG_SILENT:
-			break;
+		log(OF_LOG_WARNING, warnings[i]);
+	}
+	log(OF_LOG_VERBOSE, "loaded log config file \""+path+"\"");
+	return true;
+}
 
-		case OF_LOG_VERBOSE:
-			try
-			{
-				theLogger->trace(timestamp+"OF_VERBOSE: "+message);
-			}
-			catch(...)
-			{
-				_logDestroyed("OF_VERBOSE: "+message);
-			}
+void ofxLogger::watchConfigFile(const string& path)
+{
+	loadConfigFile(path);
+	configWatcher.start(path, &ofxLogger::_reloadConfigFile);
+}
+
+void ofxLogger::unwatchConfigFile()
+{
+	configWatcher.stop();
+}
+
+bool ofxLogger::watchingConfigFile()
+{
+	return configWatcher.isRunning();
+}
+
+//--------------------------------------------------------------
+ofxLogPool::Stats ofxLogger::getPoolStats()
+{
+	return ofxLogPool::getStats();
+}
+
+//---------------------------------------------------------------------------------
+void ofxLogger::enableFormatWorkers(unsigned int numWorkers, unsigned int numQueued)
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	disableFormatWorkers();
+	formatPool.start(numWorkers, numQueued);
+	_setFlag(&ofxLogConfig::bFormatWorkers, true);
+}
+
+void ofxLogger::disableFormatWorkers()
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	if(!config.current()->bFormatWorkers)
+	{
+		return;
+	}
+	// lines logged while stopping fall back to formatting on their thread
+	_setFlag(&ofxLogConfig::bFormatWorkers, false);
+	formatPool.stop();
+}
+
+bool ofxLogger::usingFormatWorkers()
+{
+	return _getFlag(&ofxLogConfig::bFormatWorkers);
+}
+
+//---------------------------------------------------------------------------------
+void ofxLogger::setSiteMode(const string& file, int line, ofxLogSite::Mode mode)
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+
+	// the latest rule for a file & line replaces the earlier one
+	for(vector<SiteRule>::iterator iter = siteRules.begin(); iter != siteRules.end(); ++iter)
+	{
+		if(iter->file == file && iter->line == line)
+		{
+			siteRules.erase(iter);
 			break;
+		}
+	}
+	if(mode != ofxLogSite::DEFAULT)
+	{
+		SiteRule rule;
+		rule.file = file;
+		rule.line = line;
+		rule.mode = mode;
+		siteRules.push_back(rule);
+	}
 
-		case OF_LOG_NOTICE:
-			try
+	vector<ofxLogSite*> sites = ofxLogSite::findSites(file, line);
+	for(unsigned int i = 0; i < sites.size(); ++i)
+	{
+		sites[i]->_setMode(mode, *config.current());
+	}
+}
+
+void ofxLogger::setSiteMode(ofxLogSite& site, ofxLogSite::Mode mode)
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	site._setMode(mode, *config.current());
+}
+
+vector<ofxLogSite*> ofxLogger::getSites()
+{
+	return ofxLogSite::getSites();
+}
+
+//---------------------------------------------------------------------------------
+void ofxLogger::_log(const ofxLogConfig& config, ofLogLevel logLevel, const char* message,
+					 std::size_t size, const ofxLogConfig::Topic& topic, const ofxLogSite* site)
+{
+	Poco::Timestamp now;
+	int frameNum = ofGetFrameNum();
+	unsigned long millis = ofGetElapsedTimeMillis();
+	
+	// the line is only built if at least one sink is going to print it, a
+	// site that's switched on is printed whatever the topic level
+	bool bPrint = (ofxLogConfig::isPrinted(topic, logLevel) ||
+		(logLevel != OF_LOG_SILENT && site && site->getMode() == ofxLogSite::ON)) &&
+		logLevel >= config.printLevel;
+	bool bListen = logLevel != OF_LOG_SILENT && logLevel >= config.sinkLevels[OFX_LOG_SINK_LISTENERS];
+	bool bRecord = config.bFlightRecorder && logLevel <= OF_LOG_NOTICE;
+	
+	// nothing takes the message, don't build a record
+	if(!bPrint && !bRecord && !(bListen && config.bListeners))
+	{
+		return;
+	}
+	
+	// queue the line for the format workers, errors are written right away
+	// after the lines queued before them
+	ofxLogBuffer line;
+	bool bError = logLevel == OF_LOG_ERROR || logLevel == OF_LOG_FATAL_ERROR;
+	if(config.bFormatWorkers)
+	{
+		if(bPrint && !bError)
+		{
+			// the listeners are called here like on the direct path, the
+			// line is built into the record's room later on
+			Poco::AutoPtr<ofxLogRecord> record(ofxLogRecord::createUnformatted(logLevel, topic.id,
+				*topic.name, message, size, size+topic.name->size()+s_headerRoom, now, frameNum,
+				millis, site));
+			if(bListen)
 			{
-				theLogger->notice(timestamp+message);
+				ofxLoggerEvent ev(record);
+				ofNotifyEvent(ofxLoggerEventDispatcher, ev);
 			}
-			catch(...)
+			if(formatPool.push(record, config.pattern, topic.channel))
 			{
-				_logDestroyed(message);
+				return;
 			}
-			break;
 
-		case OF_LOG_WARNING:
-			try
+			// the pool is stopping (or this is its writer thread), the lines
+			// it still has go first
+			formatPool.drain();
+			config.pattern->format(line, logLevel, *topic.name, message, size, now, frameNum,
+				millis, ofxLogRecord::currentThreadId());
+			record->setLine(line.c_str(), line.size());
+			topic.channel->log(*record);
+			return;
+		}
+		if(bError)
+		{
+			formatPool.drain();
+		}
+	}
+	
+	if(bPrint)
+	{
+		config.pattern->format(line, logLevel, *topic.name, message, size, now, frameNum,
+			millis, ofxLogRecord::currentThreadId());
+	}
+	
+	// the one copy of the message that's shared from here on
+	Poco::AutoPtr<ofxLogRecord> record(ofxLogRecord::create(logLevel, topic.id, *topic.name,
+		message, size, line.c_str(), line.size(), now, frameNum, millis, site));
+	
+	// dispatch a simple logger event.
+	if(bListen)
+	{
+		ofxLoggerEvent ev(record);
+		ofNotifyEvent(ofxLoggerEventDispatcher, ev);
+	}
+	
+	// keep what would be dropped in the flight recorder & write it out
+	// before an error so it shows up as context
+	if(config.bFlightRecorder)
+	{
+		if(logLevel <= OF_LOG_NOTICE && !bPrint)
+		{
+			flightRecorder.record(*record);
+			return;
+		}
+		else if(logLevel == OF_LOG_ERROR || logLevel == OF_LOG_FATAL_ERROR)
+		{
+			_dumpFlightRecorder(config, false);
+		}
+	}
+	
+	if(!bPrint)
+	{
+		return;
+	}
+
+	// log the record, lines logged after the shutdown don't get here
+	topic.channel->log(*record);
+}
+
+void ofxLogger::_registerSite(ofxLogSite& site)
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	for(unsigned int i = 0; i < siteRules.size(); ++i)
+	{
+		// a line rule is more specific than a whole file rule
+		if(site.matches(siteRules[i].file, siteRules[i].line) &&
+		   (site.getMode() == ofxLogSite::DEFAULT || siteRules[i].line != 0))
+		{
+			site.mode.store(siteRules[i].mode, std::memory_order_relaxed);
+		}
+	}
+	site._register(*config.current());
+}
+
+bool ofxLogger::_isEnabled(const ofxLogConfig& config, ofLogLevel logLevel,
+						   const ofxLogConfig::Topic& topic)
+{
+	if(logLevel == OF_LOG_SILENT)
+	{
+		return false;
+	}
+	if(config.bFlightRecorder && logLevel <= OF_LOG_NOTICE)
+	{
+		return true;
+	}
+	return config.isAccepted(topic, logLevel) || config.isHeard(logLevel);
+}
+
+void ofxLogger::_addChannel(Poco::Channel* channel, ofxLogSink sink)
+{
+	ofLogLevel level = config.current()->sinkLevels[sink];
+	splitterChannel->addChannel(channel, level);
+	for(unsigned int i = 0; i < topicRoutes.size(); ++i)
+	{
+		topicRoutes[i].splitterChannel->addChannel(channel, level);
+	}
+}
+
+void ofxLogger::_removeChannel(Poco::Channel* channel)
+{
+	splitterChannel->removeChannel(channel);
+	for(unsigned int i = 0; i < topicRoutes.size(); ++i)
+	{
+		topicRoutes[i].splitterChannel->removeChannel(channel);
+	}
+}
+
+Poco::Channel* ofxLogger::_sinkChannel(ofxLogSink sink)
+{
+	switch(sink)
+	{
+		case OFX_LOG_SINK_CONSOLE:			return consoleChannel;
+		case OFX_LOG_SINK_FILE:				return fileChannel;
+		case OFX_LOG_SINK_COMPRESSED_FILE:	return compressedFileChannel;
+		case OFX_LOG_SINK_SOCKET:			return socketChannel;
+		case OFX_LOG_SINK_SHARED_MEMORY:	return sharedMemoryChannel;
+		case OFX_LOG_SINK_TRACE:			return traceChannel;
+		default:							return NULL;
+	}
+}
+
+void ofxLogger::_changeNumListeners(int change)
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	numListeners = std::max(numListeners+change, 0);
+	if((numListeners > 0) != config.current()->bListeners)
+	{
+		_setFlag(&ofxLogConfig::bListeners, numListeners > 0);
+	}
+}
+
+void ofxLogger::_setFileProperty(const string& name, const string& value)
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	fileChannel->setProperty(name, value);
+	for(unsigned int i = 0; i < topicRoutes.size(); ++i)
+	{
+		topicRoutes[i].fileChannel->setProperty(name, value);
+	}
+}
+
+string ofxLogger::_routePrefix(const string& logTopic)
+{
+	// "net.*" is the same as "net"
+	if(logTopic.size() >= 2 && logTopic.compare(logTopic.size()-2, 2, ".*") == 0)
+	{
+		return logTopic.substr(0, logTopic.size()-2);
+	}
+	return logTopic;
+}
+
+ofxLogSplitterChannel* ofxLogger::_resolveTopicChannel(const string& logTopic)
+{
+	// the longest matching prefix wins
+	const TopicRoute* best = NULL;
+	for(unsigned int i = 0; i < topicRoutes.size(); ++i)
+	{
+		const string& prefix = topicRoutes[i].prefix;
+		if(logTopic.compare(0, prefix.size(), prefix) == 0 &&
+		   (logTopic.size() == prefix.size() || logTopic[prefix.size()] == '.') &&
+		   (!best || prefix.size() > best->prefix.size()))
+		{
+			best = &topicRoutes[i];
+		}
+	}
+	if(best)
+	{
+		return best->splitterChannel;
+	}
+	return splitterChannel;
+}
+
+void ofxLogger::_reresolveTopics()
+{
+	ofxLogConfig* next = config.copy();
+	for(map<string, ofxLogConfig::Topic>::iterator iter = next->topics.begin();
+		iter != next->topics.end(); ++iter)
+	{
+		iter->second.channel = _resolveTopicChannel(iter->first);
+	}
+	config.publish(next);
+}
+
+void ofxLogger::_setFlag(bool ofxLogConfig::* flag, bool value)
+{
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	ofxLogConfig* next = config.copy();
+	next->*flag = value;
+	config.publish(next);
+}
+
+bool ofxLogger::_getFlag(bool ofxLogConfig::* flag)
+{
+	ofxLogConfigHolder::Reader reader(config);
+	return (*reader).*flag;
+}
+
+void ofxLogger::_setHeaderFlag(bool ofxLogConfig::* flag, bool value)
+{
+	// the header toggles are presets, they replace a custom pattern
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	ofxLogConfig* next = config.copy();
+	next->*flag = value;
+	next->pattern = new ofxLogPattern(_presetPattern(*next));
+	config.publish(next);
+}
+
+string ofxLogger::_presetPattern(const ofxLogConfig& config)
+{
+	string pattern;
+	if(config.bHeader)
+	{
+		if(config.bDate)
+		{
+			pattern += "%Y-%m-%d ";
+		}
+		if(config.bTime)
+		{
+			pattern += "%H:%M:%S.%i ";
+		}
+		if(config.bFrameNum)
+		{
+			pattern += "%F ";
+		}
+		if(config.bMillis)
+		{
+			pattern += "%E ";
+		}
+	}
+	pattern += "%l%P%t";
+	return pattern;
+}
+
+// parses a config level, returns false if it isn't one
+static bool parseConfigLevel(const string& value, ofLogLevel& level)
+{
+	string name = Poco::toLower(value);
+	for(int i = 0; i < OF_LOG_SILENT; ++i)
+	{
+		if(name == ofxLogPattern::s_levelNames[i])
+		{
+			level = (ofLogLevel) i;
+			return true;
+		}
+	}
+	if(name == "silent")
+	{
+		level = OF_LOG_SILENT;
+		return true;
+	}
+	return false;
+}
+
+// parses a config switch, returns false if it isn't one
+static bool parseConfigBool(const string& value, bool& b)
+{
+	string name = Poco::toLower(value);
+	if(name == "on" || name == "true" || name == "yes" || name == "1")
+	{
+		b = true;
+		return true;
+	}
+	if(name == "off" || name == "false" || name == "no" || name == "0")
+	{
+		b = false;
+		return true;
+	}
+	return false;
+}
+
+bool ofxLogger::_isConfigValueCurrent(const string& key, const string& value)
+{
+	// new or changed in the file
+	map<string, string>::const_iterator last = configKeys.find(key);
+	if(last == configKeys.end() || last->second != value)
+	{
+		return false;
+	}
+
+	// the same as the last load, but the app may have changed the setting
+	// since, so it has to match the current snapshot as well
+	const ofxLogConfig& current = *config.current();
+	bool b;
+	bool bOn = !(parseConfigBool(value, b) && !b);
+	if(key == "filePath")			return getFilePath() == value;
+	if(key == "socketPath")			return socketChannel->getPath() == value;
+	if(key == "compressedFilePath")	return getCompressedFilePath() == value;
+	if(key == "tracePath")			return getTracePath() == value;
+	if(key == "pattern")			return current.pattern->getPattern() == value;
+	if(key == "socket")				return current.bSocket == bOn;	// enabling reconnects
+	if(key == "formatWorkers")		return current.bFormatWorkers == bOn;
+	if(key == "frameFlush")			return current.bFrameFlush == bOn;
+	if(key == "flightRecorder")		return current.bFlightRecorder == bOn;
+	if(key == "crashDump")			return usingCrashDump() == bOn;
+	if(key == "scopeReports")		return usingScopeReports() == bOn;
+	if(key.compare(0, 6, "route.") == 0)
+	{
+		string prefix = _routePrefix(key.substr(6));
+		for(unsigned int i = 0; i < topicRoutes.size(); ++i)
+		{
+			if(topicRoutes[i].prefix == prefix)
 			{
-				theLogger->warning(timestamp+"OF_WARNING: "+message);
+				return topicRoutes[i].fileChannel->getProperty("path") == value;
 			}
-			catch(...)
+		}
+		return false;
+	}
+
+	// the levels & the other switches are cheap to set again & skip what
+	// doesn't change themselves
+	return false;
+}
+
+string ofxLogger::_defaultConfigValue(const string& key)
+{
+	// the paths go back to what they were before the file set them
+	map<string, string>::const_iterator path = configPaths.find(key);
+	if(path != configPaths.end())
+	{
+		return path->second;
+	}
+	if(key == "filePath")			return getFilePath();
+	if(key == "socketPath")			return socketChannel->getPath();
+	if(key == "compressedFilePath")	return getCompressedFilePath();
+	if(key == "tracePath")			return getTracePath();
+
+	// the rest go back to the first snapshot's settings
+	const ofxLogConfig defaults;
+	if(key == "level")
+	{
+		return ofxLogPattern::s_levelNames[defaults.root.level];
+	}
+	if(key.compare(0, 6, "level.") == 0)
+	{
+		return ofxLogPattern::s_levelNames[defaults.sinkLevels[0]];
+	}
+	if(key.compare(0, 5, "site.") == 0)
+	{
+		return "default";
+	}
+	if(key == "pattern")
+	{
+		return _presetPattern(*config.current());
+	}
+	const bool* flag = NULL;
+	if(key == "console")				flag = &defaults.bConsole;
+	else if(key == "header")			flag = &defaults.bHeader;
+	else if(key == "headerDate")		flag = &defaults.bDate;
+	else if(key == "headerTime")		flag = &defaults.bTime;
+	else if(key == "headerFrameNum")	flag = &defaults.bFrameNum;
+	else if(key == "headerMillis")		flag = &defaults.bMillis;
+	return flag && *flag ? "on" : "off";
+}
+
+bool ofxLogger::_applyConfigValue(const string& key, const string& value,
+								   vector<string>& warnings)
+{
+	// the sink levels
+	if(key.compare(0, 6, "level.") == 0)
+	{
+		const char* sinks[] = {"console", "file", "compressedFile", "socket",
+			"sharedMemory", "trace", "listeners"};
+		ofLogLevel level;
+		for(int i = 0; i < OFX_LOG_NUM_SINKS; ++i)
+		{
+			if(key.compare(6, string::npos, sinks[i]) != 0)
 			{
-				_logDestroyed("OF_WARNING: "+message);
+				continue;
 			}
-			break;
-
-		case OF_LOG_ERROR:
-			try
+			if(parseConfigLevel(value, level))
 			{
-				theLogger->error(timestamp+"OF_ERROR: "+message);
+				setSinkLevel((ofxLogSink) i, level);
 			}
-			catch(...)
+			else
 			{
-				_logDestroyed("OF_ERROR: "+message);
+				warnings.push_back("unknown log level \""+value+"\" for \""+key+"\"");
 			}
-			break;
+			return true;
+		}
+		return false;
+	}
+
+	// the level & topic keys
+	if(key == "level" || key.compare(0, 6, "topic.") == 0)
+	{
+		ofLogLevel level;
+		if(!parseConfigLevel(value, level))
+		{
+			warnings.push_back("unknown log level \""+value+"\" for \""+key+"\"");
+			return true;
+		}
+		if(key == "level")
+		{
+			setLevel(level);
+		}
+		else if(config.current()->findTopic(key.substr(6)))
+		{
+			setTopicLogLevel(key.substr(6), level);
+		}
+		else
+		{
+			addTopic(key.substr(6), level);
+		}
+		return true;
+	}
 
-		case OF_LOG_FATAL_ERROR:
-			try
+	// the keys with text values
+	if(key == "filePath")
+	{
+		setFilePath(value);
+		return true;
+	}
+	if(key == "socketPath")
+	{
+		socketChannel->setPath(value);
+		return true;
+	}
+	if(key == "compressedFilePath")
+	{
+		setCompressedFilePath(value);
+		return true;
+	}
+	if(key == "tracePath")
+	{
+		setTracePath(value);
+		return true;
+	}
+	if(key == "pattern")
+	{
+		setPattern(value);
+		return true;
+	}
+	if(key.compare(0, 6, "route.") == 0)
+	{
+		addTopicRoute(key.substr(6), value);
+		return true;
+	}
+	if(key.compare(0, 5, "site.") == 0)
+	{
+		// site.file:line, the line is optional
+		string site = key.substr(5);
+		size_t colon = site.rfind(':');
+		int line = 0;
+		if(colon != string::npos)
+		{
+			line = ofToInt(site.substr(colon+1));
+			site = site.substr(0, colon);
+		}
+		bool b;
+		if(value == "default")
+		{
+			setSiteMode(site, line, ofxLogSite::DEFAULT);
+		}
+		else if(parseConfigBool(value, b))
+		{
+			setSiteMode(site, line, b ? ofxLogSite::ON : ofxLogSite::OFF);
+		}
+		else
+		{
+			warnings.push_back("expected on, off or default for \""+key+"\", got \""+value+"\"");
+		}
+		return true;
+	}
+	if(key == "scopeReports")
+	{
+		bool b;
+		int seconds = ofToInt(value);
+		if(parseConfigBool(value, b) && !b)
+		{
+			disableScopeReports();
+		}
+		else if(seconds > 0)
+		{
+			enableScopeReports(seconds);
+		}
+		else
+		{
+			warnings.push_back("expected off or a number for \"scopeReports\", got \""+value+"\"");
+		}
+		return true;
+	}
+	if(key == "formatWorkers")
+	{
+		bool b;
+		int numWorkers = ofToInt(value);
+		if(parseConfigBool(value, b) && !b)
+		{
+			disableFormatWorkers();
+		}
+		else if(numWorkers > 0)
+		{
+			enableFormatWorkers(numWorkers);
+		}
+		else if(parseConfigBool(value, b))
+		{
+			enableFormatWorkers();
+		}
+		else
+		{
+			warnings.push_back("expected off, on or a number for \"formatWorkers\", got \""+value+"\"");
+		}
+		return true;
+	}
+	if(key == "crashDump")
+	{
+		bool b;
+		if(parseConfigBool(value, b))
+		{
+			if(b)
 			{
-				theLogger->fatal(timestamp+"OF_FATAL_ERROR: "+message);
+				enableCrashDump();
 			}
-			catch(...)
+			else
 			{
-				_logDestroyed("OF_FATAL_ERROR: "+message);
+				disableCrashDump();
 			}
-			break;
+		}
+		else
+		{
+			enableCrashDump(value);
+		}
+		return true;
+	}
+	if(key == "frameFlush")
+	{
+		bool b;
+		int numFrames = ofToInt(value);
+		if(parseConfigBool(value, b) && !b)
+		{
+			disableFrameFlush();
+		}
+		else if(numFrames > 0)
+		{
+			enableFrameFlush(numFrames);
+		}
+		else if(parseConfigBool(value, b))
+		{
+			enableFrameFlush();
+		}
+		else
+		{
+			warnings.push_back("expected off, on or a number for \"frameFlush\", got \""+value+"\"");
+		}
+		return true;
+	}
+	if(key == "flightRecorder")
+	{
+		bool b;
+		int numRecords = ofToInt(value);
+		if(parseConfigBool(value, b) && !b)
+		{
+			disableFlightRecorder();
+		}
+		else if(numRecords > 0)
+		{
+			enableFlightRecorder(numRecords);
+		}
+		else
+		{
+			warnings.push_back("expected off or a number for \"flightRecorder\", got \""+value+"\"");
+		}
+		return true;
+	}
+
+	// the switches
+	void (ofxLogger::*enable)() = NULL;
+	void (ofxLogger::*disable)() = NULL;
+	if(key == "console")			{enable = &ofxLogger::enableConsole; disable = &ofxLogger::disableConsole;}
+	else if(key == "file")			{enable = &ofxLogger::enableFile; disable = &ofxLogger::disableFile;}
+	else if(key == "compressedFile"){enable = &ofxLogger::enableCompressedFile; disable = &ofxLogger::disableCompressedFile;}
+	else if(key == "trace")			{enable = &ofxLogger::enableTrace; disable = &ofxLogger::disableTrace;}
+	else if(key == "sharedMemory")	{disable = &ofxLogger::disableSharedMemory;}
+	else if(key == "socket")		{disable = &ofxLogger::disableSocket;}
+	else if(key == "header")		{enable = &ofxLogger::enableHeader; disable = &ofxLogger::disableHeader;}
+	else if(key == "headerDate")	{enable = &ofxLogger::enableHeaderDate; disable = &ofxLogger::disableHeaderDate;}
+	else if(key == "headerTime")	{enable = &ofxLogger::enableHeaderTime; disable = &ofxLogger::disableHeaderTime;}
+	else if(key == "headerFrameNum"){enable = &ofxLogger::enableHeaderFrameNum; disable = &ofxLogger::disableHeaderFrameNum;}
+	else if(key == "headerMillis")	{enable = &ofxLogger::enableHeaderMillis; disable = &ofxLogger::disableHeaderMillis;}
+	else
+	{
+		return false;
+	}
+
+	bool b;
+	if(!parseConfigBool(value, b))
+	{
+		warnings.push_back("expected on or off for \""+key+"\", got \""+value+"\"");
+		return true;
+	}
+	if(!b)
+	{
+		(this->*disable)();
+	}
+	else if(key == "socket")
+	{
+		enableSocket(socketChannel->getPath());
+	}
+	else if(key == "sharedMemory")
+	{
+		// reopening would drop what the readers haven't seen yet
+		if(!config.current()->bSharedMemory)
+		{
+			enableSharedMemory();
+		}
+	}
+	else
+	{
+		(this->*enable)();
+	}
+	return true;
+}
+
+void ofxLogger::_reloadConfigFile(const string& path)
+{
+	instance().loadConfigFile(path);
+}
+
+void ofxLogger::_dumpFlightRecorder(const ofxLogConfig& config, bool allThreads)
+{
+	vector<ofxLogFlightRecorder::Entry> entries;
+	flightRecorder.drain(entries, allThreads);
+	if(entries.empty())
+	{
+		return;
+	}
+
+	// the recorded messages bypass the topic loggers as they have already
+	// been filtered, so write straight to the file or all channels, after
+	// the file lines that are still batched
+	splitterChannel->flush();
+	Poco::Channel* channel = config.bFile ? (Poco::Channel*) fileChannel : (Poco::Channel*) splitterChannel;
+
+	channel->log(Poco::Message("", "---------- flight recorder: "+
+		ofToString(entries.size())+" messages ----------", Poco::Message::PRIO_NOTICE));
+	for(unsigned int i = 0; i < entries.size(); ++i)
+	{
+		const ofxLogFlightRecorder::Entry& entry = entries[i];
+
+		// the topic is already part of the recorded message
+		ofxLogBuffer line;
+		config.pattern->format(line, entry.level, ofxLogRecord::getTopicName(0), entry.message.data(),
+			entry.message.size(), entry.time, entry.frameNum, entry.millis, entry.threadId);
+
+		channel->log(Poco::Message("", line.str(),
+			(Poco::Message::Priority) ofxLogRecord::toPriority(entry.level)));
+	}
+	channel->log(Poco::Message("", "---------- end flight recorder ----------",
+		Poco::Message::PRIO_NOTICE));
+}
+
+//--------------------------------------------------------------
+void ofxLogger::_onUpdate(ofEventArgs& args)
+{
+	// the lines of the frame(s) that just ended
+	if(++frameFlushCount < ofxLogConfigHolder::Reader(config)->frameFlushFrames)
+	{
+		return;
+	}
+	frameFlushCount = 0;
+	_flushBatches();
+	if(consoleChannel->usingNonBlocking())
+	{
+		consoleChannel->flushInBackground();
+	}
+	else
+	{
+		consoleChannel->flush();
 	}
 }
 
-void ofxLogger::_logDestroyed(const string& message)
+void ofxLogger::_onExit(ofEventArgs& args)
 {
-	printf("----------\n");
-	printf("\tHey ... don't call ofxLog in a destructor!\n");
-	printf("\t%s\n", message.c_str());
-	printf("----------\n");
+	flush();
 }
 
-ofLogLevel ofxLogger::_convertPocoLogLevel(const int level)
+void ofxLogger::_flushBatches()
 {
-	switch(level)
+	splitterChannel->flush();
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	for(unsigned int i = 0; i < topicRoutes.size(); ++i)
 	{
-		case Poco::Message::PRIO_TRACE:
-			return OF_LOG_VERBOSE;
-			
-		case Poco::Message::PRIO_NOTICE:
-			return OF_LOG_NOTICE;
-			
-		case Poco::Message::PRIO_WARNING:
-			return OF_LOG_WARNING;
-			
-		case Poco::Message::PRIO_ERROR:
-			return OF_LOG_ERROR;
-			
-		case Poco::Message::PRIO_FATAL:
-			return OF_LOG_FATAL_ERROR;
-			
-		case -1:
-			return OF_LOG_SILENT;
+		topicRoutes[i].splitterChannel->flush();
 	}
 }
 
-int ofxLogger::_convertOfLogLevel(const ofLogLevel level)
+//--------------------------------------------------------------
+void ofxLogger::_crashDump(int fd)
 {
-	switch(level)
+	// in a signal handler, the buffers are read as they are without locking
+	ofxLogger& logger = instance();
+	const ofxLogConfig* config = logger.config.current();
+	if(config->bFlightRecorder)
+	{
+		ofxLogCrashHandler::write(fd, "---------- flight recorder ----------\n");
+		logger.flightRecorder.crashDump(fd);
+	}
+	if(config->bFormatWorkers)
+	{
+		ofxLogCrashHandler::write(fd, "---------- queued for the format workers ----------\n");
+		logger.formatPool.crashDump(fd);
+	}
+	if(config->bFrameFlush && config->bFile)
+	{
+		ofxLogCrashHandler::write(fd, "---------- batched for the log files ----------\n");
+		logger.splitterChannel->crashDump(fd);
+		for(unsigned int i = 0; i < logger.topicRoutes.size(); ++i)
+		{
+			logger.topicRoutes[i].splitterChannel->crashDump(fd);
+		}
+	}
+	if(config->bConsole)
+	{
+		ofxLogCrashHandler::write(fd, "---------- buffered for the console ----------\n");
+		logger.consoleChannel->crashDump(fd);
+	}
+	if(config->bCompressedFile)
 	{
-		case OF_LOG_VERBOSE:
-			return Poco::Message::PRIO_TRACE;
-			
-		case OF_LOG_NOTICE:
-			return Poco::Message::PRIO_NOTICE;
-			
-		case OF_LOG_WARNING:
-			return Poco::Message::PRIO_WARNING;
-			
-		case OF_LOG_ERROR:
-			return Poco::Message::PRIO_ERROR;
-			
-		case OF_LOG_FATAL_ERROR:
-			return Poco::Message::PRIO_FATAL;
-			
-		case OF_LOG_SILENT:
-			return -1;
+		ofxLogCrashHandler::write(fd, "---------- buffered for the compressed file ----------\n");
+		logger.compressedFileChannel->crashDump(fd);
 	}
 }
+
+void ofxLogger::_shutdownAtExit()
+{
+	// the timings since the last report
+	ofxLogScope::stopReports();
+	ofxLogScope::report();
+
+	instance().shutdown();
+}
+
+void ofxLogger::_drain()
+{
+	// lines logged meanwhile go to stderr, only what's already in the sinks
+	// is written out here; once the shutdown has given up, the drain stops
+	// after the sink it was stuck in, the later steps may use statics (ie.
+	// the trace removes its ofEvents listener)
+	configWatcher.stop();
+	disableFormatWorkers();
+	_flushBatches();
+	Poco::Channel* channels[] = {consoleChannel, socketChannel, compressedFileChannel, traceChannel};
+	for(unsigned int i = 0; i < sizeof(channels)/sizeof(channels[0]); ++i)
+	{
+		if(s_bDrainAbandoned.load(std::memory_order_acquire))
+		{
+			return;
+		}
+		channels[i]->close();
+	}
+	if(s_bDrainAbandoned.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	Poco::Mutex::ScopedLock lock(config.mutex);
+	fileChannel->close();
+	for(unsigned int i = 0; i < topicRoutes.size(); ++i)
+	{
+		topicRoutes[i].fileChannel->close();
+	}
+	shutdownDone.set();
+}
+
+void ofxLogger::_logLate(ofLogLevel logLevel, const char* logTopic,
+						 const char* message, std::size_t size)
+{
+	if(logLevel >= OF_LOG_SILENT || logLevel < s_lateLevel.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	const char* prefix = logLevel >= 0 ? ofxLogPattern::s_levelPrefixes[logLevel] : "";
+
+	// the default "%l%P%t" line, cut short to fit
+	char line[512];
+	std::size_t length = 0;
+	const char* parts[] = {prefix, logTopic, *logTopic ? ": " : "", NULL};
+	for(unsigned int i = 0; parts[i]; ++i)
+	{
+		std::size_t n = std::min(strlen(parts[i]), sizeof(line)-1-length);
+		memcpy(line+length, parts[i], n);
+		length += n;
+	}
+	std::size_t n = std::min(size, sizeof(line)-1-length);
+	memcpy(line+length, message, n);
+	length += n;
+	line[length++] = '\n';
+
+	#ifdef TARGET_WIN32
+		fwrite(line, 1, length, stderr);
+	#else
+		while(::write(STDERR_FILENO, line, length) < 0 && errno == EINTR) {}
+	#endif
+}
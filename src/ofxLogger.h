@@ -6,12 +6,29 @@
 #include "ofxBitmapString.h"
 #include "ofxLoggerEvent.h"
 #include "ofxLoggerDisplay.h"
+#include "ofxLogFlightRecorder.h"
+#include "ofxLogConsoleChannel.h"
+#include "ofxLogSocketChannel.h"
+#include "ofxLogSharedMemoryChannel.h"
+#include "ofxLogCompressedFileChannel.h"
+#include "ofxLogTraceChannel.h"
+#include "ofxLogSplitterChannel.h"
+#include "ofxLogRecord.h"
+#include "ofxLogBuffer.h"
+#include "ofxLogPool.h"
+#include "ofxLogPattern.h"
+#include "ofxLogConfig.h"
+#include "ofxLogConfigWatcher.h"
+#include "ofxLogScope.h"
+#include "ofxLogSite.h"
+#include "ofxLogFormatPool.h"
+#include "ofxLogCrashHandler.h"
 
 #include <Poco/AutoPtr.h>
 #include <Poco/Logger.h>
 #include <Poco/FileChannel.h>
-#include <Poco/ConsoleChannel.h>
-#include <Poco/SplitterChannel.h>
+#include <Poco/Thread.h>
+#include <Poco/Event.h>
 
 //#define OF_DEFAULT_LOG_LEVEL  OF_LOG_NOTICE
 extern ofEvent<ofxLoggerEvent> ofxLoggerEventDispatcher;
@@ -33,6 +50,11 @@ extern ofEvent<ofxLoggerEvent> ofxLoggerEventDispatcher;
 ///
 /// See the singleton pattern for more info: http://en.wikipedia.org/wiki/Singleton_pattern
 ///
+/// The singleton is never destroyed, so it can be used from other static
+/// objects' destructors. Instead it's shut down when the app exits: the
+/// queues & buffers are written out and the sinks are closed (see
+/// shutdown()). Lines logged after that are written straight to stderr.
+///
 class ofxLogger
 {
 	public:
@@ -40,16 +62,65 @@ class ofxLogger
 		/// singleton object access, creates a new object on the first call
 		static ofxLogger& instance();
 		
+		/// \section Lifecycle
+		
+		/// RUNNING until the app exits, SHUTTING_DOWN while the sinks are
+		/// written out & closed, SHUT_DOWN afterwards
+		enum State
+		{
+			RUNNING,
+			SHUTTING_DOWN,
+			SHUT_DOWN
+		};
+		static State getState();
+		
+		/// Write out the format workers' queue, the batched & buffered lines
+		/// and close the sinks, waiting at most the shutdown timeout. If a
+		/// sink is stuck (a paused terminal, a collector that stopped
+		/// reading) the rest is given up on so exiting can't hang. Called
+		/// automatically when the app exits, later calls do nothing.
+		///
+		/// Lines logged once the shutdown has started, ie. from another
+		/// thread while the sinks are closed or from a static object's
+		/// destructor, skip the sinks & listeners and are written straight
+		/// to stderr from a small fixed buffer.
+		void shutdown();
+		
+		/// set the longest the shutdown waits for the sinks (default 2000)
+		void setShutdownTimeout(unsigned int millis);
+		
+		/// Add/remove a listener for the logged messages. Listeners get the
+		/// messages below the log level as well, down to the listener sink
+		/// level (see setSinkLevel()). Messages that aren't printed are only
+		/// sent while there are listeners added here, a listener added to
+		/// ofxLoggerEventDispatcher directly only gets the printed ones.
 		template <typename ArgumentsType, class ListenerClass>
 		static void addListener(ListenerClass  * listener, void (ListenerClass::*listenerMethod)(ArgumentsType&)){
 			ofAddListener(ofxLoggerEventDispatcher, listener, listenerMethod);
+			instance()._changeNumListeners(1);
+		}
+		
+		template <typename ArgumentsType, class ListenerClass>
+		static void removeListener(ListenerClass  * listener, void (ListenerClass::*listenerMethod)(ArgumentsType&)){
+			ofRemoveListener(ofxLoggerEventDispatcher, listener, listenerMethod);
+			instance()._changeNumListeners(-1);
 		}
 		
 		/// \section Log
 		/// Log the a message as a full line at a specifed log level. Prints a
 		/// newline automatically.
+		///
+		/// The message is copied into the log record, which comes from the log
+		/// pool (see getPoolStats()), so the message can be passed as a char
+		/// buffer & size without building a string.
 		void log(ofLogLevel logLevel, const std::string& message);
+		void log(ofLogLevel logLevel, const char* message, std::size_t size);
 		void log(const std::string& logTopic, ofLogLevel logLevel, const std::string& message);
+		void log(const std::string& logTopic, ofLogLevel logLevel, const char* message, std::size_t size);
+		
+		/// log at the level & topic of a static site, a site switched on is
+		/// printed whatever the level (see ofxLogSite)
+		void log(const ofxLogSite& site, const char* message, std::size_t size);
 		
 		/// \section Log Level
 		/// Set the current log level. Messages with a log level below this level 
@@ -60,6 +131,29 @@ class ofxLogger
 		void setLevel(ofLogLevel logLevel);
 		ofLogLevel getLevel();
 		
+		/// Would a message at this log level (and topic) be printed? Messages
+		/// kept by the flight recorder count as enabled. Unknown topics are
+		/// not enabled.
+		bool isEnabled(ofLogLevel logLevel);
+		bool isEnabled(const std::string& logTopic, ofLogLevel logLevel);
+		
+		/// \section Sink Levels
+		
+		/// Set the lowest level a sink gets on top of the global & topic
+		/// levels, ie. keep verbose lines in the file while the console only
+		/// shows warnings:
+		///
+		///		setLevel(OF_LOG_VERBOSE);
+		///		setSinkLevel(OFX_LOG_SINK_CONSOLE, OF_LOG_WARNING);
+		///
+		/// A line is built once & only if at least one enabled sink takes it,
+		/// then it's only handed to the sinks that do. isEnabled() uses the
+		/// lowest level of the enabled sinks. The listener level applies to
+		/// all messages, not only the printed ones. (all OF_LOG_VERBOSE by
+		/// default)
+		void setSinkLevel(ofxLogSink sink, ofLogLevel logLevel);
+		ofLogLevel getSinkLevel(ofxLogSink sink);
+		
 		/// \section Console
 		
 		/// Log to the text console. (on by default)
@@ -67,14 +161,51 @@ class ofxLogger
 		void disableConsole();
 		bool usingConsole();
 		
+		/// Console lines are buffered and written in batches by a background
+		/// thread shortly after they are logged, errors are written right away.
+		///
+		/// In non-blocking mode lines are only written by the background
+		/// thread and are dropped if the console can't keep up, so a paused
+		/// terminal doesn't stall the app. (off by default)
+		void enableConsoleNonBlocking();
+		void disableConsoleNonBlocking();
+		bool usingConsoleNonBlocking();
+		
 		/// \section Console Color
 		
-		/// Set the console text color 
+		/// Color each line by its log level. (on by default when the console
+		/// is a terminal, off when it's piped into a file, etc)
+		void enableConsoleColors();
+		void disableConsoleColors();
+		bool usingConsoleColors();
+		
+		/// Set the console text color for lines which don't have a log level
+		/// color (notice by default). Restore goes back to the terminal's color.
 		/// doesn't work in the xcode console - do we need this?
 		/// works fine on the terminal though - not much use
 		void setConsoleColor(int color);
 		void restoreConsoleColor();
 		
+		/// \section Flush
+		
+		/// Write out everything that's buffered now. This is done automatically
+		/// when the app exits.
+		void flush();
+		
+		/// \section Frame Flush
+		
+		/// Write the buffered console lines & the file lines once per frame
+		/// (or every numFrames frames) at the start of update() instead of
+		/// scattered through the frame, so the I/O is one predictable write
+		/// between frames. Errors are still written right away, as is a
+		/// console buffer or file batch that reaches watermarkKB. The
+		/// compressed file, socket & trace keep their own batching. What's
+		/// waiting is written when the app exits. Disabling restores the
+		/// console buffer size. (off by default)
+		void enableFrameFlush(unsigned int numFrames=1, unsigned int watermarkKB=64);
+		void disableFrameFlush();
+		bool usingFrameFlush();
+		
 		/// \section Log File
 		
 		//// Log to a file. (off by default)
@@ -111,6 +242,72 @@ class ofxLogger
 		/// Note: only one type is active at a time
 		void setFileRotationNumber();
 		void setFileRotationTimestamp();
+		
+		/// \section Compressed Log File
+		
+		/// Log to a file compressed in independent gzip blocks by a background
+		/// thread, ie. to save write bandwidth on SD cards. The file can be read
+		/// with zcat & searched with loggerQuery, a crash only loses the block
+		/// that wasn't written yet. See ofxLogCompressedFileChannel for the
+		/// details. (off by default)
+		void enableCompressedFile();
+		void disableCompressedFile();
+		bool usingCompressedFile();
+		
+		/// Set the path to the compressed log file, the default is
+		/// "openframeworks.log.gz" in the data folder. Takes effect the next
+		/// time the compressed file is enabled.
+		void setCompressedFilePath(const std::string& file);
+		std::string getCompressedFilePath();
+		
+		/// Set the text size of a compressed block in KB, bigger blocks compress
+		/// better & smaller blocks lose less in a crash. (default 1024)
+		void setCompressedFileBlockSize(unsigned int sizeKB);
+		
+		/// \section Trace
+		
+		/// Write a timeline of the log lines, ofxLogScope timings & frames in
+		/// the Chrome trace event format, to load into chrome://tracing or
+		/// https://ui.perfetto.dev. The file is streamed, so long captures are
+		/// fine. See ofxLogTraceChannel. (off by default)
+		void enableTrace();
+		void disableTrace();
+		bool usingTrace();
+		
+		/// Set the path to the trace file, the default is "trace.json" in the
+		/// data folder. The file is replaced each time the trace is enabled.
+		void setTracePath(const std::string& file);
+		std::string getTracePath();
+		
+		/// \section Log Socket
+		
+		/// Send the log lines to a collector process (see loggerCollector)
+		/// listening on a Unix domain socket, so several apps can share one log
+		/// file. Lines are sent in batches by a background thread & logging
+		/// never waits on the collector: if it isn't running, lines are queued
+		/// until it is and dropped when the queue is full. (off by default)
+		void enableSocket(const std::string& path="/tmp/ofxLogger.sock");
+		void disableSocket();
+		bool usingSocket();
+		
+		/// Set the name the collector prints for this app (loggerCollector -n).
+		/// (default "pid" + the process id)
+		void setSocketName(const std::string& name);
+		
+		/// \section Shared Memory
+		
+		/// Write the log lines into a ring buffer in shared memory where they
+		/// can be followed live from another process with loggerTail, ie. to
+		/// watch verbose logs of a running installation without writing them to
+		/// the console or a file. Writing never waits on the tail & the oldest
+		/// lines are overwritten. The ring holds sizeKB/512 lines, longer lines
+		/// are truncated. (off by default)
+		///
+		/// Note: lines below the log level aren't written either, set the level
+		/// to OF_LOG_VERBOSE & disable the console to only see them in the tail.
+		void enableSharedMemory(const std::string& name="/ofxLogger", unsigned int sizeKB=2048);
+		void disableSharedMemory();
+		bool usingSharedMemory();
 	
 		/// \section Log Topics
 		/// Log topics allow fine grained control of logging. Topics are a logging
@@ -135,6 +332,37 @@ class ofxLogger
 		void setTopicLogLevel(const std::string& logTopic, ofLogLevel logLevel);
 		void resetTopicLogLevel(const std::string& logTopic);
 		
+		/// \section Topic Routes
+		/// Write a topic and its children to their own log file instead of the
+		/// main log file, ie. addTopicRoute("net", ofToDataPath("net.log"))
+		/// sends "net", "net.http", etc to net.log. "net.*" works as well.
+		/// The topic's lines still go to the console.
+		///
+		/// The route of a topic is looked up once when the topic is added (or
+		/// when a route is added or removed), not for every message. If more
+		/// than one route matches, the longest wins. Route files follow
+		/// enableFile()/disableFile() and use the same rotation settings as
+		/// the main log file.
+		///
+		/// Set up routes before logging from other threads.
+		void addTopicRoute(const std::string& logTopic, const std::string& file);
+		void removeTopicRoute(const std::string& logTopic);
+		
+		/// \section Line Pattern
+		
+		/// Set the layout of each printed line, ie:
+		///
+		///		setPattern("%Y-%m-%d %H:%M:%S.%i [%L] %T %F: %t");
+		///
+		/// The pattern is compiled once when it's set, see ofxLogPattern for
+		/// the fields. The default is "%l%P%t": the level prefix, topic prefix
+		/// & message.
+		///
+		/// The header settings below are presets which set the pattern, using
+		/// one of them replaces a pattern set here.
+		void setPattern(const std::string& pattern);
+		std::string getPattern();
+		
 		/// \section Header
 
 		/// Prefix the header to each line with a layout of:
@@ -172,40 +400,263 @@ class ofxLogger
 		void disableHeaderMillis();
 		bool usingHeaderMillis();
 		
+		/// \section Flight Recorder
+		
+		/// Keep the verbose & notice messages that are below the current log
+		/// level in a small per thread in-memory ring instead of throwing them
+		/// away. When an error or fatal error is logged, the ring of the
+		/// logging thread is written to the log file (or the console if the
+		/// file is disabled) just before the error, giving the context that
+		/// lead up to it without printing verbose messages all the time.
+		///
+		/// numRecords is the number of messages kept per thread.
+		/// Disabled by default.
+		void enableFlightRecorder(unsigned int numRecords=256);
+		void disableFlightRecorder();
+		bool usingFlightRecorder();
+		
+		/// Write the recorded messages of all threads now, oldest first.
+		void dumpFlightRecorder();
+
+		/// \section Format Workers
+		
+		/// Build the printed lines (header, level, topic & pattern) on a
+		/// small pool of worker threads instead of the logging thread, for
+		/// apps that log more lines than one thread can format. The lines are
+		/// numbered as they're logged and a writer thread hands them to the
+		/// sinks in that order, so the files stay ordered. Logging waits
+		/// when numQueued lines are waiting. Errors are written right away,
+		/// after the lines queued before them. Listeners are still called on
+		/// the logging thread, before the line is built, so getLine() of a
+		/// queued line's event is empty. See ofxLogFormatPool.
+		///
+		/// 0 workers uses one less than the number of cores. (off by default)
+		void enableFormatWorkers(unsigned int numWorkers=0, unsigned int numQueued=4096);
+		void disableFormatWorkers();
+		bool usingFormatWorkers();
+		
+		/// \section Crash Dump
+		
+		/// When the app crashes (SIGSEGV, SIGABRT, SIGBUS, SIGILL or SIGFPE),
+		/// write what hasn't reached the sinks yet to a file opened now:
+		/// the flight recorder, the format workers' queue, the batched file
+		/// lines, the console buffer & the compressed file's blocks, then a
+		/// short backtrace. An empty path writes to stderr. The log calls
+		/// don't pay anything for it. See ofxLogCrashHandler. (off by
+		/// default, not available on Windows)
+		void enableCrashDump(const std::string& path="");
+		void disableCrashDump();
+		bool usingCrashDump();
+		
+		/// \section Scope Timing
+		
+		/// Log the percentiles of the ofxLogScope timings every few seconds,
+		/// each report covers the time since the last one. The timings are
+		/// also reported when the app exits. (off by default)
+		void enableScopeReports(unsigned int seconds=10);
+		void disableScopeReports();
+		bool usingScopeReports();
+		
+		/// \section Config File
+
+		/// Apply the settings in a config file of "key = value" lines, ie:
+		///
+		///		# comments start with a hash
+		///		level = warning
+		///		topic.net = verbose
+		///		file = on
+		///		filePath = logs/app.log
+		///		pattern = %H:%M:%S.%i [%L] %T: %t
+		///
+		/// Levels are verbose, notice, warning, error, fatal or silent & the
+		/// switches are on/off, true/false, yes/no or 1/0. The keys are level,
+		/// topic.<name>, level.<sink> (console, file, compressedFile, socket,
+		/// sharedMemory, trace or listeners), console, file, filePath, socket, socketPath,
+		/// sharedMemory, pattern, header, headerDate, headerTime,
+		/// headerFrameNum, headerMillis, flightRecorder (off or the number of
+		/// records), formatWorkers (off or the number of workers),
+		/// frameFlush (off or the frames between flushes), crashDump (off,
+		/// on for stderr or a file path), scopeReports (off or the seconds
+		/// between reports),
+		/// compressedFile, compressedFilePath, trace, tracePath, route.<topic> (the
+		/// route's file path) & site.<file>:<line> (on, off or default, see
+		/// setSiteMode()).
+		///
+		/// The levels, topics, pattern & switches in the file are published
+		/// as one snapshot, log calls see the settings from before or after a
+		/// (re)load, never half of it. Keys an earlier load set that have been
+		/// taken out of the file go back to their defaults: the paths to what
+		/// they were before the file set them, topics follow the global level
+		/// & routes are removed. Keys that were never in the file are left as
+		/// they are. A reload only applies the keys whose value changed (or
+		/// whose setting the app changed since), so saving the file doesn't
+		/// restart the format workers, reopen the routes & so on.
+		///
+		/// Returns false if the file couldn't be read.
+		bool loadConfigFile(const std::string& path);
+
+		/// Load a config file & reload it each time it's saved, so levels &
+		/// sinks can be changed while the app is running. The file is watched
+		/// from a background thread, the log calls never wait for a reload.
+		void watchConfigFile(const std::string& path);
+		void unwatchConfigFile();
+		bool watchingConfigFile();
+
+		/// \section Log Sites
+		
+		/// Switch the statements logged with the OFX_LOG_* macros on or off
+		/// one by one, ie. a single verbose line without its whole topic.
+		/// The file matches the end of the site's path ("testApp.cpp") & a
+		/// line of 0 matches the whole file. The mode is also given to
+		/// matching sites that haven't been reached yet. DEFAULT goes back
+		/// to following the topic's level.
+		void setSiteMode(const std::string& file, int line, ofxLogSite::Mode mode);
+		void setSiteMode(ofxLogSite& site, ofxLogSite::Mode mode);
+		
+		/// the sites reached so far, in registration order
+		std::vector<ofxLogSite*> getSites();
+		
+		/// \section Memory Pool
+		
+		/// Log records & their text come from per thread pools instead of the
+		/// heap (see ofxLogPool). Get the pool counters: allocations, frees
+		/// from other threads, heap fallbacks, and bytes reserved vs in use.
+		/// Use toString() on the stats for a one line summary.
+		ofxLogPool::Stats getPoolStats();
+		
 	protected:
 
 		Poco::AutoPtr<Poco::Logger> 			logger;				///< the logger
-		Poco::AutoPtr<Poco::Channel> 			formattingChannel;	///< formatter (needed for creating topics)
-		Poco::AutoPtr<Poco::SplitterChannel>	splitterChannel;	///< channel source mixer
-		Poco::AutoPtr<Poco::ConsoleChannel> 	consoleChannel;		///< the console io channel
+		Poco::AutoPtr<ofxLogSplitterChannel>	splitterChannel;	///< channel source mixer
+		Poco::AutoPtr<ofxLogConsoleChannel> 	consoleChannel;		///< the console io channel
 		Poco::AutoPtr<Poco::FileChannel> 		fileChannel;		///< the file io channel
+		Poco::AutoPtr<ofxLogSocketChannel>		socketChannel;		///< the collector socket channel
+		Poco::AutoPtr<ofxLogSharedMemoryChannel> sharedMemoryChannel;	///< the shared memory ring channel
+		Poco::AutoPtr<ofxLogCompressedFileChannel> compressedFileChannel;	///< the compressed file channel
+		Poco::AutoPtr<ofxLogTraceChannel>		traceChannel;		///< the trace event channel
+		
+		/// a topic prefix & the channels its lines go to
+		struct TopicRoute
+		{
+			std::string prefix;									///< topic prefix, without ".*"
+			Poco::AutoPtr<ofxLogSplitterChannel> splitterChannel;	///< the sinks + the route's file
+			Poco::AutoPtr<Poco::FileChannel> fileChannel;		///< the route's file
+		};
+		std::vector<TopicRoute> topicRoutes;	///< the topic routing table, guarded by config.mutex
 		
-		bool bConsole;	///< are we printing to the console?
-		bool bFile;		///< are we printing to a file?
+		ofxLogConfigHolder config;			///< levels, topics, pattern & switches
+		ofxLogConfigWatcher configWatcher;	///< reloads the config file
+		std::map<std::string, std::string> configKeys;	///< the keys & values the last config file set, guarded by config.mutex
+		std::map<std::string, std::string> configPaths;	///< the paths from before the config file set them
 		
-		bool bHeader;	///< are we printing the header?
-		bool bDate;		///< print the date?
-		bool bTime;		///< print the time?
-		bool bFrameNum;	///< print the frame num?
-		bool bMillis;	///< print the elapsed millis?
+		ofxLogFlightRecorder flightRecorder;	///< the recorded messages
+		ofxLogFormatPool formatPool;			///< the format workers
+		
+		/// a site mode set by file & line
+		struct SiteRule
+		{
+			std::string file;
+			int line;
+			ofxLogSite::Mode mode;
+		};
+		std::vector<SiteRule> siteRules;	///< applied to new sites, guarded by config.mutex
 		
 	private:
 		
-		/// logs the message to the specified logger
-		void _log(ofLogLevel logLevel, const std::string& message, Poco::Logger* theLogger);
+		friend class ofxLogSite;
+		
+		/// logs the message to the specified topic, the site is NULL if
+		/// the message wasn't logged from a site
+		void _log(const ofxLogConfig& config, ofLogLevel logLevel, const char* message,
+				  std::size_t size, const ofxLogConfig::Topic& topic,
+				  const ofxLogSite* site=NULL);
+		
+		/// registers a new site & gives it the mode of a matching rule,
+		/// called by the site's constructor
+		void _registerSite(ofxLogSite& site);
+		
+		/// adds/removes a sink on the main & route splitters
+		void _addChannel(Poco::Channel* channel, ofxLogSink sink);
+		void _removeChannel(Poco::Channel* channel);
+		
+		/// the channel of a sink, NULL for the listeners
+		Poco::Channel* _sinkChannel(ofxLogSink sink);
+		
+		/// counts the listeners added with addListener()
+		void _changeNumListeners(int change);
+		int numListeners;	///< guarded by config.mutex
+		
+		/// sets a file property on the main & route files
+		void _setFileProperty(const std::string& name, const std::string& value);
+		
+		/// strips a trailing ".*" from a route topic
+		std::string _routePrefix(const std::string& logTopic);
+		
+		/// returns the channel a topic logs to: its route or the main channel
+		ofxLogSplitterChannel* _resolveTopicChannel(const std::string& logTopic);
+		
+		/// updates the channel of each existing topic after a route change
+		void _reresolveTopics();
+		
+		/// is the level enabled for the given topic?
+		bool _isEnabled(const ofxLogConfig& config, ofLogLevel logLevel,
+						const ofxLogConfig::Topic& topic);
+		
+		/// publishes a snapshot with a switch changed / reads a switch
+		void _setFlag(bool ofxLogConfig::* flag, bool value);
+		bool _getFlag(bool ofxLogConfig::* flag);
+		
+		/// changes a header toggle & sets the preset pattern
+		void _setHeaderFlag(bool ofxLogConfig::* flag, bool value);
+		
+		/// the pattern for the header toggles
+		std::string _presetPattern(const ofxLogConfig& config);
+		
+		/// applies a config line, returns false if the key is unknown; the
+		/// warnings are logged by the caller once config.mutex is released
+		bool _applyConfigValue(const std::string& key, const std::string& value,
+							   std::vector<std::string>& warnings);
+		
+		/// is a config line unchanged since the last load & still in effect?
+		bool _isConfigValueCurrent(const std::string& key, const std::string& value);
+		
+		/// the value a key goes back to when it's taken out of the config file
+		std::string _defaultConfigValue(const std::string& key);
+		
+		/// reloads the config file, called by the watcher
+		static void _reloadConfigFile(const std::string& path);
+		
+		/// writes the flight recorder's messages to the file, or to all
+		/// channels if the file is disabled
+		void _dumpFlightRecorder(const ofxLogConfig& config, bool allThreads);
+		
+		/// flushes every numFrames frames & when the app exits
+		void _onUpdate(ofEventArgs& args);
+		void _onExit(ofEventArgs& args);
+		unsigned int frameFlushCount;	///< frames since the last flush, main thread only
+		unsigned int consoleBufferSizeKB;	///< the console buffer size to restore when frame flush stops
+		
+		/// writes the batched file lines of the main & route splitters
+		void _flushBatches();
+		
+		/// writes the pending lines of the singleton, called by the crash
+		/// handler
+		static void _crashDump(int fd);
 		
-		/// logs using a printf and prints a warning
-		/// this is used if the logger has been destroyed
-		void _logDestroyed(const string& message);
+		/// shuts the singleton down, registered with atexit
+		static void _shutdownAtExit();
 		
-		/// convert an OF log level to the Poco log level and vice versa
-		ofLogLevel _convertPocoLogLevel(const int level);
-		int _convertOfLogLevel(const ofLogLevel level);
+		/// writes out & closes the sinks, run on the shutdown thread
+		void _drain();
+		Poco::Thread shutdownThread;
+		Poco::Event shutdownDone;
+		unsigned int shutdownTimeout;	///< millis
 		
-		/// static date format strings for the header
-		static const std::string s_dateFormat;
-		static const std::string s_timeFormat;
-		static const std::string s_dateAndTimeFormat;
+		/// writes a line logged after the shutdown to stderr if it's at or
+		/// above the global level, doesn't use the heap or anything that
+		/// may already be destroyed
+		static void _logLate(ofLogLevel logLevel, const char* logTopic,
+							 const char* message, std::size_t size);
 	
 		// hide all the constructors, copy functions here
 		ofxLogger(ofxLogger const&);    				// not defined, not copyable
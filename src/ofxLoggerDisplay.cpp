@@ -66,7 +66,8 @@ void ofxLoggerDisplay::draw(float x, float y) {
 			case OF_LOG_FATAL_ERROR:	ofSetColor(211, 24,  149);	break;
 			default: 					ofSetColor(255, 255, 255); 	break;
 		};
-		ofDrawBitmapString((*it).message, x,h);
+		// lines below the log level aren't built, show the message instead
+		ofDrawBitmapString(ev.getLine().empty() ? ev.getMessage() : ev.getLine(), x,h);
 		h+= 13;
 		++it;
 	}
@@ -79,7 +80,7 @@ void ofxLoggerDisplay::onNewLog(ofxLoggerEvent& ev) {
 	}
 	messages.push_back(ev);
 	if(messages.size() > num_messages_to_show) {
-		messages.erase(messages.begin());
+		messages.pop_front();
 	}
 }
 
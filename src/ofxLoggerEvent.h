@@ -1,14 +1,42 @@
 #ifndef OFXLOGGEREVENTH
 #define OFXLOGGEREVENTH
 #include <string>
+#include "ofxLogRecord.h"
+#include <Poco/AutoPtr.h>
+#include <Poco/Message.h>
+
+// Listeners share the logged record, copying the event only copies a pointer.
+// Keep the event (or the record) to hold on to the message.
 class ofxLoggerEvent {
 public:
+	ofxLoggerEvent(ofxLogRecord* r)
+		:record(r, true)
+		,level(r->getLevel())
+		,message(r->getMessage())
+	{
+	}
+	
+	// the old constructor, wraps the message in a record
 	ofxLoggerEvent(std::string msg, ofLogLevel l)
-		:message(msg) 
+		:record(ofxLogRecord::create(Poco::Message("", msg,
+			(Poco::Message::Priority) ofxLogRecord::toPriority(l))))
 		,level(l)
+		,message(record->getMessage())
 	{
 	}
+	
+	// the message as logged & the line as printed (with header, level & topic)
+	ofxLogText getMessage() const {return record->getMessage();}
+	ofxLogText getLine() const {return record->getLine();}
+	const std::string& getTopic() const {return record->getTopic();}
+	const ofxLogRecord& getRecord() const {return *record;}
+	
+	Poco::AutoPtr<ofxLogRecord> record;
 	ofLogLevel level;
-	string message;
+	
+	// the message, points into the record so it's valid as long as the
+	// event (or a copy of it) is; read only, copy it into a std::string to
+	// change it (this was a std::string before ofxLogRecord)
+	ofxLogText message;
 };
-#endif
\ No newline at end of file
+#endif